@@ -1,4 +1,5 @@
 #include "BitSet.h"
+#include "../Utilities/MemoryAccessTrace.h"
 
 #include <cstdio>
 
@@ -48,6 +49,7 @@ BitSet BitSet::operator|(const BitSet& other) const {
 }
 
 BitSet& BitSet::operator&=(const BitSet& other) {
+	MEMORY_ACCESS_TRACE(other.data.data(), other.data.size() * sizeof(uint32_t));
 	for (size_t i = 0; i < data.size(); i++) {
 		data[i] &= other.data[i];
 	}
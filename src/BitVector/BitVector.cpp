@@ -53,6 +53,7 @@ BinaryRangeSearch::BinaryRangeSearch(vector<Range1d>& ranges) {
 
 size_t BinaryRangeSearch::Match(Point1d x) const {
 	size_t index = Seek(x, 0, dividers.size());
+	MEMORY_ACCESS_TRACE(&indices[index], sizeof(size_t));
 	return indices[index];
 }
 
@@ -60,6 +61,7 @@ size_t BinaryRangeSearch::Seek(Point1d x, size_t l, size_t r) const {
 	//printf("%u %u\n", l, r);
 	if (l == r) return l;
 	size_t m = (l + r) / 2;
+	MEMORY_ACCESS_TRACE(&dividers[m], sizeof(Point1d));
 	if (x < dividers[m]) {
 		return Seek(x, l, m);
 	} else {
@@ -114,8 +116,10 @@ int BitVector::ClassifyAPacket(const Packet& packet) {
 	BitSet sol(rules.size(), true);
 
 	for (size_t i = 0; i < matchers.size(); i++) {
+		MEMORY_ACCESS_TRACE(matchers[i], sizeof(FieldMatcher));
 		size_t j = matchers[i]->Match(packet[i]);
 		if (j < fields[i].size()) {
+			MEMORY_ACCESS_TRACE(&fields[i][j], sizeof(BitSet));
 			sol &= fields[i][j];
 			//fields[i][j].Print();
 		} else {
@@ -183,8 +187,10 @@ int BitVector64::ClassifyAPacket(const Packet& packet) {
 	BitSet64 sol(true);
 
 	for (size_t i = 0; i < matchers.size(); i++) {
+		MEMORY_ACCESS_TRACE(matchers[i], sizeof(FieldMatcher));
 		size_t j = matchers[i]->Match(packet[i]);
 		if (j < fields[i].size()) {
+			MEMORY_ACCESS_TRACE(&fields[i][j], sizeof(BitSet64));
 			sol &= fields[i][j];
 			//fields[i][j].Print();
 		} else {
@@ -32,10 +32,10 @@ public:
 	virtual void _ConstructClassifier(const std::vector<Rule>& rules);
 	virtual int ClassifyAPacket(const Packet& packet);
 
-	virtual void DeleteRule(size_t index) {
+	virtual void _DeleteRule(size_t index) {
 		printf("Deletion not supported\n");
 	}
-	virtual void InsertRule(const Rule& rule) {
+	virtual void _InsertRule(const Rule& rule) {
 		printf("Insertion not supported\n");
 	}
 	virtual Memory MemSizeBytes() const {
@@ -44,6 +44,9 @@ public:
 	virtual int MemoryAccess() const {
 		return 0; // TODO
 	}
+	virtual bool SupportsMemoryAccessTrace() const {
+		return true;
+	}
 	virtual size_t NumTables() const {
 		return 1;
 	}
@@ -68,10 +71,10 @@ public:
 	virtual void _ConstructClassifier(const std::vector<Rule>& rules);
 	virtual int ClassifyAPacket(const Packet& packet);
 
-	virtual void DeleteRule(size_t index) {
+	virtual void _DeleteRule(size_t index) {
 		printf("Deletion not supported\n");
 	}
-	virtual void InsertRule(const Rule& rule) {
+	virtual void _InsertRule(const Rule& rule) {
 		printf("Insertion not supported\n");
 	}
 	virtual Memory MemSizeBytes() const {
@@ -80,6 +83,9 @@ public:
 	virtual int MemoryAccess() const {
 		return 0; // TODO
 	}
+	virtual bool SupportsMemoryAccessTrace() const {
+		return true;
+	}
 	virtual size_t NumTables() const {
 		return 1;
 	}
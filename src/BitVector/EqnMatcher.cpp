@@ -30,6 +30,7 @@ EqnMatcher::~EqnMatcher() {
 }
 
 size_t EqnMatcher::Match(Point1d x) const {
+	MEMORY_ACCESS_TRACE(terms.data(), terms.size() * sizeof(EqnTerm));
 	size_t index = 0;
 	for (EqnTerm t : terms) {
 		//printf("%x %x: +%d\n", t.xor, t.mask, t.boost);
@@ -21,10 +21,12 @@ LongestPrefixMatch::~LongestPrefixMatch() {
 
 size_t LongestPrefixMatch::Match(Point1d x) const {
 	for (auto iter = table.rbegin(); iter != table.rend(); iter++) {
+		MEMORY_ACCESS_TRACE(&*iter, sizeof(*iter));
 		int len = iter->first;
 		Point1d p = x & LPMMask(len);
 		auto res = iter->second.find(p);
 		if (res != iter->second.end()) {
+			MEMORY_ACCESS_TRACE(&*res, sizeof(*res));
 			return res->second;
 		}
 	}
@@ -13,6 +13,9 @@ public:
 
 
  
+	Memory MemSizeBytes() const {
+		return 0;
+	}
 	int MemoryAccess() const {
 		return 0;
 	}
@@ -27,33 +30,25 @@ public:
 	int ClassifyAPacket(const Packet& one_packet) {
 		
 		int result = -1;
-		auto IsPacketMatchToRule = [](const Packet& p, const Rule& r) {
-			for (int i = 0; i < r.dim; i++) {
-				if (p[i] < r.range[i][0]) return 0;
-				if (p[i] > r.range[i][1]) return 0;
-			}
-			return 1;
-		};
-		
 		for (size_t j = 0; j < rules.size(); j++) {
-			if (IsPacketMatchToRule(one_packet, rules[j])) {
+			if (rules[j].MatchesPacket(one_packet)) {
 				result = std::max(rules[j].priority, result);
 			}
 		}
 		return result;
 	}
 
-	void DeleteRule(size_t i) {
-		if (i < 0 || i >= rules.size()) {
+	void _DeleteRule(size_t i) {
+		if (i >= rules.size()) {
 			printf("Warning index delete rule out of bound: do nothing here\n");
-			printf("%zd vs. size: %zd", i, rules.size());
+			printf("%zu vs. size: %zu\n", i, rules.size());
 			return;
 		}
 		if (i != rules.size() -1)
 		rules[i]=std::move(rules[rules.size() - 1]);
 		rules.pop_back();
 	}
-	void InsertRule(const Rule& one_rule) { 
+	void _InsertRule(const Rule& one_rule) { 
 		rules.push_back(one_rule);
 	}
 	int Size() const {
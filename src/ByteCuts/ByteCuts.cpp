@@ -175,7 +175,9 @@ void ByteCutsClassifier::BuildBadTree(const vector<Rule>& rules) {
 int ByteCutsClassifier::ClassifyAPacket(const Packet& packet) {
 	int result = -1;
 	for (size_t i = 0; i < trees.size(); i++) {
+		MEMORY_ACCESS_TRACE(&priorities[i], sizeof(priorities[i]));
 		if (priorities[i] > result) {
+			MEMORY_ACCESS_TRACE(&trees[i], sizeof(trees[i]));
 			ByteCutsNode* tree = trees[i];
 			result = max(result, tree->ClassifyAPacket(packet));
 		}
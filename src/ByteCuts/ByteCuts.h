@@ -36,11 +36,11 @@ public:
 
 	virtual void _ConstructClassifier(const std::vector<Rule>& rules);
 	virtual int ClassifyAPacket(const Packet& packet);
-	virtual void DeleteRule(size_t index) {
+	virtual void _DeleteRule(size_t index) {
 		printf("Can't delete rules.\n");
 		exit(EXIT_FAILURE);
 	}
-	virtual void InsertRule(const Rule& rule) {
+	virtual void _InsertRule(const Rule& rule) {
 		printf("Can't insert rules.\n");
 		exit(EXIT_FAILURE);
 	}
@@ -53,6 +53,7 @@ public:
 		return mem;
 	}
 	virtual int MemoryAccess() const { return 0; } // TODO
+	virtual bool SupportsMemoryAccessTrace() const { return true; }
 	virtual size_t NumTables() const {
 		return trees.size();
 	}
@@ -90,10 +90,16 @@ ByteCutsNode::~ByteCutsNode() {
 }
 
 int ByteCutsNode::ClassifyAPacket(const Packet& p) const {
+	MEMORY_ACCESS_TRACE(this, sizeof(ByteCutsNode));
 	switch (mode) {
 		case Cut:
-			return children[IndexPacket(p)]->ClassifyAPacket(p);
+			{
+				ByteCutsNode* const* child = &children[IndexPacket(p)];
+				MEMORY_ACCESS_TRACE(child, sizeof(*child));
+				return (*child)->ClassifyAPacket(p);
+			}
 		case Split:
+			MEMORY_ACCESS_TRACE(children, 2 * sizeof(ByteCutsNode*));
 			if (p[dim] <= splitPoint) {
 				return children[0]->ClassifyAPacket(p);
 			} else {
@@ -0,0 +1,106 @@
+// Generator of the packet traces with configurable flow locality
+//
+
+#include "../ClassBenchTraceGenerator/flow_trace_gen.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <thread>
+
+#include "../Utilities/thread_pool.h"
+
+using namespace std;
+
+FlowTraceGenerator::FlowTraceGenerator(const vector<Rule> &rules,
+		const FlowTraceConfig &config) :
+		rules(rules), config(config) {
+	if (rules.empty())
+		throw runtime_error("FlowTraceGenerator requires a non empty ruleset");
+	if (config.mode != FlowTraceConfig::Mode::Flows)
+		return;
+	if (config.flow_cnt == 0 || config.interleave == 0)
+		throw runtime_error(
+				"FlowTraceGenerator requires at least one flow and interleave >= 1");
+
+	rng_t rng(config.seed);
+	uniform_int_distribution<size_t> rule_dist(0, rules.size() - 1);
+	flows.resize(config.flow_cnt);
+	flow_cdf.resize(config.flow_cnt);
+	double sum = 0;
+	for (size_t i = 0; i < config.flow_cnt; i++) {
+		RandomPacketInRule(rng, rules[rule_dist(rng)], flows[i]);
+		sum += 1.0 / pow(double(i + 1), config.zipf_s);
+		flow_cdf[i] = sum;
+	}
+}
+
+void FlowTraceGenerator::RandomPacketInRule(rng_t &rng, const Rule &r,
+		Packet &p) const {
+	p.resize(r.dim);
+	for (int i = 0; i < r.dim; i++) {
+		p[i] = uniform_int_distribution<Point1d>(r.range[i].low,
+				r.range[i].high)(rng);
+	}
+}
+
+size_t FlowTraceGenerator::SampleFlow(rng_t &rng) const {
+	double x = uniform_real_distribution<double>(0, flow_cdf.back())(rng);
+	auto it = upper_bound(flow_cdf.begin(), flow_cdf.end(), x);
+	return min<size_t>(it - flow_cdf.begin(), flows.size() - 1);
+}
+
+size_t FlowTraceGenerator::SampleFlowLength(rng_t &rng) const {
+	if (config.mean_flow_len <= 1)
+		return 1;
+	return 1
+			+ geometric_distribution<size_t>(1.0 / config.mean_flow_len)(rng);
+}
+
+void FlowTraceGenerator::GenerateSegment(size_t segment_index,
+		size_t packet_cnt, vector<Packet> &packets) const {
+	seed_seq ss { config.seed, uint64_t(segment_index) };
+	rng_t rng(ss);
+	packets.resize(packet_cnt);
+	if (config.mode == FlowTraceConfig::Mode::Uniform) {
+		uniform_int_distribution<size_t> rule_dist(0, rules.size() - 1);
+		for (auto &p : packets)
+			RandomPacketInRule(rng, rules[rule_dist(rng)], p);
+		return;
+	}
+
+	// active flows and the number of their remaining packets
+	vector<pair<size_t, size_t>> active(config.interleave);
+	for (auto &a : active)
+		a = { SampleFlow(rng), SampleFlowLength(rng) };
+	uniform_int_distribution<size_t> active_dist(0, active.size() - 1);
+	for (auto &p : packets) {
+		auto &a = active[active_dist(rng)];
+		const Packet &f = flows[a.first];
+		p.assign(f.begin(), f.end());
+		if (--a.second == 0)
+			a = { SampleFlow(rng), SampleFlowLength(rng) };
+	}
+}
+
+vector<Packet> FlowTraceGenerator::Generate(size_t packet_cnt,
+		size_t thread_cnt) const {
+	if (thread_cnt == 0)
+		thread_cnt = max(1u, thread::hardware_concurrency());
+	size_t segment_cnt = (packet_cnt + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+	vector<Packet> packets(packet_cnt);
+	ThreadPool pool(min(thread_cnt, max<size_t>(segment_cnt, 1)));
+	vector<future<void>> tasks;
+	for (size_t s = 0; s < segment_cnt; s++) {
+		tasks.push_back(pool.enqueue([this, &packets, s, packet_cnt]() {
+			size_t begin = s * SEGMENT_SIZE;
+			size_t cnt = min(SEGMENT_SIZE, packet_cnt - begin);
+			vector<Packet> segment;
+			GenerateSegment(s, cnt, segment);
+			move(segment.begin(), segment.end(), packets.begin() + begin);
+		}));
+	}
+	for (auto &t : tasks)
+		t.get();
+	return packets;
+}
@@ -0,0 +1,71 @@
+// Generator of the packet traces with configurable flow locality
+//
+#pragma once
+
+#include <random>
+#include <vector>
+
+#include "../ElementaryClasses.h"
+
+struct FlowTraceConfig {
+	enum class Mode {
+		// N flows with Zipf popularity, bursts of packets interleaved
+		Flows,
+		// each packet is an uniformly random point in a random rule (no locality)
+		Uniform,
+	};
+	Mode mode = Mode::Flows;
+	// number of distinct flows (packet headers)
+	size_t flow_cnt = 10000;
+	// exponent of the Zipf distribution of the flow popularity, 0 = uniform
+	double zipf_s = 1.0;
+	// mean number of packets of the flow burst (geometric distribution)
+	double mean_flow_len = 16;
+	// number of the concurrently active flows whose packets are interleaved
+	size_t interleave = 8;
+	uint64_t seed = 0;
+};
+
+/**
+ * Trace generator with flow/temporal locality
+ *
+ * The flow headers are uniformly random points of uniformly selected rules.
+ * A flow is active for a geometrically distributed number of packets,
+ * then it is replaced by a next flow selected by popularity. Each packet
+ * belongs to a random flow from the active set.
+ *
+ * The trace is generated in independent segments (each with its own
+ * random generator), so it can be generated in parallel or streamed
+ * and the result does not depend on the number of threads.
+ */
+class FlowTraceGenerator {
+public:
+	static constexpr size_t SEGMENT_SIZE = 64 * 1024;
+
+	FlowTraceGenerator(const std::vector<Rule> &rules,
+			const FlowTraceConfig &config);
+
+	std::vector<Packet> Generate(size_t packet_cnt, size_t thread_cnt = 0) const;
+	/**
+	 * Generate packets [segment_index * SEGMENT_SIZE, + packet_cnt) of the trace
+	 * (packet_cnt <= SEGMENT_SIZE)
+	 */
+	void GenerateSegment(size_t segment_index, size_t packet_cnt,
+			std::vector<Packet> &packets) const;
+
+	size_t FlowCount() const {
+		return flows.size();
+	}
+
+private:
+	using rng_t = std::mt19937_64;
+	void RandomPacketInRule(rng_t &rng, const Rule &r, Packet &p) const;
+	size_t SampleFlow(rng_t &rng) const;
+	size_t SampleFlowLength(rng_t &rng) const;
+
+	const std::vector<Rule> &rules;
+	FlowTraceConfig config;
+	std::vector<Packet> flows;
+	// cummulative popularity of flows
+	std::vector<double> flow_cdf;
+};
@@ -0,0 +1,305 @@
+// Generator of the synthetic rulesets from the ClassBench parameter (seed) files
+//
+
+#include "../ClassBenchTraceGenerator/ruleset_gen.h"
+
+#include <algorithm>
+#include <fstream>
+#include <future>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+#include "../IO/InputReader.h"
+#include "../Utilities/thread_pool.h"
+
+using namespace std;
+
+const array<const char*, RulesetGenerator::PORT_PAIR_CLASS_CNT> RulesetGenerator::PORT_PAIR_CLASS_NAMES =
+		{ "wc_wc", "wc_hi", "hi_wc", "hi_hi", "wc_lo", "lo_wc", "hi_lo",
+				"lo_hi", "lo_lo", "wc_ar", "ar_wc", "hi_ar", "ar_hi", "wc_em",
+				"em_wc", "hi_em", "em_hi", "lo_ar", "ar_lo", "lo_em", "em_lo",
+				"ar_ar", "ar_em", "em_ar", "em_em" };
+
+template<typename T>
+void RulesetGenerator::Distribution<T>::add(const T &v, double prob) {
+	if (prob <= 0)
+		return;
+	values.push_back(v);
+	cummulative.push_back((cummulative.empty() ? 0 : cummulative.back()) + prob);
+}
+
+template<typename T>
+const T& RulesetGenerator::Distribution<T>::sample(rng_t &rng) const {
+	uniform_real_distribution<double> u(0, cummulative.back());
+	auto it = upper_bound(cummulative.begin(), cummulative.end(), u(rng));
+	if (it == cummulative.end())
+		it--;
+	return values[it - cummulative.begin()];
+}
+
+/*
+ * Read the sections of the parameter file, "-name" starts a section, "#" ends it
+ */
+static map<string, vector<string>> ReadSections(const string &filename) {
+	ifstream in(filename);
+	if (!in.is_open()) {
+		throw ifstream::failure(
+				string("Couldn't open parameter file \"") + filename + "\"");
+	}
+	map<string, vector<string>> sections;
+	vector<string> *current = nullptr;
+	string line;
+	while (getline(in, line)) {
+		if (line.size() && line.back() == '\r')
+			line.pop_back();
+		if (line.empty())
+			continue;
+		if (line[0] == '#') {
+			current = nullptr;
+		} else if (line[0] == '-') {
+			current = &sections[line.substr(1, line.find_first_of(" \t") - 1)];
+		} else if (current) {
+			current->push_back(line);
+		}
+	}
+	return sections;
+}
+
+// "<a>,<b>" or "<a>:<b>"
+static bool SplitPair(const string &token, char delim, double &a, double &b) {
+	size_t pos = token.find(delim);
+	if (pos == string::npos)
+		return false;
+	a = atof(token.substr(0, pos).c_str());
+	b = atof(token.substr(pos + 1).c_str());
+	return true;
+}
+
+RulesetGenerator::RulesetGenerator(const string &parameter_file) {
+	auto sections = ReadSections(parameter_file);
+
+	for (const auto &line : sections["prots"]) {
+		istringstream iss(line);
+		ProtocolClass pc;
+		double prob;
+		if (!(iss >> pc.protocol >> prob))
+			throw ifstream::failure("Invalid -prots line: " + line);
+		double class_prob;
+		for (size_t i = 0; i < PORT_PAIR_CLASS_CNT && iss >> class_prob; i++)
+			pc.port_pair_class.add(i, class_prob);
+		if (pc.port_pair_class.empty())
+			pc.port_pair_class.add(0, 1); // wc_wc
+		protocols.add(pc, prob);
+	}
+	if (protocols.empty())
+		throw ifstream::failure(
+				"Parameter file \"" + parameter_file
+						+ "\" has no -prots section");
+
+	for (auto &s : { make_pair("spar", &src_ranges), make_pair("dpar",
+			&dst_ranges) }) {
+		for (const auto &line : sections[s.first]) {
+			istringstream iss(line);
+			double prob, low, high;
+			string range;
+			if (!(iss >> prob >> range) || !SplitPair(range, ':', low, high))
+				throw ifstream::failure("Invalid -" + string(s.first)
+						+ " line: " + line);
+			s.second->add(Range1d(low, high), prob);
+		}
+	}
+	for (auto &s : { make_pair("sper", &src_ports), make_pair("dper",
+			&dst_ports) }) {
+		for (const auto &line : sections[s.first]) {
+			istringstream iss(line);
+			double prob;
+			uint32_t port;
+			if (!(iss >> prob >> port))
+				throw ifstream::failure("Invalid -" + string(s.first)
+						+ " line: " + line);
+			s.second->add(port, prob);
+		}
+	}
+
+	for (size_t c = 0; c < PORT_PAIR_CLASS_CNT; c++) {
+		auto &pl = prefix_lengths[c];
+		for (const auto &line : sections[PORT_PAIR_CLASS_NAMES[c]]) {
+			istringstream iss(line);
+			string token;
+			double total, prob;
+			if (!(iss >> token) || !SplitPair(token, ',', total, prob)
+					|| total < 0 || total > 64)
+				throw ifstream::failure(
+						"Invalid -" + string(PORT_PAIR_CLASS_NAMES[c])
+								+ " line: " + line);
+			pl.total.add(total, prob);
+			double src_len, src_prob;
+			while (iss >> token) {
+				if (!SplitPair(token, ',', src_len, src_prob))
+					throw ifstream::failure(
+							"Invalid -" + string(PORT_PAIR_CLASS_NAMES[c])
+									+ " line: " + line);
+				int dst_len = total - src_len;
+				if (src_len >= 0 && src_len <= 32 && dst_len >= 0
+						&& dst_len <= 32)
+					pl.src[total].add(src_len, src_prob);
+			}
+		}
+		if (pl.total.empty()) {
+			// no data for the class, both addresses from /32, /24, /16 or /0
+			const pair<int, double> lens[] = { { 32, 0.4 }, { 24, 0.3 }, {
+					16, 0.2 }, { 0, 0.1 } };
+			pl = PrefixLengths();
+			for (auto s : lens)
+				for (auto d : lens) {
+					pl.total.add(s.first + d.first, s.second * d.second);
+					pl.src[s.first + d.first].add(s.first,
+							s.second * d.second);
+				}
+		}
+	}
+}
+
+void RulesetGenerator::GeneratePort(rng_t &rng, char kind, bool is_src,
+		Range1d &r) const {
+	const auto &ranges = is_src ? src_ranges : dst_ranges;
+	const auto &ports = is_src ? src_ports : dst_ports;
+	switch (kind) {
+	case 'h':
+		r = Range1d(1024, 65535);
+		break;
+	case 'l':
+		r = Range1d(0, 1023);
+		break;
+	case 'a':
+		if (!ranges.empty()) {
+			r = ranges.sample(rng);
+		} else {
+			uniform_int_distribution<uint32_t> u(0, 65535);
+			uint32_t a = u(rng), b = u(rng);
+			r = Range1d(min(a, b), max(a, b));
+		}
+		break;
+	case 'e':
+		if (!ports.empty()) {
+			uint32_t p = ports.sample(rng);
+			r = Range1d(p, p);
+		} else {
+			uint32_t p = uniform_int_distribution<uint32_t>(0, 65535)(rng);
+			r = Range1d(p, p);
+		}
+		break;
+	default:
+		r = Range1d(0, 65535);
+	}
+}
+
+void RulesetGenerator::GenerateAddress(rng_t &rng,
+		const vector<uint32_t> &networks, int len, Range1d &r,
+		unsigned &prefix_length) const {
+	uint32_t net = networks[uniform_int_distribution<size_t>(0,
+			networks.size() - 1)(rng)];
+	uint32_t addr = (net << 16) | uniform_int_distribution<uint32_t>(0, 0xFFFF)(rng);
+	uint32_t mask = len == 0 ? 0 : ~uint32_t(0) << (32 - len);
+	r.low = addr & mask;
+	r.high = r.low | ~mask;
+	prefix_length = len;
+}
+
+void RulesetGenerator::GenerateChunk(size_t chunk_index, uint64_t seed,
+		const vector<uint32_t> &src_networks,
+		const vector<uint32_t> &dst_networks, vector<Rule> &rules) const {
+	seed_seq ss { seed, uint64_t(chunk_index) };
+	rng_t rng(ss);
+	rules.clear();
+	rules.reserve(CHUNK_SIZE);
+	for (size_t i = 0; i < CHUNK_SIZE; i++) {
+		rules.emplace_back(5);
+		Rule &r = rules.back();
+		const ProtocolClass &pc = protocols.sample(rng);
+		size_t port_class = pc.port_pair_class.sample(rng);
+		const char *name = PORT_PAIR_CLASS_NAMES[port_class];
+
+		const PrefixLengths &pl = prefix_lengths[port_class];
+		int total = pl.total.sample(rng);
+		int src_len;
+		if (!pl.src[total].empty()) {
+			src_len = pl.src[total].sample(rng);
+		} else {
+			int lo = max(0, total - 32), hi = min(32, total);
+			src_len = uniform_int_distribution<int>(lo, hi)(rng);
+		}
+		GenerateAddress(rng, src_networks, src_len, r.range[FieldSA],
+				r.prefix_length[FieldSA]);
+		GenerateAddress(rng, dst_networks, total - src_len, r.range[FieldDA],
+				r.prefix_length[FieldDA]);
+		GeneratePort(rng, name[0], true, r.range[FieldSP]);
+		GeneratePort(rng, name[3], false, r.range[FieldDP]);
+		if (pc.protocol == 0)
+			r.range[FieldProto] = Range1d(0, 255);
+		else
+			r.range[FieldProto] = Range1d(pc.protocol, pc.protocol);
+	}
+}
+
+vector<Rule> RulesetGenerator::Generate(size_t rule_cnt, uint64_t seed,
+		size_t thread_cnt) const {
+	if (thread_cnt == 0)
+		thread_cnt = max(1u, thread::hardware_concurrency());
+	vector<Rule> res;
+	res.reserve(rule_cnt);
+	unordered_set<vector<Range1d>> seen_rule_ranges;
+	seen_rule_ranges.reserve(rule_cnt);
+
+	// the network pools are same for all chunks
+	rng_t net_rng(seed);
+	vector<uint32_t> src_networks(NETWORK_POOL_SIZE), dst_networks(
+			NETWORK_POOL_SIZE);
+	uniform_int_distribution<uint32_t> u16(0, 0xFFFF);
+	for (auto &n : src_networks)
+		n = u16(net_rng);
+	for (auto &n : dst_networks)
+		n = u16(net_rng);
+
+	ThreadPool pool(thread_cnt);
+	size_t chunk_index = 0;
+	size_t rounds_without_progress = 0;
+	// the chunks are generated in parallel, but merged in order
+	while (res.size() < rule_cnt) {
+		size_t missing_chunks = (rule_cnt - res.size() + CHUNK_SIZE - 1)
+				/ CHUNK_SIZE;
+		size_t chunk_cnt = min(thread_cnt, missing_chunks);
+		vector<vector<Rule>> chunks(chunk_cnt);
+		vector<future<void>> tasks;
+		for (size_t i = 0; i < chunk_cnt; i++) {
+			tasks.push_back(
+					pool.enqueue(
+							[this, &chunks, &src_networks, &dst_networks, i,
+									chunk_index, seed]() {
+								GenerateChunk(chunk_index + i, seed,
+										src_networks, dst_networks, chunks[i]);
+							}));
+		}
+		for (auto &t : tasks)
+			t.get();
+		chunk_index += chunk_cnt;
+
+		size_t size_before = res.size();
+		for (auto &chunk : chunks) {
+			for (auto &r : chunk) {
+				if (res.size() == rule_cnt)
+					break;
+				if (seen_rule_ranges.insert(r.range).second)
+					res.push_back(std::move(r));
+			}
+		}
+		if (res.size() == size_before && ++rounds_without_progress == 16) {
+			printf("warning: generated only %zu unique rules\n", res.size());
+			break;
+		}
+	}
+	InputReader::AssignPriorities(res);
+	return res;
+}
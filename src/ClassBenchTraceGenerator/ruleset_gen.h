@@ -0,0 +1,84 @@
+// Generator of the synthetic rulesets from the ClassBench parameter (seed) files
+//
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "../ElementaryClasses.h"
+
+/**
+ * ClassBench-style ruleset generator (IPv4 5-tuple)
+ *
+ * The parameter file is composed of sections "-<name>" terminated by "#",
+ * the following sections are used (the others are ignored):
+ *   -prots  "<protocol> <probability> <25 port pair class probabilities>"
+ *           (protocol 0 = wildcard)
+ *   -spar, -dpar  "<probability> <low>:<high>" arbitrary port ranges
+ *   -sper, -dper  "<probability> <port>" exact ports
+ *   -wc_wc ... -em_em  prefix lengths for the port pair class,
+ *           "<total length>,<probability> <src length>,<probability> ..."
+ *           (the source length distribution is conditional to the total length)
+ *
+ * The address nesting/skew sections are not modelled, the upper 16 bits of the
+ * addresses are selected from a pool of networks to get the overlapping rules.
+ *
+ * The generated ruleset depends only on the parameters and the random seed
+ * (not on the number of threads).
+ */
+class RulesetGenerator {
+public:
+	// WC = wildcard, HI = 1024:65535, LO = 0:1023, AR = arbitrary range, EM = exact match
+	static constexpr size_t PORT_PAIR_CLASS_CNT = 25;
+	static const std::array<const char*, PORT_PAIR_CLASS_CNT> PORT_PAIR_CLASS_NAMES;
+
+	/**
+	 * @throws std::ifstream::failure if the file can not be read or it has invalid format
+	 */
+	RulesetGenerator(const std::string &parameter_file);
+
+	/**
+	 * Generate rule_cnt unique rules, the first rule has the highest priority
+	 */
+	std::vector<Rule> Generate(size_t rule_cnt, uint64_t seed,
+			size_t thread_cnt = 0) const;
+
+private:
+	using rng_t = std::mt19937_64;
+	template<typename T>
+	struct Distribution {
+		std::vector<T> values;
+		std::vector<double> cummulative;
+		void add(const T &v, double prob);
+		bool empty() const {
+			return values.empty() || cummulative.back() <= 0;
+		}
+		const T& sample(rng_t &rng) const;
+	};
+	struct ProtocolClass {
+		int protocol;
+		Distribution<size_t> port_pair_class;
+	};
+	struct PrefixLengths {
+		Distribution<int> total;
+		// source length for each total length
+		std::array<Distribution<int>, 65> src;
+	};
+
+	static constexpr size_t CHUNK_SIZE = 4096;
+	static constexpr size_t NETWORK_POOL_SIZE = 1024;
+
+	void GenerateChunk(size_t chunk_index, uint64_t seed,
+			const std::vector<uint32_t> &src_networks,
+			const std::vector<uint32_t> &dst_networks,
+			std::vector<Rule> &rules) const;
+	void GeneratePort(rng_t &rng, char kind, bool is_src, Range1d &r) const;
+	void GenerateAddress(rng_t &rng, const std::vector<uint32_t> &networks,
+			int len, Range1d &r, unsigned &prefix_length) const;
+
+	Distribution<ProtocolClass> protocols;
+	Distribution<Range1d> src_ranges, dst_ranges;
+	Distribution<uint32_t> src_ports, dst_ports;
+	std::array<PrefixLengths, PORT_PAIR_CLASS_CNT> prefix_lengths;
+};
@@ -0,0 +1,46 @@
+#include "CutSplit.h"
+#include "../HyperSplit/HyperSplit.h"
+
+using namespace std;
+
+CutSplit::CutSplit(size_t binth, int threshold, double spfac) :
+		CuttingClassifier("CutSplit"), binth(binth), threshold(threshold), spfac(
+				spfac) {
+}
+
+void CutSplit::_ConstructClassifier(const vector<Rule> &rules) {
+	this->rules = rules;
+	SortRules(this->rules);
+
+	uint64_t smallWidth = 1ull << (32 - threshold);
+	// bit 0 = small source, bit 1 = small destination address
+	list<Rule*> subsets[4];
+	for (Rule &r : this->rules) {
+		int small = 0;
+		for (int d : { FieldSA, FieldDA }) {
+			uint64_t width = uint64_t(r.range[d].high) - r.range[d].low + 1;
+			if (width <= smallWidth)
+				small |= 1 << d;
+		}
+		subsets[small].push_back(&r);
+	}
+
+	size_t leafSize = binth;
+	auto hyperSplit = [leafSize](const vector<Rule> &leaf,
+			const vector<Range1d> &bounds) {
+		HyperSplit *hs = new HyperSplit(bounds, leafSize);
+		hs->_ConstructClassifier(leaf);
+		return hs;
+	};
+	for (int small = 0; small < 4; small++) {
+		// only the small address fields are cut and not below the small range
+		vector<uint64_t> minWidth(5, 0);
+		if (small & (1 << FieldSA))
+			minWidth[FieldSA] = smallWidth;
+		if (small & (1 << FieldDA))
+			minWidth[FieldDA] = smallWidth;
+		HyperCutsHelper helper(binth, spfac, small == 3);
+		helper.SetMinCutWidth(minWidth);
+		AddTree(subsets[small], helper, binth, hyperSplit);
+	}
+}
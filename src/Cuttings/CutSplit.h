@@ -0,0 +1,32 @@
+#pragma once
+
+#include "CuttingClassifier.h"
+
+/**
+ * CutSplit (Li et al., INFOCOM 2018)
+ *
+ * The rules are separated by the size of the address fields (the field is
+ * small if its prefix is at least "CutSplit.Threshold" bits long). The subsets
+ * with small source and/or destination address are pre-cut by equal-sized
+ * cuts of the small address fields (FiCuts) down to the size of the small
+ * ranges, the leaves with more than binth rules are split by HyperSplit.
+ * The rules with both addresses large are stored in HyperSplit directly.
+ *
+ * "CutSplit.Binth" max rules in leaf, "CutSplit.Spfac" space factor
+ */
+class CutSplit: public CuttingClassifier {
+public:
+	CutSplit(size_t binth = 8, int threshold = 16, double spfac = 8);
+	CutSplit(const std::unordered_map<std::string, std::string> &args) :
+			CutSplit(GetIntOrElse(args, "CutSplit.Binth", 8),
+					GetIntOrElse(args, "CutSplit.Threshold", 16),
+					GetDoubleOrElse(args, "CutSplit.Spfac", 8)) {
+	}
+
+	virtual void _ConstructClassifier(const std::vector<Rule> &rules);
+
+private:
+	size_t binth;
+	int threshold;
+	double spfac;
+};
@@ -0,0 +1,65 @@
+#include "CuttingClassifier.h"
+
+using namespace std;
+
+void CuttingClassifier::AddTree(const list<Rule*> &treeRules,
+		HyperCutsHelper &helper, size_t leafSize,
+		FlatCutTree::LeafClassifierFactory leafClassifier) {
+	if (treeRules.empty())
+		return;
+	HyperCutsNode *root = helper.CreateTree(treeRules);
+	Tree t;
+	t.tree.Build(root, rules, leafSize, leafClassifier);
+	HyperCutsHelper::DeleteTree(root);
+	t.maxPriority = -1;
+	for (const Rule *r : treeRules)
+		t.maxPriority = max(t.maxPriority, r->priority);
+	t.rules = treeRules.size();
+
+	auto pos = trees.begin();
+	while (pos != trees.end() && pos->maxPriority >= t.maxPriority)
+		pos++;
+	trees.insert(pos, move(t));
+}
+
+int CuttingClassifier::ClassifyAPacket(const Packet &packet) {
+	int best = -1;
+	int query = 0;
+	for (Tree &t : trees) {
+		MEMORY_ACCESS_TRACE(&t, sizeof(Tree));
+		if (t.maxPriority <= best)
+			break;
+		best = t.tree.Classify(packet, best);
+		query++;
+	}
+	QueryCountersUpdate(query);
+	return best;
+}
+
+Memory CuttingClassifier::MemSizeBytes() const {
+	Memory size = 0;
+	for (const Tree &t : trees)
+		size += t.tree.MemSizeBytes();
+	return size;
+}
+
+int CuttingClassifier::MemoryAccess() const {
+	int depth = 0;
+	for (const Tree &t : trees)
+		depth += t.tree.Depth();
+	return depth;
+}
+
+void CuttingClassifier::CollectStats(map<string, string> &summary) const {
+	size_t nodes = 0, leafRules = 0, depth = 0;
+	for (const Tree &t : trees) {
+		nodes += t.tree.NumNodes();
+		leafRules += t.tree.NumLeafRules();
+		depth = max(depth, t.tree.Depth());
+	}
+	summary[name + ".Trees"] = to_string(trees.size());
+	summary[name + ".Nodes"] = to_string(nodes);
+	summary[name + ".MaxDepth"] = to_string(depth);
+	// rule references in the leaves (shared leaves are counted once)
+	summary[name + ".LeafRules"] = to_string(leafRules);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "FlatCutTree.h"
+
+#include <string>
+
+/**
+ * Base of the classifiers which split the rules in to several decision trees
+ * built by cutting (HiCuts, EffiCuts, CutSplit)
+ *
+ * The trees are searched in the order of their max priority and the search
+ * ends when no tree can contain a better rule.
+ */
+class CuttingClassifier: public PacketClassifier {
+public:
+	// name is used as prefix of the stats
+	CuttingClassifier(const std::string &name) :
+			name(name) {
+	}
+
+	virtual int ClassifyAPacket(const Packet &packet);
+	virtual void _DeleteRule(size_t) {
+		printf("Deletion not supported\n");
+	}
+	virtual void _InsertRule(const Rule&) {
+		printf("Insertion not supported\n");
+	}
+	virtual Memory MemSizeBytes() const;
+	// sum of the depths of the trees
+	virtual int MemoryAccess() const;
+	virtual bool SupportsMemoryAccessTrace() const {
+		return true;
+	}
+	virtual size_t NumTables() const {
+		return trees.size();
+	}
+	virtual size_t RulesInTable(size_t tableIndex) const {
+		return trees[tableIndex].rules;
+	}
+	virtual void CollectStats(std::map<std::string, std::string> &summary) const;
+
+protected:
+	/**
+	 * Build the tree for the subset of this->rules (this->rules have to be
+	 * sorted by priority and must not change after the tree is built)
+	 */
+	void AddTree(const std::list<Rule*> &treeRules, HyperCutsHelper &helper,
+			size_t leafSize = 0,
+			FlatCutTree::LeafClassifierFactory leafClassifier = nullptr);
+
+	std::vector<Rule> rules;
+
+private:
+	struct Tree {
+		FlatCutTree tree;
+		int maxPriority;
+		size_t rules;
+	};
+	// sorted by maxPriority
+	std::vector<Tree> trees;
+	std::string name;
+};
@@ -0,0 +1,57 @@
+#include "EffiCuts.h"
+
+using namespace std;
+
+// sizes of the 5-tuple fields
+static const uint64_t FIELD_SIZE[] = { 1ull << 32, 1ull << 32, 1ull << 16, 1ull
+		<< 16, 1ull << 8 };
+
+EffiCuts::EffiCuts(size_t binth, double spfac, double largeness) :
+		CuttingClassifier("EffiCuts"), binth(binth), spfac(spfac), largeness(
+				largeness) {
+}
+
+void EffiCuts::_ConstructClassifier(const vector<Rule> &rules) {
+	this->rules = rules;
+	SortRules(this->rules);
+
+	// bit d set = the field d is large
+	map<uint32_t, list<Rule*>> categories;
+	for (Rule &r : this->rules) {
+		uint32_t large = 0;
+		for (int d = 0; d < r.dim; d++) {
+			uint64_t width = uint64_t(r.range[d].high) - r.range[d].low + 1;
+			if (width > largeness * FIELD_SIZE[d])
+				large |= 1u << d;
+		}
+		categories[large].push_back(&r);
+	}
+
+	// merge the small categories, the rules of the merged category are small
+	// in all fields which are small in the target category
+	for (auto c = categories.begin(); c != categories.end();) {
+		auto target = categories.end();
+		if (c->second.size() <= binth) {
+			for (auto t = categories.begin(); t != categories.end(); t++) {
+				if (t == c || (t->first & c->first) != c->first)
+					continue;
+				if (target == categories.end()
+						|| __builtin_popcount(t->first)
+								< __builtin_popcount(target->first))
+					target = t;
+			}
+		}
+		if (target == categories.end()) {
+			c++;
+			continue;
+		}
+		target->second.merge(c->second, [](const Rule *a, const Rule *b) {
+			return a->priority > b->priority;
+		});
+		c = categories.erase(c);
+	}
+
+	HyperCutsHelper helper(binth, spfac, true);
+	for (auto &c : categories)
+		AddTree(c.second, helper);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "CuttingClassifier.h"
+
+/**
+ * EffiCuts (Vamanan, Voskuilen, Vijaykumar, SIGCOMM 2010)
+ *
+ * The rules are separated by the combination of their large fields (the field
+ * is large if the range covers more than "EffiCuts.Largeness" of the field),
+ * each category has its own HyperCuts tree. The categories with at most binth
+ * rules are merged in to the category which has the least additional
+ * large fields (tree merging).
+ *
+ * "EffiCuts.Binth" max rules in leaf, "EffiCuts.Spfac" space factor
+ */
+class EffiCuts: public CuttingClassifier {
+public:
+	EffiCuts(size_t binth = 8, double spfac = 8, double largeness = 0.5);
+	EffiCuts(const std::unordered_map<std::string, std::string> &args) :
+			EffiCuts(GetIntOrElse(args, "EffiCuts.Binth", 8),
+					GetDoubleOrElse(args, "EffiCuts.Spfac", 8),
+					GetDoubleOrElse(args, "EffiCuts.Largeness", 0.5)) {
+	}
+
+	virtual void _ConstructClassifier(const std::vector<Rule> &rules);
+
+private:
+	size_t binth;
+	double spfac;
+	double largeness;
+};
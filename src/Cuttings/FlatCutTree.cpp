@@ -0,0 +1,104 @@
+#include "FlatCutTree.h"
+
+#include <stdexcept>
+
+using namespace std;
+
+static int Log2(uint64_t x) {
+	if (x == 0 || (x & (x - 1)))
+		throw runtime_error("FlatCutTree: the cut is not a power of 2");
+	return __builtin_ctzll(x);
+}
+
+void FlatCutTree::SetCuts(const HyperCutsNode *n, Node &node) {
+	node.cutDims = 0;
+	for (size_t d = 0; d < n->bounds.size(); d++) {
+		if (n->cuts[d] <= 1)
+			continue;
+		if (node.cutDims == MAX_CUT_DIMS)
+			throw runtime_error("FlatCutTree: too many cut dimensions");
+		int c = node.cutDims++;
+		uint64_t width = uint64_t(n->bounds[d].high) - n->bounds[d].low + 1;
+		node.dim[c] = d;
+		node.cutBits[c] = Log2(n->cuts[d]);
+		node.spanBits[c] = Log2(width / n->cuts[d]);
+		node.low[c] = n->bounds[d].low;
+	}
+}
+
+uint32_t FlatCutTree::AddNode(const HyperCutsNode *n, Pending &pending) {
+	vector<uint32_t> nodeRules;
+	for (const Rule *r : n->classifier)
+		nodeRules.push_back(r - rules->data());
+	bool isLeaf = n->childArray.empty();
+	if (isLeaf) {
+		auto shared = leaves.find(nodeRules);
+		if (shared != leaves.end())
+			return shared->second;
+	}
+
+	Node node;
+	node.rulesBegin = leafRules.size();
+	node.rulesEnd = node.rulesBegin;
+	node.children = NONE;
+	node.leafClassifier = NONE;
+	node.cutDims = 0;
+	if (leafClassifier && nodeRules.size() > leafSize) {
+		vector<Rule> leaf;
+		for (uint32_t i : nodeRules)
+			leaf.push_back((*rules)[i]);
+		node.leafClassifier = leafClassifiers.size();
+		leafClassifiers.emplace_back(leafClassifier(leaf, n->bounds));
+	} else {
+		leafRules.insert(leafRules.end(), nodeRules.begin(), nodeRules.end());
+		node.rulesEnd = leafRules.size();
+	}
+	uint32_t index = nodes.size();
+	nodes.push_back(node);
+	if (isLeaf) {
+		leaves[nodeRules] = index;
+	} else {
+		pending.push_back( { n, index });
+	}
+	return index;
+}
+
+void FlatCutTree::Build(const HyperCutsNode *root, const vector<Rule> &rules,
+		size_t leafSize, LeafClassifierFactory leafClassifier) {
+	this->rules = &rules;
+	this->leafSize = leafSize;
+	this->leafClassifier = leafClassifier;
+	nodes.clear();
+	children.clear();
+	leafRules.clear();
+	leafClassifiers.clear();
+	depth = 1;
+
+	// breadth first, the children of a node are added together
+	Pending pending, next;
+	AddNode(root, pending);
+	while (!pending.empty()) {
+		depth++;
+		for (auto &p : pending) {
+			const HyperCutsNode *n = p.first;
+			SetCuts(n, nodes[p.second]);
+			uint32_t first = children.size();
+			nodes[p.second].children = first;
+			children.resize(first + n->childArray.size());
+			for (size_t i = 0; i < n->childArray.size(); i++)
+				children[first + i] = AddNode(n->childArray[i], next);
+		}
+		pending.swap(next);
+		next.clear();
+	}
+	leaves.clear();
+}
+
+Memory FlatCutTree::MemSizeBytes() const {
+	Memory size = nodes.size() * sizeof(Node)
+			+ children.size() * sizeof(uint32_t)
+			+ leafRules.size() * sizeof(uint32_t);
+	for (auto &c : leafClassifiers)
+		size += c->MemSizeBytes();
+	return size;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "../HyperCuts/HyperCuts.h"
+
+#include <functional>
+#include <memory>
+
+/**
+ * Decision tree of the cutting algorithms (HyperCutsNode) flattened in to
+ * arrays
+ *
+ * The nodes are stored in a single array, the children of a node are
+ * a continuous block of node indices and the rules of the leaves are ranges
+ * in a single array of rule indices. The leaves with the same rules share
+ * the node and the rule storage. The cuts are equal-sized power of 2 parts
+ * of the node, so the child index is computed by shifts.
+ *
+ * The leaves with more than leafSize rules (the node could not be cut) can be
+ * searched by a separate classifier (e.g. CutSplit uses HyperSplit).
+ */
+class FlatCutTree {
+public:
+	// classifier for the rules of a leaf, bounds are the boundaries of the leaf
+	typedef std::function<PacketClassifier*(const std::vector<Rule>&,
+			const std::vector<Range1d>&)> LeafClassifierFactory;
+
+	/**
+	 * @param root the tree (it is not modified)
+	 * @param rules the rules referenced by the tree (sorted by priority),
+	 * 	the rule index is used in the leaves
+	 */
+	void Build(const HyperCutsNode *root, const std::vector<Rule> &rules,
+			size_t leafSize = 0, LeafClassifierFactory leafClassifier = nullptr);
+
+	/**
+	 * @param best priority of the rule found so far
+	 * @return max of best and the priority of the best matching rule
+	 */
+	inline int Classify(const Packet &packet, int best) {
+		uint32_t n = 0;
+		for (;;) {
+			const Node &node = nodes[n];
+			MEMORY_ACCESS_TRACE(&node, sizeof(Node));
+			// rules are sorted by priority, the first match is the best one
+			for (uint32_t i = node.rulesBegin; i < node.rulesEnd; i++) {
+				MEMORY_ACCESS_TRACE(&leafRules[i], sizeof(uint32_t));
+				const Rule &r = (*rules)[leafRules[i]];
+				if (r.priority <= best)
+					break;
+				if (r.MatchesPacket(packet)) {
+					best = r.priority;
+					break;
+				}
+			}
+			if (node.leafClassifier != NONE)
+				best = std::max(best,
+						leafClassifiers[node.leafClassifier]->ClassifyAPacket(
+								packet));
+			if (node.children == NONE)
+				return best;
+			uint32_t index = 0;
+			for (int c = 0; c < node.cutDims; c++) {
+				index <<= node.cutBits[c];
+				index += (packet[node.dim[c]] - node.low[c]) >> node.spanBits[c];
+			}
+			MEMORY_ACCESS_TRACE(&children[node.children + index], sizeof(uint32_t));
+			n = children[node.children + index];
+		}
+	}
+
+	size_t NumNodes() const {
+		return nodes.size();
+	}
+	size_t NumLeafRules() const {
+		return leafRules.size();
+	}
+	size_t Depth() const {
+		return depth;
+	}
+	Memory MemSizeBytes() const;
+
+private:
+	static constexpr uint32_t NONE = UINT32_MAX;
+	static constexpr int MAX_CUT_DIMS = 2;
+
+	struct Node {
+		// range of leafRules
+		uint32_t rulesBegin;
+		uint32_t rulesEnd;
+		// index of the first child in children (or NONE)
+		uint32_t children;
+		// index in leafClassifiers (or NONE)
+		uint32_t leafClassifier;
+		uint8_t cutDims;
+		uint8_t dim[MAX_CUT_DIMS];
+		// log2 of the number of cuts and of the size of the child in dimension
+		uint8_t cutBits[MAX_CUT_DIMS];
+		uint8_t spanBits[MAX_CUT_DIMS];
+		Point1d low[MAX_CUT_DIMS];
+	};
+	// internal nodes with their index in nodes
+	typedef std::vector<std::pair<const HyperCutsNode*, uint32_t>> Pending;
+	uint32_t AddNode(const HyperCutsNode *n, Pending &pending);
+	void SetCuts(const HyperCutsNode *n, Node &node);
+
+	const std::vector<Rule> *rules = nullptr;
+	size_t leafSize = 0;
+	LeafClassifierFactory leafClassifier;
+
+	std::vector<Node> nodes;
+	std::vector<uint32_t> children;
+	std::vector<uint32_t> leafRules;
+	std::vector<std::unique_ptr<PacketClassifier>> leafClassifiers;
+	// the shared leaves (rule indices -> node index)
+	std::map<std::vector<uint32_t>, uint32_t> leaves;
+	size_t depth = 0;
+};
@@ -0,0 +1,17 @@
+#include "HiCuts.h"
+
+using namespace std;
+
+HiCuts::HiCuts(size_t binth, double spfac) :
+		CuttingClassifier("HiCuts"), binth(binth), spfac(spfac) {
+}
+
+void HiCuts::_ConstructClassifier(const vector<Rule> &rules) {
+	this->rules = rules;
+	SortRules(this->rules);
+	list<Rule*> treeRules;
+	for (Rule &r : this->rules)
+		treeRules.push_back(&r);
+	HyperCutsHelper helper(binth, spfac, false);
+	AddTree(treeRules, helper);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "CuttingClassifier.h"
+
+/**
+ * HiCuts (Gupta, McKeown, Hot Interconnects 1999), a single decision tree
+ * which cuts one dimension in each node
+ *
+ * "HiCuts.Binth" max rules in leaf, "HiCuts.Spfac" space factor
+ */
+class HiCuts: public CuttingClassifier {
+public:
+	HiCuts(size_t binth = 8, double spfac = 4);
+	HiCuts(const std::unordered_map<std::string, std::string> &args) :
+			HiCuts(GetIntOrElse(args, "HiCuts.Binth", 8),
+					GetDoubleOrElse(args, "HiCuts.Spfac", 4)) {
+	}
+
+	virtual void _ConstructClassifier(const std::vector<Rule> &rules);
+
+private:
+	size_t binth;
+	double spfac;
+};
@@ -0,0 +1,136 @@
+#include "DimensionSchema.h"
+#include "Utilities/MapExtensions.h"
+
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+using namespace std;
+
+static DimensionSchema current = DimensionSchema::IPv4();
+
+void DimensionSchema::AddField(const string &name, int width) {
+	if (width <= 0 || width > MAX_FIELD_WIDTH
+			|| (width > LANE_WIDTH && width % LANE_WIDTH))
+		throw invalid_argument(
+				"DimensionSchema: invalid width of the field " + name + ": "
+						+ to_string(width));
+	int lanes = (width + LANE_WIDTH - 1) / LANE_WIDTH;
+	fields.push_back( { name, width, int(lane_field.size()), lanes });
+	for (int i = 0; i < lanes; i++)
+		lane_field.push_back(fields.size() - 1);
+}
+
+DimensionSchema DimensionSchema::Parse(const string &spec) {
+	DimensionSchema s;
+	vector<string> tokens;
+	Split(spec, ',', tokens);
+	for (const string &t : tokens) {
+		size_t colon = t.find(':');
+		if (colon == string::npos)
+			throw invalid_argument(
+					"DimensionSchema: expected <name>:<width>, got \"" + t
+							+ "\"");
+		s.AddField(t.substr(0, colon), stoi(t.substr(colon + 1)));
+	}
+	return s;
+}
+
+DimensionSchema DimensionSchema::IPv4(int reps) {
+	DimensionSchema s;
+	for (int i = 0; i < reps; i++) {
+		s.AddField("sa", 32);
+		s.AddField("da", 32);
+		s.AddField("sp", 16);
+		s.AddField("dp", 16);
+		s.AddField("proto", 8);
+	}
+	return s;
+}
+
+DimensionSchema DimensionSchema::IPv6(int reps) {
+	DimensionSchema s;
+	for (int i = 0; i < reps; i++) {
+		s.AddField("sa", 128);
+		s.AddField("da", 128);
+		s.AddField("sp", 16);
+		s.AddField("dp", 16);
+		s.AddField("proto", 8);
+	}
+	return s;
+}
+
+DimensionSchema DimensionSchema::Generic(int dim) {
+	DimensionSchema s;
+	for (int i = 0; i < dim; i++)
+		s.AddField("f" + to_string(i), 32);
+	return s;
+}
+
+const DimensionSchema& DimensionSchema::ForDim(int dim) {
+	if (int(current.NumLanes()) == dim)
+		return current;
+	static mutex lock;
+	static map<int, DimensionSchema> cache;
+	lock_guard<mutex> guard(lock);
+	auto s = cache.find(dim);
+	if (s != cache.end())
+		return s->second;
+	if (dim > 0 && dim % 5 == 0)
+		return cache[dim] = IPv4(dim / 5);
+	if (dim > 0 && dim % 11 == 0)
+		return cache[dim] = IPv6(dim / 11);
+	return cache[dim] = Generic(dim);
+}
+
+const DimensionSchema& DimensionSchema::Current() {
+	return current;
+}
+
+void DimensionSchema::SetCurrent(const DimensionSchema &schema) {
+	current = schema;
+}
+
+vector<Range1d> DimensionSchema::Bounds() const {
+	vector<Range1d> bounds;
+	for (size_t d = 0; d < NumLanes(); d++)
+		bounds.push_back( { 0, LaneMax(d) });
+	return bounds;
+}
+
+int DimensionSchema::FieldPrefixLength(const vector<int> &lane_lengths,
+		size_t f) const {
+	const Field &field = fields[f];
+	if (field.lanes == 1)
+		return max(0, lane_lengths[field.first_lane] - (LANE_WIDTH - field.width));
+	int length = 0;
+	for (int i = 0; i < field.lanes; i++) {
+		int l = lane_lengths[field.first_lane + i];
+		length += l;
+		if (l != LANE_WIDTH)
+			break;
+	}
+	return length;
+}
+
+void DimensionSchema::SetFieldPrefixLength(vector<int> &lane_lengths,
+		size_t f, int length) const {
+	const Field &field = fields[f];
+	if (field.lanes == 1) {
+		lane_lengths[field.first_lane] = length + (LANE_WIDTH - field.width);
+		return;
+	}
+	for (int i = 0; i < field.lanes; i++)
+		lane_lengths[field.first_lane + i] = min(LANE_WIDTH,
+				max(0, length - i * LANE_WIDTH));
+}
+
+string DimensionSchema::ToString() const {
+	string s;
+	for (const Field &f : fields) {
+		if (s.size())
+			s += ",";
+		s += f.name + ":" + to_string(f.width);
+	}
+	return s;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "ElementaryClasses.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Layout of the header fields in the dimensions of Rule and Packet
+ *
+ * Each field (up to 128b) is split in to 32b lanes, the most significant lane
+ * first, and each lane is one dimension. A prefix of a wide field (IPv6
+ * address) is stored as a prefix in each of its lanes: the lanes covered by the
+ * prefix are exact, the lanes after the prefix are wildcards. The fields
+ * narrower than 32b are stored in the low bits of their lane. The prefix_length
+ * of a lane is always relative to 32b (the exact 16b port has prefix_length 32).
+ *
+ * The schema of the rules is set by InputReader, the classifiers get it by
+ * ForDim(rules[0].dim).
+ */
+class DimensionSchema {
+public:
+	struct Field {
+		std::string name;
+		int width;
+		int first_lane;
+		int lanes;
+	};
+	static constexpr int LANE_WIDTH = 32;
+	static constexpr int MAX_FIELD_WIDTH = 128;
+
+	/**
+	 * @param spec fields as "<name>:<width>" separated by ',',
+	 * 	e.g. "sa:128,da:128,sp:16,dp:16,proto:8"
+	 * @throws std::invalid_argument if the spec is not valid
+	 */
+	static DimensionSchema Parse(const std::string &spec);
+	// reps times sa, da, sp, dp, proto
+	static DimensionSchema IPv4(int reps = 1);
+	static DimensionSchema IPv6(int reps = 1);
+	// dim 32b fields
+	static DimensionSchema Generic(int dim);
+
+	/**
+	 * The current schema if it has dim lanes, otherwise IPv4 (dim = 5*n),
+	 * IPv6 (dim = 11*n) or Generic (the schemas are cached)
+	 */
+	static const DimensionSchema& ForDim(int dim);
+	static const DimensionSchema& Current();
+	static void SetCurrent(const DimensionSchema &schema);
+
+	/**
+	 * @throws std::invalid_argument if the width is not in 1-32 or a multiple of 32 up to 128
+	 */
+	void AddField(const std::string &name, int width);
+
+	size_t NumFields() const {
+		return fields.size();
+	}
+	size_t NumLanes() const {
+		return lane_field.size();
+	}
+	const Field& GetField(size_t f) const {
+		return fields[f];
+	}
+	int FieldOfLane(size_t lane) const {
+		return lane_field[lane];
+	}
+	// number of used bits of the lane
+	int LaneWidth(size_t lane) const {
+		return std::min(LANE_WIDTH, fields[lane_field[lane]].width);
+	}
+	Point1d LaneMax(size_t lane) const {
+		return LaneWidth(lane) == LANE_WIDTH ?
+				0xFFFFFFFFu : (1u << LaneWidth(lane)) - 1;
+	}
+	// the whole range of each lane
+	std::vector<Range1d> Bounds() const;
+	// some field has more than one lane
+	bool HasWideFields() const {
+		return NumLanes() != NumFields();
+	}
+
+	/**
+	 * Prefix length of the field (0 - field width) from the prefix lengths
+	 * of its lanes
+	 */
+	int FieldPrefixLength(const std::vector<int> &lane_lengths, size_t f) const;
+	void SetFieldPrefixLength(std::vector<int> &lane_lengths, size_t f,
+			int length) const;
+
+	// the spec accepted by Parse
+	std::string ToString() const;
+	bool operator==(const DimensionSchema &other) const {
+		return ToString() == other.ToString();
+	}
+
+private:
+	std::vector<Field> fields;
+	std::vector<int> lane_field;
+};
@@ -14,6 +14,8 @@
 #include <sstream>
 #include <boost/functional/hash.hpp>
 
+#include "Utilities/MemoryAccessTrace.h"
+
 enum Dimensions {
 	FieldSA = 0, FieldDA = 1, FieldSP = 2, FieldDP = 3, FieldProto = 4,
 };
@@ -145,6 +147,8 @@ struct Rule {
 	std::vector<unsigned> prefix_length;
 
 	bool inline MatchesPacket(const Packet &p) const {
+		MEMORY_ACCESS_TRACE(this, sizeof(Rule));
+		MEMORY_ACCESS_TRACE(range.data(), dim * sizeof(Range1d));
 		for (int i = 0; i < dim; i++) {
 			if (p[i] < range[i].low || p[i] > range[i].high)
 				return false;
@@ -184,6 +188,20 @@ struct hash<Range1d> {
 
 };
 
+template<>
+struct hash<std::vector<Range1d>> {
+	typedef std::vector<Range1d> argument_type;
+	typedef std::size_t result_type;
+	result_type operator()(argument_type const &v) const noexcept {
+		using boost::hash_combine;
+		result_type h = 0;
+		for (const auto &r : v) {
+			hash_combine(h, hash<Range1d> { }(r));
+		}
+		return h;
+	}
+};
+
 template<>
 struct hash<Rule> {
 	typedef Rule argument_type;
@@ -291,12 +309,12 @@ enum PSMode {
 
 inline void SortRules(std::vector<Rule> &rules) {
 	sort(rules.begin(), rules.end(), [](const Rule &rx, const Rule &ry) {
-		return rx.priority >= ry.priority;
+		return rx.priority > ry.priority;
 	});
 }
 
 inline void SortRules(std::vector<Rule*> &rules) {
 	sort(rules.begin(), rules.end(), [](const Rule *rx, const Rule *ry) {
-		return rx->priority >= ry->priority;
+		return rx->priority > ry->priority;
 	});
 }
@@ -0,0 +1,171 @@
+#include "ExactMatch.h"
+
+#include <algorithm>
+
+using namespace std;
+
+ExactMatchClassifier::ExactMatchClassifier(
+		unique_ptr<PacketClassifier> fallback) :
+		fallback(move(fallback)), fallback_constructed(false) {
+}
+
+void ExactMatchClassifier::_ConstructClassifier(const vector<Rule> &rules) {
+	this->rules.reserve(rules.size());
+	locations.reserve(rules.size());
+	vector<Rule> residue;
+	size_t exact_cnt = 0;
+	for (const Rule &r : rules) {
+		if (ExactMatchTable::IsExactRule(r))
+			exact_cnt++;
+	}
+	exact.Reserve(exact_cnt);
+
+	for (const Rule &r : rules) {
+		if (ExactMatchTable::IsExactRule(r)) {
+			InsertExact(r);
+			locations.push_back( { true, 0 });
+		} else {
+			locations.push_back( { false, residue.size() });
+			fallback_rules.push_back(this->rules.size());
+			fallback_priorities.Insert(r.priority);
+			residue.push_back(r);
+		}
+		this->rules.push_back(r);
+	}
+	if (residue.size()) {
+		fallback->ConstructClassifier(residue);
+		fallback_constructed = true;
+	}
+}
+
+int ExactMatchClassifier::ClassifyAPacket(const Packet &packet) {
+	int result = exact.Find(ExactMatchTable::Key::FromPacket(packet));
+	int query = 1;
+	if (fallback_priorities.Max() > result) {
+		result = max(result, fallback->ClassifyAPacket(packet));
+		query++;
+	}
+	QueryCountersUpdate(query);
+	return result;
+}
+
+void ExactMatchClassifier::InsertExact(const Rule &rule) {
+	auto key = ExactMatchTable::Key::FromRule(rule);
+	int *prio = exact.Get(key);
+	if (prio == nullptr) {
+		exact.Insert(key, rule.priority);
+	} else if (*prio < rule.priority) {
+		shadowed[key].push_back(*prio);
+		*prio = rule.priority;
+	} else {
+		shadowed[key].push_back(rule.priority);
+	}
+}
+
+void ExactMatchClassifier::DeleteExact(const Rule &rule) {
+	auto key = ExactMatchTable::Key::FromRule(rule);
+	auto sh = shadowed.find(key);
+	if (sh == shadowed.end()) {
+		exact.Erase(key);
+		return;
+	}
+	auto &prios = sh->second;
+	int *prio = exact.Get(key);
+	if (*prio == rule.priority) {
+		// replace by the next highest priority rule with the same key
+		auto m = max_element(prios.begin(), prios.end());
+		*prio = *m;
+		prios.erase(m);
+	} else {
+		prios.erase(find(prios.begin(), prios.end(), rule.priority));
+	}
+	if (prios.empty())
+		shadowed.erase(sh);
+}
+
+void ExactMatchClassifier::InsertFallback(const Rule &rule, size_t index) {
+	if (fallback_constructed) {
+		fallback->InsertRule(rule);
+	} else {
+		fallback->ConstructClassifier( { rule });
+		fallback_constructed = true;
+	}
+	fallback_rules.push_back(index);
+	fallback_priorities.Insert(rule.priority);
+}
+
+void ExactMatchClassifier::DeleteFallback(size_t index) {
+	size_t fi = locations[index].fallback_index;
+	fallback->DeleteRule(fi);
+	fallback_priorities.Erase(rules[index].priority);
+	// the fallback moves its last rule on the place of the removed one
+	size_t last = fallback_rules.size() - 1;
+	if (fi != last) {
+		fallback_rules[fi] = fallback_rules[last];
+		locations[fallback_rules[fi]].fallback_index = fi;
+	}
+	fallback_rules.pop_back();
+}
+
+void ExactMatchClassifier::_InsertRule(const Rule &rule) {
+	size_t index = rules.size();
+	if (ExactMatchTable::IsExactRule(rule)) {
+		InsertExact(rule);
+		locations.push_back( { true, 0 });
+	} else {
+		locations.push_back( { false, fallback_rules.size() });
+		InsertFallback(rule, index);
+	}
+	rules.push_back(rule);
+}
+
+void ExactMatchClassifier::_DeleteRule(size_t index) {
+	if (index >= rules.size()) {
+		printf("Warning index delete rule out of bound: do nothing here\n");
+		printf("%lu vs. size: %lu\n", index, rules.size());
+		return;
+	}
+	if (locations[index].exact)
+		DeleteExact(rules[index]);
+	else
+		DeleteFallback(index);
+
+	size_t last = rules.size() - 1;
+	if (index != last) {
+		rules[index] = move(rules[last]);
+		locations[index] = locations[last];
+		if (!locations[index].exact)
+			fallback_rules[locations[index].fallback_index] = index;
+	}
+	rules.pop_back();
+	locations.pop_back();
+}
+
+Memory ExactMatchClassifier::MemSizeBytes() const {
+	Memory mem = exact.MemSizeBytes();
+	if (fallback_constructed)
+		mem += fallback->MemSizeBytes();
+	return mem;
+}
+
+int ExactMatchClassifier::MemoryAccess() const {
+	return 1 + (fallback_constructed ? fallback->MemoryAccess() : 0);
+}
+
+size_t ExactMatchClassifier::NumTables() const {
+	return 1 + (fallback_constructed ? fallback->NumTables() : 0);
+}
+
+size_t ExactMatchClassifier::RulesInTable(size_t tableIndex) const {
+	if (tableIndex == 0)
+		return exact.Size();
+	return fallback->RulesInTable(tableIndex - 1);
+}
+
+void ExactMatchClassifier::CollectStats(
+		map<string, string> &summary) const {
+	summary["ExactRules"] = to_string(rules.size() - fallback_rules.size());
+	summary["FallbackRules"] = to_string(fallback_rules.size());
+	if (fallback_constructed)
+		fallback->CollectStats(summary);
+}
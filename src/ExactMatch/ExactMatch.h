@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../Simulation.h"
+#include "ExactMatchTable.h"
+#include "../Utilities/PriorityTracker.h"
+
+#include <memory>
+#include <unordered_map>
+
+/**
+ * Classifier with a fast path for the rules which match a single 5-tuple
+ *
+ * The exact rules are stored in ExactMatchTable, the rest of the rules
+ * (the wildcard residue) is stored in the fallback classifier. The fallback
+ * is queried only if it contains a rule with higher priority than the exact
+ * match (if any).
+ */
+class ExactMatchClassifier: public PacketClassifier {
+public:
+	ExactMatchClassifier(std::unique_ptr<PacketClassifier> fallback);
+
+	virtual void _ConstructClassifier(const std::vector<Rule> &rules);
+	virtual int ClassifyAPacket(const Packet &packet);
+	virtual void _DeleteRule(size_t index);
+	virtual void _InsertRule(const Rule &rule);
+	virtual Memory MemSizeBytes() const;
+	virtual int MemoryAccess() const;
+	virtual bool SupportsMemoryAccessTrace() const {
+		return fallback->SupportsMemoryAccessTrace();
+	}
+	virtual size_t Maintain(size_t budget) {
+		return fallback_constructed ? fallback->Maintain(budget) : 0;
+	}
+	// exact match table + tables of the fallback classifier
+	virtual size_t NumTables() const;
+	virtual size_t RulesInTable(size_t tableIndex) const;
+	virtual void CollectStats(std::map<std::string, std::string> &summary) const;
+
+private:
+	struct Location {
+		bool exact;
+		// index of the rule in the fallback classifier
+		size_t fallback_index;
+	};
+	void InsertExact(const Rule &rule);
+	void DeleteExact(const Rule &rule);
+	void InsertFallback(const Rule &rule, size_t index);
+	void DeleteFallback(size_t index);
+
+	ExactMatchTable exact;
+	// priorities of the exact rules which have the same key as a rule
+	// with a higher priority (the table contains only the highest priority)
+	std::unordered_map<ExactMatchTable::Key, std::vector<int>,
+			ExactMatchTable::KeyHash> shadowed;
+
+	std::unique_ptr<PacketClassifier> fallback;
+	// the fallback is constructed with the first wildcard rule
+	bool fallback_constructed;
+	// index in fallback -> index in rules
+	std::vector<size_t> fallback_rules;
+	PriorityTracker fallback_priorities;
+
+	std::vector<Rule> rules;
+	std::vector<Location> locations;
+};
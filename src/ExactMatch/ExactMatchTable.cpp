@@ -0,0 +1,124 @@
+#include "ExactMatchTable.h"
+
+#include <cstring>
+
+using namespace std;
+
+bool ExactMatchTable::IsExactRule(const Rule &r) {
+	if (r.dim != 5)
+		return false;
+	for (int d = 0; d < r.dim; d++) {
+		if (r.range[d].low != r.range[d].high)
+			return false;
+	}
+	return true;
+}
+
+ExactMatchTable::ExactMatchTable() :
+		size(0), occupied(0) {
+	Rehash(1);
+}
+
+int* ExactMatchTable::Get(const Key &key) {
+	size_t h = KeyHash()(key);
+	int8_t tag = h & 0x7f;
+	size_t mask = groups.size() - 1;
+	size_t g = (h >> 7) & mask;
+	for (size_t i = 1;; i++) {
+		Group &grp = groups[g];
+		for (uint32_t m = grp.Match(tag); m; m &= m - 1) {
+			Slot &s = grp.slots[__builtin_ctz(m)];
+			if (s.key == key)
+				return &s.value;
+		}
+		if (grp.MatchEmpty())
+			return nullptr;
+		g = (g + i) & mask;
+	}
+}
+
+void ExactMatchTable::Insert(const Key &key, int value) {
+	// keep at least 1/8 of the slots EMPTY so the probe sequences stay short
+	if ((occupied + 1) * 8 > Capacity() * 7) {
+		size_t group_cnt = groups.size();
+		// only DELETED slots are removed if the table is not full enough
+		if ((size + 1) * 16 > Capacity() * 7)
+			group_cnt *= 2;
+		Rehash(group_cnt);
+	}
+	size_t h = KeyHash()(key);
+	size_t mask = groups.size() - 1;
+	size_t g = (h >> 7) & mask;
+	for (size_t i = 1;; i++) {
+		Group &grp = groups[g];
+		uint32_t m = grp.MatchFree();
+		if (m) {
+			size_t j = __builtin_ctz(m);
+			if (grp.ctrl[j] == EMPTY)
+				occupied++;
+			grp.ctrl[j] = h & 0x7f;
+			grp.slots[j] = {key, value};
+			size++;
+			return;
+		}
+		g = (g + i) & mask;
+	}
+}
+
+bool ExactMatchTable::Erase(const Key &key) {
+	size_t h = KeyHash()(key);
+	int8_t tag = h & 0x7f;
+	size_t mask = groups.size() - 1;
+	size_t g = (h >> 7) & mask;
+	for (size_t i = 1;; i++) {
+		Group &grp = groups[g];
+		for (uint32_t m = grp.Match(tag); m; m &= m - 1) {
+			size_t j = __builtin_ctz(m);
+			if (grp.slots[j].key == key) {
+				// the probe of other keys ends in this group if it has an EMPTY slot,
+				// otherwise the slot has to stay occupied for the probe to continue
+				if (grp.MatchEmpty()) {
+					grp.ctrl[j] = EMPTY;
+					occupied--;
+				} else {
+					grp.ctrl[j] = DELETED;
+				}
+				size--;
+				return true;
+			}
+		}
+		if (grp.MatchEmpty())
+			return false;
+		g = (g + i) & mask;
+	}
+}
+
+void ExactMatchTable::Reserve(size_t n) {
+	size_t group_cnt = groups.size();
+	while (n * 8 > group_cnt * GROUP_SIZE * 7)
+		group_cnt *= 2;
+	if (group_cnt != groups.size())
+		Rehash(group_cnt);
+}
+
+void ExactMatchTable::Clear() {
+	groups.clear();
+	size = 0;
+	occupied = 0;
+	Rehash(1);
+}
+
+void ExactMatchTable::Rehash(size_t group_cnt) {
+	vector<Group> old(group_cnt);
+	old.swap(groups);
+	for (auto &grp : groups)
+		memset(grp.ctrl, EMPTY, sizeof(grp.ctrl));
+	size = 0;
+	occupied = 0;
+	for (auto &grp : old) {
+		for (size_t j = 0; j < GROUP_SIZE; j++) {
+			if (grp.ctrl[j] >= 0)
+				Insert(grp.slots[j].key, grp.slots[j].value);
+		}
+	}
+}
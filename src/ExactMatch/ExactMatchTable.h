@@ -0,0 +1,155 @@
+#pragma once
+
+#include "../ElementaryClasses.h"
+
+#include <cstdint>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Hash table of the fully specified 5-tuples (Swiss table layout)
+ *
+ * The slots are organized in to groups of 16, each group has 16 control bytes
+ * which contain 7b of the hash of the key in the slot (or EMPTY/DELETED).
+ * The lookup compares the control bytes of the whole group at once (SSE2)
+ * and compares the keys only for the slots with matching hash bits. The groups
+ * are probed in triangular sequence and the probe ends on the first group
+ * which contains an EMPTY slot.
+ */
+class ExactMatchTable {
+public:
+	struct Key {
+		uint64_t addrs; // src ip << 32 | dst ip
+		uint64_t ports; // src port << 32 | dst port
+		uint32_t proto;
+
+		bool operator==(const Key &other) const {
+			return addrs == other.addrs && ports == other.ports
+					&& proto == other.proto;
+		}
+		static inline Key FromPacket(const Packet &p) {
+			return {(uint64_t(p[FieldSA]) << 32) | p[FieldDA],
+				(uint64_t(p[FieldSP]) << 32) | p[FieldDP], p[FieldProto]};
+		}
+		// @note the rule has to be exact (IsExactRule)
+		static inline Key FromRule(const Rule &r) {
+			return {(uint64_t(r.range[FieldSA].low) << 32) | r.range[FieldDA].low,
+				(uint64_t(r.range[FieldSP].low) << 32) | r.range[FieldDP].low,
+				r.range[FieldProto].low};
+		}
+	};
+	struct KeyHash {
+		inline size_t operator()(const Key &k) const {
+			uint64_t h = k.addrs * 0x9E3779B97F4A7C15ull;
+			h ^= (k.ports + k.proto) * 0xC2B2AE3D27D4EB4Full;
+			h ^= h >> 32;
+			h *= 0xD6E8FEB86659FD93ull;
+			h ^= h >> 29;
+			return h;
+		}
+	};
+	static constexpr int NOT_FOUND = -1;
+
+	// 5-tuple rule with a single value in each field
+	static bool IsExactRule(const Rule &r);
+
+	ExactMatchTable();
+
+	/**
+	 * @return the value for the key or NOT_FOUND
+	 */
+	inline int Find(const Key &key) const {
+		size_t h = KeyHash()(key);
+		int8_t tag = h & 0x7f;
+		size_t mask = groups.size() - 1;
+		size_t g = (h >> 7) & mask;
+		for (size_t i = 1;; i++) {
+			const Group &grp = groups[g];
+			MEMORY_ACCESS_TRACE(grp.ctrl, sizeof(grp.ctrl));
+			for (uint32_t m = grp.Match(tag); m; m &= m - 1) {
+				const Slot &s = grp.slots[__builtin_ctz(m)];
+				MEMORY_ACCESS_TRACE(&s, sizeof(Slot));
+				if (s.key == key)
+					return s.value;
+			}
+			if (grp.MatchEmpty())
+				return NOT_FOUND;
+			g = (g + i) & mask;
+		}
+	}
+	// @return pointer to the value or nullptr if the key is not in the table
+	int* Get(const Key &key);
+	/**
+	 * Insert the new key (the key must not be in the table)
+	 */
+	void Insert(const Key &key, int value);
+	// @return true if the key was removed
+	bool Erase(const Key &key);
+
+	// prepare the table for n keys
+	void Reserve(size_t n);
+	void Clear();
+
+	size_t Size() const {
+		return size;
+	}
+	size_t Capacity() const {
+		return groups.size() * GROUP_SIZE;
+	}
+	size_t MemSizeBytes() const {
+		return groups.size() * sizeof(Group);
+	}
+
+private:
+	static constexpr size_t GROUP_SIZE = 16;
+	static constexpr int8_t EMPTY = -128;
+	static constexpr int8_t DELETED = -2;
+
+	struct Slot {
+		Key key;
+		int value;
+	};
+	struct alignas(16) Group {
+		int8_t ctrl[GROUP_SIZE];
+		Slot slots[GROUP_SIZE];
+
+		// bit mask of the slots with the control byte equal to c
+		inline uint32_t Match(int8_t c) const {
+#ifdef __SSE2__
+			__m128i ctl = _mm_load_si128(reinterpret_cast<const __m128i*>(ctrl));
+			return _mm_movemask_epi8(_mm_cmpeq_epi8(ctl, _mm_set1_epi8(c)));
+#else
+			uint32_t res = 0;
+			for (size_t i = 0; i < GROUP_SIZE; i++)
+				res |= uint32_t(ctrl[i] == c) << i;
+			return res;
+#endif
+		}
+		inline uint32_t MatchEmpty() const {
+			return Match(EMPTY);
+		}
+		// EMPTY or DELETED (the only negative values)
+		inline uint32_t MatchFree() const {
+#ifdef __SSE2__
+			__m128i ctl = _mm_load_si128(reinterpret_cast<const __m128i*>(ctrl));
+			return _mm_movemask_epi8(ctl);
+#else
+			uint32_t res = 0;
+			for (size_t i = 0; i < GROUP_SIZE; i++)
+				res |= uint32_t(ctrl[i] < 0) << i;
+			return res;
+#endif
+		}
+	};
+
+	// allocate empty table with the specified number of groups (power of 2)
+	void Rehash(size_t group_cnt);
+
+	std::vector<Group> groups;
+	size_t size;
+	// slots which are not EMPTY (used + DELETED)
+	size_t occupied;
+};
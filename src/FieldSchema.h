@@ -0,0 +1,90 @@
+#pragma once
+
+#include "DimensionSchema.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+/**
+ * Compile-time version of DimensionSchema for the hot lookup routines
+ *
+ * FieldSchema<32, 32, 16, 16, 8> has the widths of the fields as template
+ * arguments, so the number of lanes is a constant and the rule match is
+ * unrolled in to a fixed sequence of compares (one per lane). DynamicFieldSchema
+ * is the fallback which loops over the dim of the rule.
+ *
+ * The classifiers specialized for a schema (List and the Fixed variants of TSS
+ * and PTSS) expect all rules with the lanes of the schema (Check).
+ */
+struct DynamicFieldSchema {
+	static bool SameLayout(const DimensionSchema&) {
+		return true;
+	}
+	static void Check(const Rule&) {
+	}
+	static inline bool Matches(const Rule &r, const Packet &p) {
+		return r.MatchesPacket(p);
+	}
+	// dim ranges of a rule
+	static inline bool Matches(const Range1d *r, const Packet &p, int dim) {
+		for (int i = 0; i < dim; i++) {
+			if (p[i] < r[i].low || p[i] > r[i].high)
+				return false;
+		}
+		return true;
+	}
+};
+
+template<int ... Widths>
+struct FieldSchema {
+	static constexpr int FIELDS = sizeof...(Widths);
+	static constexpr int LANES = (((Widths + DimensionSchema::LANE_WIDTH - 1)
+			/ DimensionSchema::LANE_WIDTH) + ...);
+
+	// the fields of the schema have the same widths
+	static bool SameLayout(const DimensionSchema &schema) {
+		const int widths[] = { Widths... };
+		if (schema.NumFields() != size_t(FIELDS))
+			return false;
+		for (int f = 0; f < FIELDS; f++) {
+			if (schema.GetField(f).width != widths[f])
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @throws std::runtime_error if the rule does not have the lanes of the schema
+	 */
+	static void Check(const Rule &r) {
+		if (r.dim != LANES)
+			throw std::runtime_error(
+					"the classifier is specialized for rules with "
+							+ std::to_string(LANES) + " dimensions (rule has "
+							+ std::to_string(r.dim) + ")");
+	}
+
+	static inline bool Matches(const Rule &r, const Packet &p) {
+		MEMORY_ACCESS_TRACE(&r, sizeof(Rule));
+		MEMORY_ACCESS_TRACE(r.range.data(), LANES * sizeof(Range1d));
+		return MatchLanes(r.range.data(), p.data(),
+				std::make_index_sequence<LANES>());
+	}
+	// LANES ranges of a rule (dim is ignored)
+	static inline bool Matches(const Range1d *r, const Packet &p, int) {
+		return MatchLanes(r, p.data(), std::make_index_sequence<LANES>());
+	}
+
+private:
+	// low <= p <= high as a single unsigned compare for each lane
+	template<size_t ... I>
+	static inline bool MatchLanes(const Range1d *r, const Point1d *p,
+			std::index_sequence<I...>) {
+		return ((Point1d(p[I] - r[I].low) <= Point1d(r[I].high - r[I].low))
+				&& ...);
+	}
+};
+
+typedef FieldSchema<32, 32, 16, 16, 8> IPv4FieldSchema;
+typedef FieldSchema<128, 128, 16, 16, 8> IPv6FieldSchema;
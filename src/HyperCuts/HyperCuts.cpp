@@ -167,22 +167,23 @@ void HyperCutsHelper::CalcDimensionsToCut(HyperCutsNode* node, vector<bool>& sel
 
 	double average = 0;
 	int dimsCount = 0;
+	int maxUnique = 0;
 	for (size_t d = 0; d < node->bounds.size(); d++) {
-		if (node->bounds[d].high > node->bounds[d].low) {
+		if (IsCuttable(node, d)) {
 			average += uniqueElements[d];
 			dimsCount++;
+			maxUnique = max(maxUnique, uniqueElements[d]);
 		}
 	}
 	average /= dimsCount;
 
-	int maxUnique = *max_element(uniqueElements.begin(), uniqueElements.end());
 	for (size_t d = 0; d < node->bounds.size(); d++) {
 		selectDims.push_back(false);
 	}
 
 	int dimCount = 0;
 	for (size_t d = 0; d < node->bounds.size(); d++) {
-		if (node->bounds[d].high > node->bounds[d].low) {
+		if (IsCuttable(node, d)) {
 			if (isHyperCuts) {
 				if (uniqueElements[d] >= average) {
 					selectDims[d] = true;
@@ -217,7 +218,7 @@ list<HyperCutsNode*> HyperCutsHelper::CalcNumCuts1D(HyperCutsNode* root, size_t
 		HyperCutsNode* node = childList.front();
 
 		if (prevDepth != node->depth) {
-			if (sm < spmf) {
+			if (sm < spmf && CanHalve(root->bounds[dim], uint64_t(1) << nump, dim)) {
 				nump++;
 				sm = 1 << nump;
 				prevDepth = node->depth;
@@ -300,10 +301,13 @@ list<HyperCutsNode*> HyperCutsHelper::CalcNumCuts2D(HyperCutsNode* root, size_t*
 		if (prevDepth != node->depth) {
 			if (sm < spmf) {
 				chosen = chosen ^ 1;
-				//if (pow(2, nump[chosen]) >= spans[chosen]) {
-				//	// Can't split this dimension anymore
-				//	chosen = chosen ^ 1;
-				//}
+				if (!CanHalve(root->bounds[dims[chosen]], uint64_t(1) << nump[chosen], dims[chosen])) {
+					// Can't split this dimension anymore
+					chosen = chosen ^ 1;
+				}
+				if (!CanHalve(root->bounds[dims[chosen]], uint64_t(1) << nump[chosen], dims[chosen])) {
+					break;
+				}
 				nump[chosen]++;
 				sm = 1 << (nump[0] + nump[1]);
 				prevDepth = node->depth;
@@ -413,6 +417,32 @@ list<HyperCutsNode*> HyperCutsHelper::CalcCuts(HyperCutsNode* node) {
 	return children;
 }
 
+bool HyperCutsHelper::CanHalve(const Range1d& bounds, uint64_t cuts, size_t dim) const {
+	uint64_t width = uint64_t(bounds.high) - bounds.low + 1;
+	uint64_t minChildWidth = minWidth.empty() ? 1 : minWidth[dim];
+	return minChildWidth != 0 && width / (2 * cuts) >= minChildWidth;
+}
+
+bool HyperCutsHelper::IsCuttable(const HyperCutsNode* node, size_t dim) const {
+	return CanHalve(node->bounds[dim], 1, dim);
+}
+
+bool HyperCutsHelper::HasCuttableDimension(const HyperCutsNode* node) const {
+	for (size_t d = 0; d < node->bounds.size(); d++) {
+		if (IsCuttable(node, d)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void HyperCutsHelper::DeleteTree(HyperCutsNode* node) {
+	for (HyperCutsNode* n : node->children) {
+		DeleteTree(n);
+	}
+	delete node;
+}
+
 HyperCutsNode* HyperCutsHelper::CreateTree(const list<Rule*>& classifier) {
 	list<HyperCutsNode*> worklist;
 
@@ -432,7 +462,7 @@ HyperCutsNode* HyperCutsHelper::CreateTree(const list<Rule*>& classifier) {
 
 	RemoveRedund(root);
 
-	if (root->classifier.size() > leafSize) {
+	if (root->classifier.size() > leafSize && HasCuttableDimension(root)) {
 		worklist.push_back(root);
 	}
 
@@ -479,7 +509,7 @@ HyperCutsNode* HyperCutsHelper::CreateTree(const list<Rule*>& classifier) {
 		}
 
 		for (HyperCutsNode* n : toPush) {
-			if (n->classifier.size() > leafSize) {
+			if (n->classifier.size() > leafSize && HasCuttableDimension(n)) {
 				bool areIdentical = true;
 				for (size_t d = 0; d < n->bounds.size(); d++) {
 					if (n->bounds[d] != n->bounds[d]) {
@@ -522,6 +552,7 @@ void HyperCuts::_ConstructClassifier(const vector<Rule>& rules) {
 }
 
 int Classify(const HyperCutsNode* node, const Packet& packet) {
+	MEMORY_ACCESS_TRACE(node, sizeof(HyperCutsNode));
 	int priority = -1;
 
 	//for (Range r : node->bounds) {
@@ -529,7 +560,9 @@ int Classify(const HyperCutsNode* node, const Packet& packet) {
 	//}
 	//printf("\n");
 
-	for (const Rule* r : node->classifier) {
+	for (const Rule* const & r : node->classifier) {
+		// list node with the pointer to the rule
+		MEMORY_ACCESS_TRACE(&r, sizeof(r));
 		//printf("%d -> ", r->priority);
 		//r->Print();
 		if (r->MatchesPacket(packet)) {
@@ -541,6 +574,8 @@ int Classify(const HyperCutsNode* node, const Packet& packet) {
 
 	if (!node->childArray.empty()) {
 		//printf("Array\n");
+		MEMORY_ACCESS_TRACE(node->bounds.data(), node->bounds.size() * sizeof(Range1d));
+		MEMORY_ACCESS_TRACE(node->cuts.data(), node->cuts.size() * sizeof(int));
 		int index = 0;
 		for (size_t d = 0; d < node->bounds.size(); d++) {
 			if (node->cuts[d] > 1) {
@@ -573,6 +608,7 @@ int Classify(const HyperCutsNode* node, const Packet& packet) {
 		//}
 
 		//printf("Index: %d / %u\n", index, node->childArray.size());
+		MEMORY_ACCESS_TRACE(&node->childArray[index], sizeof(HyperCutsNode*));
 		priority = max(priority, Classify(node->childArray[index], packet));
 	}
 
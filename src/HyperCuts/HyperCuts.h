@@ -18,9 +18,31 @@ public:
 
 class HyperCutsHelper {
 public:
+	/**
+	 * @param leafSize max rules in leaf (binth)
+	 * @param spfac space factor (limits the number of cuts of node)
+	 * @param isHyperCuts cut up to 2 dimensions in node, otherwise 1 (HiCuts)
+	 */
+	HyperCutsHelper(size_t leafSize = 8, double spfac = 4, bool isHyperCuts = true) :
+			leafSize(leafSize), spfac(spfac), isHyperCuts(isHyperCuts) {
+	}
 	HyperCutsNode* CreateTree(const std::list<Rule*>& classifier);
 
+	/**
+	 * Cut the dimension only while the node is wider than minWidth[d]
+	 * (0 = do not cut), the node which can not be cut is a leaf even if it has
+	 * more than leafSize rules
+	 */
+	void SetMinCutWidth(const std::vector<uint64_t>& minWidth) {
+		this->minWidth = minWidth;
+	}
+	static void DeleteTree(HyperCutsNode* node);
+
 private:
+	bool IsCuttable(const HyperCutsNode* node, size_t dim) const;
+	bool CanHalve(const Range1d& bounds, uint64_t cuts, size_t dim) const;
+	bool HasCuttableDimension(const HyperCutsNode* node) const;
+
 	std::list<HyperCutsNode*> CalcCuts(HyperCutsNode* node);
 	std::list<HyperCutsNode*> CalcNumCuts1D(HyperCutsNode* root, size_t dim);
 	std::list<HyperCutsNode*> CalcNumCuts2D(HyperCutsNode* root, size_t* dims);
@@ -34,22 +56,26 @@ private:
 	bool compressionOn = false;
 	bool binningOn = false;
 	bool mergingOn = false;
+
+	// empty = the dimensions can be cut down to a single value
+	std::vector<uint64_t> minWidth;
 };
 
 class HyperCuts : public PacketClassifier {
 public:
 	virtual void _ConstructClassifier(const std::vector<Rule>& rules);
 	virtual int ClassifyAPacket(const Packet& packet);
-	virtual void DeleteRule(size_t index) { 
+	virtual void _DeleteRule(size_t index) { 
 		fprintf(stderr, "Can't delete rules.\n");
 		exit(EXIT_FAILURE);
 	}
-	virtual void InsertRule(const Rule& rule) { 
+	virtual void _InsertRule(const Rule& rule) { 
 		fprintf(stderr, "Can't insert rules.\n");
 		exit(EXIT_FAILURE);
 	}
 	virtual Memory MemSizeBytes() const;
 	virtual int MemoryAccess() const { return 0; } // TODO
+	virtual bool SupportsMemoryAccessTrace() const { return true; }
 	virtual size_t NumTables() const;
 	virtual size_t RulesInTable(size_t tableIndex) const { return rules.size(); }
 
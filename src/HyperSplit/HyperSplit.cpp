@@ -6,11 +6,14 @@
 
 #include "HyperSplit.h"
 #include "HyperSplit_nodes.h"
+#include "../DimensionSchema.h"
 
 using namespace std;
 
 void HyperSplit::_ConstructClassifier(const vector<Rule>& rules) {
 	this->rules = rules;
+	if (rules.size() && bounds.size() != size_t(rules[0].dim))
+		bounds = DimensionSchema::ForDim(rules[0].dim).Bounds();
 	root = SplitRules(bounds, this->rules, leafSize);
 }
 
@@ -18,7 +21,7 @@ int HyperSplit::ClassifyAPacket(const Packet& p) {
 	return root->ClassifyAPacket(p);
 }
 
-void HyperSplit::DeleteRule(size_t index) {
+void HyperSplit::_DeleteRule(size_t index) {
 	//CheckBounds(bounds);
 
 	swap(rules[index], rules[rules.size() - 1]);
@@ -30,7 +33,7 @@ void HyperSplit::DeleteRule(size_t index) {
 	rules.pop_back();
 }
 
-void HyperSplit::InsertRule(const Rule& r) {
+void HyperSplit::_InsertRule(const Rule& r) {
 	//CheckBounds(bounds);
 
 	rules.push_back(r);
@@ -41,6 +44,28 @@ void HyperSplit::InsertRule(const Rule& r) {
 	}
 }
 
+void HyperSplit::_ApplyUpdates(const vector<size_t>& deleted,
+		const vector<const Rule*>& inserted) {
+	// the deleted rules are swapped behind the remaining ones
+	size_t remaining = rules.size();
+	for (size_t index : deleted) {
+		swap(rules[index], rules[--remaining]);
+	}
+	vector<const Rule*> deletedRules;
+	for (size_t i = remaining; i < rules.size(); i++) {
+		deletedRules.push_back(&rules[i]);
+	}
+	iNode* n = root->ApplyUpdates(leafSize, deletedRules, inserted);
+	if (n != root) {
+		delete root;
+		root = n;
+	}
+	rules.resize(remaining);
+	for (const Rule* r : inserted) {
+		rules.push_back(*r);
+	}
+}
+
 Memory HyperSplit::MemSizeBytes() const {
 	int size = 0;
 	for (const auto & field : bounds) {
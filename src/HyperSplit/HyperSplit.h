@@ -10,6 +10,7 @@ public:
 			bounds(bounds), root(nullptr), leafSize(leafSize) {
 	}
 
+	// bounds of IPv4 5-tuple, other rules use the bounds of their DimensionSchema
 	HyperSplit(int leafSize = 8) :
 			root(nullptr), leafSize(leafSize) {
 		bounds.push_back( { 0, 0xFFFFFFFFu });
@@ -27,13 +28,22 @@ public:
 
 	void _ConstructClassifier(const std::vector<Rule>& rules);
 	int ClassifyAPacket(const Packet& p);
-	void DeleteRule(size_t index);
-	void InsertRule(const Rule& r);
+	void _DeleteRule(size_t index);
+	void _InsertRule(const Rule& r);
+	// one pass over the tree for all updates (a leaf is split at most once)
+	void _ApplyUpdates(const std::vector<size_t>& deleted,
+			const std::vector<const Rule*>& inserted);
 	Memory MemSizeBytes() const;
 	int MemoryAccess() const {
 		printf("warning unimplemented MemoryAccess()\n");
 		return 0;
 	}
+	bool SupportsMemoryAccessTrace() const {
+		return true;
+	}
+	bool SupportsWideFields() const {
+		return true;
+	}
 	size_t NumTables() const {
 		return 1;
 	}
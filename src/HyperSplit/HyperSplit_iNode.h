@@ -9,6 +9,10 @@ public:
 	virtual int ClassifyAPacket(const Packet& one_packet) = 0;
 	virtual iNode* DeleteRule(const Rule& one_rule) = 0;
 	virtual iNode* InsertRule(unsigned int leafSize, const Rule& r) = 0;
+	// the deletes and inserts of a batch in one pass over the tree
+	virtual iNode* ApplyUpdates(unsigned int leafSize,
+			const std::vector<const Rule*>& deleted,
+			const std::vector<const Rule*>& inserted) = 0;
 	virtual int Size(int ruleSize) const = 0;
 	virtual bool IsEmpty() const = 0;
 
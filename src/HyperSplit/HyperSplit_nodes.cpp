@@ -178,6 +178,7 @@ iNode* SplitRules(const vector<Range1d>& bounds, const vector<Rule>& rules, unsi
 // **********
 
 int SplitNode::ClassifyAPacket(const Packet& p) {
+	MEMORY_ACCESS_TRACE(this, sizeof(SplitNode));
 	unsigned int pt = p[splitDim];
 	if (pt <= splitPoint) {
 		return leftChild->ClassifyAPacket(p);
@@ -206,7 +207,10 @@ iNode* SplitNode::DeleteRule(const Rule& r) {
 			rightChild = rc;
 		}
 	}
+	return Collapse();
+}
 
+iNode* SplitNode::Collapse() {
 	if (leftChild->IsEmpty()) {
 		iNode* res = rightChild;
 		rightChild = nullptr;
@@ -245,6 +249,37 @@ iNode* SplitNode::InsertRule(unsigned int leafSize, const Rule& one_rule) {
 	return this;
 }
 
+iNode* SplitNode::ApplyUpdates(unsigned int leafSize,
+		const vector<const Rule*>& deleted, const vector<const Rule*>& inserted) {
+	// the rules of each child, a rule may be in both
+	vector<const Rule*> lists[2][2];
+	const vector<const Rule*>* updates[2] = { &deleted, &inserted };
+	for (int u = 0; u < 2; u++) {
+		for (const Rule* r : *updates[u]) {
+			if (r->range[splitDim].low <= splitPoint)
+				lists[0][u].push_back(r);
+			if (r->range[splitDim].high > splitPoint)
+				lists[1][u].push_back(r);
+		}
+	}
+
+	if (!lists[0][0].empty() || !lists[0][1].empty()) {
+		iNode* lc = leftChild->ApplyUpdates(leafSize, lists[0][0], lists[0][1]);
+		if (lc != leftChild) {
+			delete leftChild;
+			leftChild = lc;
+		}
+	}
+	if (!lists[1][0].empty() || !lists[1][1].empty()) {
+		iNode* rc = rightChild->ApplyUpdates(leafSize, lists[1][0], lists[1][1]);
+		if (rc != rightChild) {
+			delete rightChild;
+			rightChild = rc;
+		}
+	}
+	return Collapse();
+}
+
 int SplitNode::Size(int ruleSize) const {
 	return NodeSize + leftChild->Size(ruleSize) + rightChild->Size(ruleSize);
 }
@@ -259,9 +294,12 @@ void SplitNode::SetBounds(const vector<Range1d>& bounds) {
 // ********
 
 int ListNode::ClassifyAPacket(const Packet& p) {
+	MEMORY_ACCESS_TRACE(this, sizeof(ListNode));
 	int bestPriority = -1;
 	for (size_t i = 0; i < rules.size(); i++) {
+		MEMORY_ACCESS_TRACE(&rules[i], sizeof(Rule));
 		if (rules[i].priority > bestPriority) {
+			MEMORY_ACCESS_TRACE(rules[i].range.data(), rules[i].dim * sizeof(Range1d));
 			bool matches = true;
 			for (int d = 0; d < rules[i].dim; d++) {
 				if (!(rules[i].range[d].low <= p[d] && rules[i].range[d].high >= p[d])) {
@@ -279,7 +317,12 @@ int ListNode::ClassifyAPacket(const Packet& p) {
 
 iNode* ListNode::DeleteRule(const Rule& r) {
 	//CheckBounds(bounds);
-	rules.erase(remove_if(rules.begin(), rules.end(), [=](const Rule& r2) -> bool {return r.priority == r2.priority; }), rules.end());
+	// one copy of the rule (the rules may share a priority)
+	auto it = find_if(rules.begin(), rules.end(), [&r](const Rule& r2) -> bool {
+		return r.priority == r2.priority && r.range == r2.range;
+	});
+	if (it != rules.end())
+		rules.erase(it);
 	return this;
 }
 
@@ -294,6 +337,22 @@ iNode* ListNode::InsertRule(unsigned int leafSize, const Rule& r) {
 	}
 }
 
+iNode* ListNode::ApplyUpdates(unsigned int leafSize,
+		const vector<const Rule*>& deleted, const vector<const Rule*>& inserted) {
+	for (const Rule* r : deleted) {
+		DeleteRule(*r);
+	}
+	for (const Rule* r : inserted) {
+		rules.push_back(*r);
+	}
+	// a single split of the leaf for all inserted rules
+	if (rules.size() <= leafSize) {
+		return this;
+	} else {
+		return SplitRules(bounds, rules, leafSize);
+	}
+}
+
 int ListNode::Size(int ruleSize) const {
 	return NodeSize + ruleSize * rules.size();
 }
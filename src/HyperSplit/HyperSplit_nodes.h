@@ -77,6 +77,9 @@ public:
 	int ClassifyAPacket(const Packet& p);
 	iNode* DeleteRule(const Rule& r);
 	iNode* InsertRule(unsigned int leafSize, const Rule& r);
+	iNode* ApplyUpdates(unsigned int leafSize,
+			const std::vector<const Rule*>& deleted,
+			const std::vector<const Rule*>& inserted);
 	int Size(int ruleSize) const;
 	bool IsEmpty() const {
 		return false;
@@ -84,6 +87,8 @@ public:
 
 	void SetBounds(const std::vector<Range1d>& bounds);
 private:
+	// the child which is left if the other one is empty (this otherwise)
+	iNode* Collapse();
 
 	const unsigned int splitPoint;
 	const int splitDim;
@@ -102,6 +107,9 @@ public:
 	int ClassifyAPacket(const Packet& p);
 	iNode* DeleteRule(const Rule& r);
 	iNode* InsertRule(unsigned int leafSize, const Rule& r);
+	iNode* ApplyUpdates(unsigned int leafSize,
+			const std::vector<const Rule*>& deleted,
+			const std::vector<const Rule*>& inserted);
 	int Size(int ruleSize) const;
 	bool IsEmpty() const {
 		return rules.empty();
@@ -0,0 +1,156 @@
+#include "BinaryFormat.h"
+#include "MappedFile.h"
+
+#include <fstream>
+#include <ios>
+
+using namespace std;
+
+namespace BinaryFormat {
+
+bool IsBinaryFile(const string &filename) {
+	ifstream in(filename, ios::binary);
+	char magic[sizeof(MAGIC)];
+	if (!in.read(magic, sizeof(magic)))
+		return false;
+	return HasMagic(magic, sizeof(magic));
+}
+
+/*
+ * Check the header and return pointer to the first record
+ */
+static const char* CheckHeader(const MappedFile &f, const string &filename,
+		FileKind kind, uint32_t (*record_size)(uint32_t)) {
+	if (f.size() < sizeof(BinaryFileHeader) || !HasMagic(f.data(), f.size())) {
+		throw ios_base::failure(
+				string("\"") + filename + "\" is not a binary rule/packet file");
+	}
+	const BinaryFileHeader &h =
+			*reinterpret_cast<const BinaryFileHeader*>(f.data());
+	if (h.version != VERSION) {
+		throw ios_base::failure(
+				string("\"") + filename + "\" has unsupported version "
+						+ to_string(h.version));
+	}
+	if (h.kind != kind) {
+		throw ios_base::failure(
+				string("\"") + filename + "\" contains "
+						+ (h.kind == FileKind::Rules ? "rules" : "packets"));
+	}
+	if (h.record_size != record_size(h.dim)
+			|| f.size()
+					< sizeof(BinaryFileHeader) + h.record_cnt * h.record_size) {
+		throw ios_base::failure(
+				string("\"") + filename + "\" is corrupted");
+	}
+	return f.data() + sizeof(BinaryFileHeader);
+}
+
+vector<Rule> ReadRules(const string &filename) {
+	MappedFile f(filename);
+	const char *rec = CheckHeader(f, filename, FileKind::Rules, RuleRecordSize);
+	const BinaryFileHeader &h =
+			*reinterpret_cast<const BinaryFileHeader*>(f.data());
+
+	vector<Rule> rules;
+	rules.reserve(h.record_cnt);
+	for (uint64_t i = 0; i < h.record_cnt; i++, rec += h.record_size) {
+		auto r = reinterpret_cast<const BinaryRuleRecord*>(rec);
+		auto fields = reinterpret_cast<const BinaryRuleField*>(r + 1);
+		rules.emplace_back(h.dim);
+		Rule &dst = rules.back();
+		dst.priority = r->priority;
+		dst.id = r->id;
+		dst.tag = r->tag;
+		for (uint32_t d = 0; d < h.dim; d++) {
+			dst.range[d].low = fields[d].low;
+			dst.range[d].high = fields[d].high;
+			dst.prefix_length[d] = fields[d].prefix_length;
+		}
+	}
+	return rules;
+}
+
+const BinaryFileHeader& CheckPacketFile(const MappedFile &f,
+		const string &filename) {
+	CheckHeader(f, filename, FileKind::Packets, PacketRecordSize);
+	return *reinterpret_cast<const BinaryFileHeader*>(f.data());
+}
+
+vector<Packet> ReadPackets(const string &filename) {
+	MappedFile f(filename);
+	const BinaryFileHeader &h = CheckPacketFile(f, filename);
+	const char *rec = f.data() + sizeof(BinaryFileHeader);
+
+	vector<Packet> packets;
+	packets.reserve(h.record_cnt);
+	for (uint64_t i = 0; i < h.record_cnt; i++, rec += h.record_size) {
+		auto p = reinterpret_cast<const Point1d*>(rec);
+		packets.emplace_back(p, p + h.dim);
+	}
+	return packets;
+}
+
+static BinaryFileHeader MakeHeader(FileKind kind, uint32_t dim,
+		uint32_t record_size, uint64_t record_cnt) {
+	BinaryFileHeader h;
+	memcpy(h.magic, MAGIC, sizeof(MAGIC));
+	h.version = VERSION;
+	h.kind = kind;
+	h.dim = dim;
+	h.record_size = record_size;
+	h.record_cnt = record_cnt;
+	return h;
+}
+
+bool WriteRules(const string &filename, const vector<Rule> &rules) {
+	ofstream out(filename, ios::binary);
+	if (!out.good()) {
+		printf("Failed to open %s\n", filename.c_str());
+		return false;
+	}
+	uint32_t dim = rules.empty() ? 0 : rules[0].dim;
+	auto h = MakeHeader(FileKind::Rules, dim, RuleRecordSize(dim),
+			rules.size());
+	out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+	vector<BinaryRuleField> fields(dim);
+	for (const Rule &r : rules) {
+		if ((uint32_t) r.dim != dim) {
+			printf("All rules are required to have the same dimension\n");
+			return false;
+		}
+		BinaryRuleRecord rec = { r.priority, r.id, r.tag, 0 };
+		for (uint32_t d = 0; d < dim; d++) {
+			fields[d] = { r.range[d].low, r.range[d].high, r.prefix_length[d] };
+		}
+		out.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+		out.write(reinterpret_cast<const char*>(fields.data()),
+				dim * sizeof(BinaryRuleField));
+	}
+	out.close();
+	return out.good();
+}
+
+bool WritePackets(const string &filename, const vector<Packet> &packets) {
+	ofstream out(filename, ios::binary);
+	if (!out.good()) {
+		printf("Failed to open %s\n", filename.c_str());
+		return false;
+	}
+	uint32_t dim = packets.empty() ? 0 : packets[0].size();
+	auto h = MakeHeader(FileKind::Packets, dim, PacketRecordSize(dim),
+			packets.size());
+	out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+	for (const Packet &p : packets) {
+		if (p.size() != dim) {
+			printf("All packets are required to have the same dimension\n");
+			return false;
+		}
+		out.write(reinterpret_cast<const char*>(p.data()),
+				dim * sizeof(Point1d));
+	}
+	out.close();
+	return out.good();
+}
+
+}
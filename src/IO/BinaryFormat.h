@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../ElementaryClasses.h"
+
+class MappedFile;
+
+/**
+ * Binary format of the rulesets and packet traces
+ *
+ * The file is composed of BinaryFileHeader followed by header.record_cnt
+ * records of header.record_size bytes. All values are stored in the native
+ * byte order (the magic also works as byte order check).
+ *
+ * Rule record: BinaryRuleRecord followed by dim * BinaryRuleField
+ * Packet record: dim * uint32_t
+ *
+ * The records have fixed size, so the file can be used directly from the memory mapping.
+ */
+namespace BinaryFormat {
+
+static constexpr char MAGIC[8] = { 'L', 'E', 'P', 'C', 'B', 'I', 'N', '\0' };
+static constexpr uint32_t VERSION = 1;
+
+enum class FileKind : uint32_t {
+	Rules = 1, Packets = 2,
+};
+
+struct BinaryFileHeader {
+	char magic[8];
+	uint32_t version;
+	FileKind kind;
+	uint32_t dim;
+	uint32_t record_size;
+	uint64_t record_cnt;
+};
+static_assert(sizeof(BinaryFileHeader) == 32);
+
+struct BinaryRuleRecord {
+	int32_t priority;
+	int32_t id;
+	int32_t tag;
+	uint32_t reserved;
+};
+
+struct BinaryRuleField {
+	uint32_t low;
+	uint32_t high;
+	uint32_t prefix_length;
+};
+
+inline uint32_t RuleRecordSize(uint32_t dim) {
+	return sizeof(BinaryRuleRecord) + dim * sizeof(BinaryRuleField);
+}
+
+inline uint32_t PacketRecordSize(uint32_t dim) {
+	return dim * sizeof(uint32_t);
+}
+
+/**
+ * Check if the data starts with the magic of the binary format
+ */
+inline bool HasMagic(const char *data, size_t size) {
+	return size >= sizeof(MAGIC) && memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool IsBinaryFile(const std::string &filename);
+
+/**
+ * @throws std::ios_base::failure if the file is not in the binary format
+ * 	       of the specified kind or it is corrupted
+ */
+std::vector<Rule> ReadRules(const std::string &filename);
+std::vector<Packet> ReadPackets(const std::string &filename);
+
+/**
+ * Check the header of the mapped packet file, the records follow directly after the header
+ *
+ * @throws std::ios_base::failure same as ReadPackets
+ */
+const BinaryFileHeader& CheckPacketFile(const MappedFile &f,
+		const std::string &filename);
+
+bool WriteRules(const std::string &filename, const std::vector<Rule> &rules);
+bool WritePackets(const std::string &filename,
+		const std::vector<Packet> &packets);
+
+}
@@ -0,0 +1,286 @@
+#include "ClassBenchParser.h"
+#include "MappedFile.h"
+#include "../Utilities/thread_pool.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using namespace std;
+
+namespace {
+
+inline bool IsSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline const char* SkipSpaces(const char *s, const char *end) {
+	while (s != end && IsSpace(*s))
+		s++;
+	return s;
+}
+
+[[noreturn]] void ParseError(const char *msg) {
+	printf("ERROR: NOT A VALID RULE FORMAT (%s)\n", msg);
+	exit(1);
+}
+
+inline const char* ParseUInt(const char *s, const char *end, uint32_t &val) {
+	if (s == end || *s < '0' || *s > '9')
+		ParseError("expected number");
+	uint32_t v = 0;
+	while (s != end && *s >= '0' && *s <= '9') {
+		v = v * 10 + (*s - '0');
+		s++;
+	}
+	val = v;
+	return s;
+}
+
+inline const char* ParseHex(const char *s, const char *end, uint32_t &val) {
+	if (end - s < 3 || s[0] != '0' || (s[1] != 'x' && s[1] != 'X'))
+		ParseError("expected hexadecimal number");
+	s += 2;
+	uint32_t v = 0;
+	for (; s != end; s++) {
+		char c = *s;
+		if (c >= '0' && c <= '9')
+			v = (v << 4) | (c - '0');
+		else if (c >= 'a' && c <= 'f')
+			v = (v << 4) | (c - 'a' + 10);
+		else if (c >= 'A' && c <= 'F')
+			v = (v << 4) | (c - 'A' + 10);
+		else
+			break;
+	}
+	val = v;
+	return s;
+}
+
+inline const char* Expect(const char *s, const char *end, char c) {
+	if (s == end || *s != c)
+		ParseError("unexpected character");
+	return s + 1;
+}
+
+// a.b.c.d/len
+inline const char* ParseIPRange(const char *s, const char *end,
+		Range1d &range, unsigned &prefix_length) {
+	uint32_t ip = 0;
+	for (int i = 0; i < 4; i++) {
+		uint32_t b;
+		s = ParseUInt(s, end, b);
+		ip = (ip << 8) | (b & 0xFF);
+		if (i != 3)
+			s = Expect(s, end, '.');
+	}
+	s = Expect(s, end, '/');
+	uint32_t len;
+	s = ParseUInt(s, end, len);
+	if (len > 32)
+		ParseError("prefix length > 32");
+	uint32_t mask = len == 0 ? 0 : ~uint32_t(0) << (32 - len);
+	prefix_length = len;
+	range.low = ip & mask;
+	range.high = range.low | ~mask;
+	return s;
+}
+
+inline int HexDigit(char c) {
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+// x:x:x:x:x:x:x:x/len or with "::" for the zero groups, stored in to 4 lanes
+inline const char* ParseIPv6Range(const char *s, const char *end,
+		Range1d *range, unsigned *prefix_length) {
+	uint16_t groups[8] = { };
+	int cnt = 0;
+	// position of "::" in the groups (-1 if not present)
+	int gap = -1;
+	if (end - s >= 2 && s[0] == ':' && s[1] == ':') {
+		gap = 0;
+		s += 2;
+	}
+	while (s != end && *s != '/') {
+		if (cnt == 8)
+			ParseError("too many groups in IPv6 address");
+		uint32_t g = 0;
+		int digits = 0;
+		for (; s != end && HexDigit(*s) >= 0; s++, digits++)
+			g = (g << 4) | HexDigit(*s);
+		if (digits == 0 || digits > 4)
+			ParseError("expected IPv6 address group");
+		groups[cnt++] = g;
+		if (s != end && *s == ':') {
+			s++;
+			if (s != end && *s == ':') {
+				if (gap >= 0)
+					ParseError("multiple \"::\" in IPv6 address");
+				gap = cnt;
+				s++;
+			}
+		}
+	}
+	if (gap >= 0) {
+		int zeros = 8 - cnt;
+		for (int i = cnt - 1; i >= gap; i--)
+			groups[i + zeros] = groups[i];
+		for (int i = gap; i < gap + zeros; i++)
+			groups[i] = 0;
+	} else if (cnt != 8) {
+		ParseError("expected 8 groups in IPv6 address");
+	}
+	s = Expect(s, end, '/');
+	uint32_t len;
+	s = ParseUInt(s, end, len);
+	if (len > 128)
+		ParseError("prefix length > 128");
+	for (int i = 0; i < 4; i++) {
+		uint32_t word = (uint32_t(groups[2 * i]) << 16) | groups[2 * i + 1];
+		int l = min(32, max(0, int(len) - 32 * i));
+		uint32_t mask = l == 0 ? 0 : ~uint32_t(0) << (32 - l);
+		prefix_length[i] = l;
+		range[i].low = word & mask;
+		range[i].high = range[i].low | ~mask;
+	}
+	return s;
+}
+
+// low : high
+inline const char* ParsePort(const char *s, const char *end, Range1d &range) {
+	s = ParseUInt(s, end, range.low);
+	s = SkipSpaces(s, end);
+	s = Expect(s, end, ':');
+	s = SkipSpaces(s, end);
+	return ParseUInt(s, end, range.high);
+}
+
+// 0x06/0xFF
+inline const char* ParseProtocol(const char *s, const char *end,
+		Range1d &range) {
+	uint32_t val, mask;
+	s = ParseHex(s, end, val);
+	s = Expect(s, end, '/');
+	s = ParseHex(s, end, mask);
+	if (mask != 0xFF) {
+		range.low = 0;
+		range.high = 255;
+	} else {
+		range.low = range.high = val;
+	}
+	return s;
+}
+
+}
+
+const char* ClassBenchParser::ParseRule(const char *s, const char *end,
+		const DimensionSchema &schema, Rule &rule) {
+	// 5 fields: sip, dip, sport, dport, proto = 0 (with@), 1, 2 : 4, 5 : 7, 8
+	s = Expect(s, end, '@');
+	for (size_t f = 0; f < schema.NumFields(); f++) {
+		const DimensionSchema::Field &field = schema.GetField(f);
+		int i = field.first_lane;
+		s = SkipSpaces(s, end);
+		switch (f % 5) {
+		case FieldSA:
+		case FieldDA:
+			if (field.width == 128)
+				s = ParseIPv6Range(s, end, &rule.range[i], &rule.prefix_length[i]);
+			else
+				s = ParseIPRange(s, end, rule.range[i], rule.prefix_length[i]);
+			break;
+		case FieldSP:
+		case FieldDP:
+			s = ParsePort(s, end, rule.range[i]);
+			break;
+		default:
+			s = ParseProtocol(s, end, rule.range[i]);
+		}
+	}
+	return s;
+}
+
+size_t ClassBenchParser::ParseChunk(const char *begin, const char *end,
+		const DimensionSchema &schema, vector<Rule> &rules) {
+	size_t line = 0;
+	const char *s = begin;
+	while (s != end) {
+		const char *eol = static_cast<const char*>(memchr(s, '\n', end - s));
+		if (eol == nullptr)
+			eol = end;
+		const char *first = SkipSpaces(s, eol);
+		if (first != eol && *first != '#') {
+			rules.emplace_back(schema.NumLanes());
+			ParseRule(first, eol, schema, rules.back());
+			rules.back().priority = line;
+		}
+		line++;
+		s = eol == end ? end : eol + 1;
+	}
+	return line;
+}
+
+vector<Rule> ClassBenchParser::Parse(const char *begin, const char *end,
+		const DimensionSchema &schema, size_t thread_cnt) {
+	if (thread_cnt == 0)
+		thread_cnt = max(1u, thread::hardware_concurrency());
+	size_t size = end - begin;
+	size_t chunk_cnt = min(thread_cnt, max<size_t>(1, size / MIN_CHUNK_SIZE));
+
+	// split the input to chunks ending with newline
+	vector<pair<const char*, const char*>> chunks;
+	const char *s = begin;
+	for (size_t i = 0; i < chunk_cnt && s != end; i++) {
+		const char *e =
+				i == chunk_cnt - 1 ? end : min(end, s + size / chunk_cnt);
+		if (e != end) {
+			auto eol = static_cast<const char*>(memchr(e, '\n', end - e));
+			e = eol == nullptr ? end : eol + 1;
+		}
+		chunks.push_back( { s, e });
+		s = e;
+	}
+
+	vector<vector<Rule>> chunk_rules(chunks.size());
+	vector<size_t> chunk_lines(chunks.size());
+	{
+		ThreadPool pool(chunks.size());
+		vector<future<void>> tasks;
+		for (size_t i = 0; i < chunks.size(); i++) {
+			tasks.push_back(pool.enqueue([&, i]() {
+				chunk_lines[i] = ParseChunk(chunks[i].first, chunks[i].second,
+						schema, chunk_rules[i]);
+			}));
+		}
+		for (auto &t : tasks)
+			t.get();
+	}
+
+	size_t total = 0;
+	for (auto &r : chunk_rules)
+		total += r.size();
+	vector<Rule> rules;
+	rules.reserve(total);
+	size_t line_offset = 0;
+	for (size_t i = 0; i < chunks.size(); i++) {
+		for (auto &r : chunk_rules[i]) {
+			r.priority += line_offset;
+			rules.push_back(std::move(r));
+		}
+		line_offset += chunk_lines[i];
+	}
+	return rules;
+}
+
+vector<Rule> ClassBenchParser::ParseFile(const string &filename,
+		const DimensionSchema &schema, size_t thread_cnt) {
+	MappedFile f(filename);
+	return Parse(f.data(), f.data() + f.size(), schema, thread_cnt);
+}
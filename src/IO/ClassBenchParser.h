@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "../ElementaryClasses.h"
+#include "../DimensionSchema.h"
+
+/**
+ * Parser of the ClassBench filter format which works directly on the memory
+ * mapped file.
+ *
+ * The input is split to newline-aligned chunks which are parsed in parallel,
+ * the numbers and addresses are parsed directly from the input (no temporary strings).
+ * The rules are in the original order and the priority of each rule is the index of its line.
+ *
+ * The addresses of the fields with width 128 (DimensionSchema::IPv6) are
+ * IPv6 prefixes (2001:db8::/32), each 32b lane of the address is one dimension
+ * of the rule.
+ */
+class ClassBenchParser {
+public:
+	/**
+	 * @param schema the fields of the rule, 5-tuples (IPv4 or IPv6) on each line
+	 * @param thread_cnt number of threads, 0 = number of CPUs
+	 */
+	static std::vector<Rule> ParseFile(const std::string &filename,
+			const DimensionSchema &schema, size_t thread_cnt = 0);
+	static std::vector<Rule> Parse(const char *begin, const char *end,
+			const DimensionSchema &schema, size_t thread_cnt = 0);
+
+private:
+	// do not split the input to smaller chunks than this
+	static constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+
+	/*
+	 * Parse the rules from the chunk, priority of the rule is set to index of the line in the chunk
+	 *
+	 * @return number of lines in chunk
+	 */
+	static size_t ParseChunk(const char *begin, const char *end,
+			const DimensionSchema &schema, std::vector<Rule> &rules);
+	static const char* ParseRule(const char *s, const char *end,
+			const DimensionSchema &schema, Rule &rule);
+};
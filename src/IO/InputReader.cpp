@@ -3,6 +3,7 @@
 #include <vector>
 #include <algorithm>
 #include <set>
+#include <unordered_set>
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -12,6 +13,8 @@
 #include <regex>
 #include <set>
 #include "ElementaryClasses.h"
+#include "BinaryFormat.h"
+#include "ClassBenchParser.h"
 
 using namespace std;
 
@@ -43,6 +46,10 @@ std::vector<std::string> InputReader::split(const std::string &s, char delim) {
 
 vector<vector<unsigned int>> InputReader::ReadPackets(const string &filename) {
 	vector<vector<unsigned int>> packets;
+	if (BinaryFormat::IsBinaryFile(filename)) {
+		std::cout << "Reading binary packet file " << filename << std::endl;
+		return BinaryFormat::ReadPackets(filename);
+	}
 	ifstream input_file(filename);
 	if (!input_file.is_open()) {
 		std::cout << "Couldn't open packet set file" << std::endl;
@@ -67,169 +74,10 @@ vector<vector<unsigned int>> InputReader::ReadPackets(const string &filename) {
 	return packets;
 }
 
-void InputReader::ReadIPRange(Range1d &IPrange, unsigned int &prefix_length,
-		const string &token) {
-	//split slash
-	vector<string> split_slash = split(token, '/');
-	vector<string> split_ip = split(split_slash[0], '.');
-	// asindmemacces IPv4 prefixes
-	// temporary variables to store IP range
-	unsigned int mask;
-	int masklit1;
-	unsigned int masklit2, masklit3;
-	unsigned int ptrange[4];
-	for (int i = 0; i < 4; i++)
-		ptrange[i] = atoui(split_ip[i]);
-	mask = atoui(split_slash[1]);
-
-	prefix_length = mask;
-
-	mask = 32 - mask;
-	masklit1 = mask / 8;
-	masklit2 = mask % 8;
-
-	/*count the start IP */
-	for (int i = 3; i > 3 - masklit1; i--)
-		ptrange[i] = 0;
-	if (masklit2 != 0) {
-		masklit3 = 1;
-		masklit3 <<= masklit2;
-		masklit3 -= 1;
-		masklit3 = ~masklit3;
-		ptrange[3 - masklit1] &= masklit3;
-	}
-	/*store start IP */
-	IPrange.low = ptrange[0];
-	IPrange.low <<= 8;
-	IPrange.low += ptrange[1];
-	IPrange.low <<= 8;
-	IPrange.low += ptrange[2];
-	IPrange.low <<= 8;
-	IPrange.low += ptrange[3];
-
-	//key += std::bitset<32>(IPrange[0] >> prefix_length).to_string().substr(32 - prefix_length);
-	/*count the end IP*/
-	for (int i = 3; i > 3 - masklit1; i--)
-		ptrange[i] = 255;
-	if (masklit2 != 0) {
-		masklit3 = 1;
-		masklit3 <<= masklit2;
-		masklit3 -= 1;
-		ptrange[3 - masklit1] |= masklit3;
-	}
-	/*store end IP*/
-	IPrange.high = ptrange[0];
-	IPrange.high <<= 8;
-	IPrange.high += ptrange[1];
-	IPrange.high <<= 8;
-	IPrange.high += ptrange[2];
-	IPrange.high <<= 8;
-	IPrange.high += ptrange[3];
-}
-void InputReader::ReadPort(Range1d &Portrange, const string &from,
-		const string &to) {
-	Portrange.low = atoui(from);
-	Portrange.high = atoui(to);
-}
-
-void InputReader::ReadProtocol(Range1d &Protocol, const string &last_token) {
-	// Example : 0x06/0xFF
-	vector<string> split_slash = split(last_token, '/');
-
-	if (split_slash[1] != "0xFF") {
-		Protocol.low = 0;
-		Protocol.high = 255;
-	} else {
-		Protocol.low = Protocol.high = std::stoul(split_slash[0], nullptr, 16);
-	}
-}
-
-int InputReader::ReadFilter(vector<string> &tokens, vector<Rule> &ruleset,
-		unsigned int cost) {
-	// 5 fields: sip, dip, sport, dport, proto = 0 (with@), 1, 2 : 4, 5 : 7, 8
-
-	/*allocate a few more bytes just to be on the safe side to avoid overflow etc*/
-	Rule temp_rule(dim);
-	string key;
-	if (tokens[0].at(0) == '#') {
-		return 0; // comment skip
-	}
-	if (tokens[0].at(0) != '@') {
-		/* each rule should begin with an '@' */
-		printf("ERROR: NOT A VALID RULE FORMAT\n");
-		exit(1);
-	}
-
-	int index_token = 0;
-	int i = 0;
-	for (int rep = 0; rep < reps; rep++) {
-		/* reading SIP range */
-		if (i == 0) {
-			ReadIPRange(temp_rule.range[i], temp_rule.prefix_length[i],
-					tokens[index_token++].substr(1));
-		} else {
-			ReadIPRange(temp_rule.range[i], temp_rule.prefix_length[i],
-					tokens[index_token++]);
-		}
-		i++;
-		/* reading DIP range */
-		ReadIPRange(temp_rule.range[i], temp_rule.prefix_length[i],
-				tokens[index_token++]);
-		i++;
-		ReadPort(temp_rule.range[i++], tokens[index_token],
-				tokens[index_token + 2]);
-		index_token += 3;
-		ReadPort(temp_rule.range[i++], tokens[index_token],
-				tokens[index_token + 2]);
-		index_token += 3;
-		ReadProtocol(temp_rule.range[i++], tokens[index_token++]);
-	}
-
-	temp_rule.priority = cost;
-
-	ruleset.push_back(temp_rule);
-
-	return 0;
-}
-void InputReader::LoadFilters(ifstream &fp, vector<Rule> &ruleset) {
-	int line_number = 0;
-	string content;
-	while (getline(fp, content)) {
-		istringstream iss(content);
-		vector<string> tokens { istream_iterator<string> { iss },
-				istream_iterator<string> { } };
-		ReadFilter(tokens, ruleset, line_number++);
-	}
-}
-vector<Rule> InputReader::ReadFilterFileClassBench(const string &filename) {
+vector<Rule> InputReader::ReadFilterFileClassBench(const string &filename,
+		const DimensionSchema &schema) {
 	//assume 5*rep fields
-	vector<Rule> rules;
-	ifstream column_counter(filename);
-	ifstream input_file(filename);
-	if (!input_file.is_open() || !column_counter.is_open()) {
-		throw ifstream("Couldn't open filter set file");
-	}
-
-	LoadFilters(input_file, rules);
-	input_file.close();
-	column_counter.close();
-
-	/*for (int i = 0; i < 5; i++) {
-	 set<interval> iv;
-	 for (rule& r : ruleset) {
-	 iv.insert(interval(r.range[i][0], r.range[i][1], 0));
-	 }
-	 cout << "field " << i << " has " << iv.size() << " unique intervals" << endl;
-	 }*/
-	/*for (auto& r : rules) {
-	 for (auto &p : r.range) {
-	 cout << p[0] << ":" << p[1] << " ";
-	 }
-	 cout << endl;
-	 }
-	 exit(0);*/
-
-	return rules;
+	return ClassBenchParser::ParseFile(filename, schema);
 }
 
 bool IsPower2(unsigned int x) {
@@ -323,6 +171,14 @@ vector<Rule> InputReader::ReadFilterFileMSU(const string &filename) {
  * */
 vector<Rule> InputReader::ReadFilterFile(const string &filename) {
 	vector<Rule> res;
+	if (BinaryFormat::IsBinaryFile(filename)) {
+		// binary files are stored after the deduplication and priority assignment
+		res = BinaryFormat::ReadRules(filename);
+		if (res.size())
+			dim = res[0].dim;
+		DimensionSchema::SetCurrent(DimensionSchema::ForDim(dim));
+		return res;
+	}
 	ifstream in(filename);
 	if (!in.is_open()) {
 		throw ifstream::failure(
@@ -344,6 +200,7 @@ vector<Rule> InputReader::ReadFilterFile(const string &filename) {
 		dim = reps * 5;
 
 		res = ReadFilterFileMSU(filename);
+		DimensionSchema::SetCurrent(DimensionSchema::ForDim(dim));
 	} else if (content[0] == '@') {
 		// CLassBench Format
 		/* COUNT COLUMN */
@@ -352,8 +209,13 @@ vector<Rule> InputReader::ReadFilterFile(const string &filename) {
 			reps = tokens.size() / 9;
 		}
 
-		dim = reps * 5;
-		res = ReadFilterFileClassBench(filename);
+		// the IPv6 address contains ':' (the ports are separated by " : ")
+		bool ipv6 = tokens[0].find(':') != string::npos;
+		DimensionSchema schema =
+				ipv6 ? DimensionSchema::IPv6(reps) : DimensionSchema::IPv4(reps);
+		DimensionSchema::SetCurrent(schema);
+		dim = schema.NumLanes();
+		res = ReadFilterFileClassBench(filename, schema);
 	} else {
 		in.close();
 		throw ifstream::failure(
@@ -363,22 +225,39 @@ vector<Rule> InputReader::ReadFilterFile(const string &filename) {
 	}
 	in.close();
 
-	set<vector<Range1d>> seen_rule_ranges; // to make all rules unique
+	// to make all rules unique, the set stores only pointers to ranges of rules in res
+	struct RangesHash {
+		size_t operator()(const vector<Range1d> *v) const {
+			return hash<vector<Range1d>> { }(*v);
+		}
+	};
+	struct RangesEq {
+		bool operator()(const vector<Range1d> *a,
+				const vector<Range1d> *b) const {
+			return *a == *b;
+		}
+	};
+	unordered_set<const vector<Range1d>*, RangesHash, RangesEq> seen_rule_ranges;
+	seen_rule_ranges.reserve(res.size());
 	vector<Rule> res_tmp;
+	res_tmp.reserve(res.size());
 
 	for (auto &r : res) {
-		if (seen_rule_ranges.find(r.range) != seen_rule_ranges.end()) {
+		if (!seen_rule_ranges.insert(&r.range).second) {
 			// duplicit rule
 			continue;
 		}
 		res_tmp.push_back(r);
-		seen_rule_ranges.insert(r.range);
 	}
 	//need to rearrange the priority, first has the highest
-	int max_pri = res_tmp.size() - 1;
-	for (size_t i = 0; i < res_tmp.size(); i++) {
-		res_tmp[i].id = res_tmp[i].priority = max_pri - i;
-	}
+	AssignPriorities(res_tmp);
 
 	return res_tmp;
 }
+
+void InputReader::AssignPriorities(vector<Rule> &rules) {
+	int max_pri = rules.size() - 1;
+	for (size_t i = 0; i < rules.size(); i++) {
+		rules[i].id = rules[i].priority = max_pri - i;
+	}
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../ElementaryClasses.h"
+#include "../DimensionSchema.h"
 
 //CREDIT:: REUSE INPUT READER FROM Hypersplit's original code//
 class  InputReader {
@@ -9,22 +10,30 @@ public:
 	static int dim ;
 	static int reps ;
 
+	/**
+	 * Read ruleset in MSU, ClassBench (IPv4 or IPv6) or binary format
+	 * (detected from the file content), sets dim, reps and the current DimensionSchema
+	 */
 	static std::vector<Rule> ReadFilterFile(const std::string& filename);
 
+	/**
+	 * Read packet trace in ClassBench or binary format (detected from the file content),
+	 * the packet has one number for each lane of the DimensionSchema
+	 */
 	static std::vector<std::vector<unsigned int>> ReadPackets(const std::string& filename);
+
+	/**
+	 * Set id and priority of the rules, first rule has the highest priority
+	 */
+	static void AssignPriorities(std::vector<Rule>& rules);
 private:
 	static unsigned int inline atoui(const std::string& in);
 	static std::vector<std::string> &split(const std::string &s, char delim, std::vector<std::string> &elems);
 	static std::vector<std::string> split(const std::string &s, char delim);
 
-//	static void ReadIPRange(vector<unsigned int>& IPrange, const string& token);
-	static void  ReadIPRange(Range1d& IPrange, unsigned int& prefix_length, const std::string& token);
-	static void ReadPort(Range1d& Portrange, const std::string& from, const std::string& to);
-	static void ReadProtocol(Range1d& Protocol, const std::string& last_token);
 	static void ParseRange(Range1d& range, const std::string& text);
-	static int ReadFilter(std::vector<std::string>& tokens, std::vector<Rule>& ruleset, unsigned int cost);
-	static  void LoadFilters(std::ifstream& fp, std::vector<Rule>& ruleset);
-	static std::vector<Rule> ReadFilterFileClassBench(const std::string&  filename);
+	static std::vector<Rule> ReadFilterFileClassBench(const std::string&  filename,
+			const DimensionSchema &schema);
 	static std::vector<Rule> ReadFilterFileMSU(const std::string& filename);
 
 	static const int LOW = 0;
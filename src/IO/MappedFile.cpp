@@ -0,0 +1,40 @@
+#include "MappedFile.h"
+
+#include <fcntl.h>
+#include <ios>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string &filename) :
+		_data(nullptr), _size(0) {
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw std::ios_base::failure(
+				std::string("Couldn't open file \"") + filename + "\"");
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		throw std::ios_base::failure(
+				std::string("Couldn't stat file \"") + filename + "\"");
+	}
+	_size = st.st_size;
+	if (_size) {
+		void *m = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE | MAP_POPULATE,
+				fd, 0);
+		if (m == MAP_FAILED) {
+			close(fd);
+			throw std::ios_base::failure(
+					std::string("Couldn't mmap file \"") + filename + "\"");
+		}
+		madvise(m, _size, MADV_SEQUENTIAL);
+		_data = reinterpret_cast<const char*>(m);
+	}
+	close(fd);
+}
+
+MappedFile::~MappedFile() {
+	if (_data)
+		munmap(const_cast<char*>(_data), _size);
+}
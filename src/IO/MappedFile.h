@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+/**
+ * Read-only memory mapping of the whole file (RAII)
+ */
+class MappedFile {
+public:
+	/**
+	 * @throws std::ios_base::failure if the file can not be opened or mapped
+	 */
+	MappedFile(const std::string &filename);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
+
+	const char* data() const {
+		return _data;
+	}
+	size_t size() const {
+		return _size;
+	}
+private:
+	const char *_data;
+	size_t _size;
+};
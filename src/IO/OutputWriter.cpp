@@ -1,4 +1,5 @@
 #include "OutputWriter.h"
+#include "../DimensionSchema.h"
 
 #include <algorithm>
 #include <iostream>
@@ -93,3 +94,65 @@ bool OutputWriter::WriteJsonFile(const string& filename, const vector<string>& h
 
 	return true;
 }
+
+static void WriteIPRange(ostream &out, const Range1d &r, unsigned prefix_length) {
+	out << ((r.low >> 24) & 0xFF) << '.' << ((r.low >> 16) & 0xFF) << '.'
+			<< ((r.low >> 8) & 0xFF) << '.' << (r.low & 0xFF) << '/'
+			<< prefix_length;
+}
+
+// 4 lanes of the IPv6 address (all groups written, without "::")
+static void WriteIPv6Range(ostream &out, const Rule &r, int lane) {
+	unsigned prefix_length = 0;
+	out << hex;
+	for (int i = 0; i < 4; i++) {
+		const Range1d &l = r.range[lane + i];
+		out << (l.low >> 16) << ':' << (l.low & 0xFFFF) << (i == 3 ? '/' : ':');
+		prefix_length += r.prefix_length[lane + i];
+	}
+	out << dec << prefix_length;
+}
+
+bool OutputWriter::WriteClassBenchFile(const string& filename, const vector<Rule>& rules) {
+	ofstream out(filename);
+	if (!out.good()) {
+		printf("Failed to open %s\n", filename.c_str());
+		return false;
+	}
+	char proto[16];
+	for (const Rule &r : rules) {
+		const DimensionSchema &schema = DimensionSchema::ForDim(r.dim);
+		if (schema.NumFields() % 5 != 0) {
+			printf("ClassBench format requires 5*n fields (rule has %d)\n", r.dim);
+			return false;
+		}
+		for (size_t f = 0; f < schema.NumFields(); f += 5) {
+			if (f == 0)
+				out << '@';
+			else
+				out << '\t';
+			for (size_t a = f; a < f + 2; a++) {
+				int lane = schema.GetField(a).first_lane;
+				if (schema.GetField(a).width == 128)
+					WriteIPv6Range(out, r, lane);
+				else
+					WriteIPRange(out, r.range[lane], r.prefix_length[lane]);
+				out << (a == f ? "\t" : "");
+			}
+			int i = schema.GetField(f + FieldSP).first_lane - FieldSP;
+			out << '\t' << r.range[i + FieldSP].low << " : " << r.range[i + FieldSP].high;
+			out << '\t' << r.range[i + FieldDP].low << " : " << r.range[i + FieldDP].high;
+			const Range1d &p = r.range[i + FieldProto];
+			if (p.low == p.high)
+				snprintf(proto, sizeof(proto), "0x%02X/0xFF", p.low);
+			else
+				snprintf(proto, sizeof(proto), "0x00/0x00");
+			out << '\t' << proto;
+		}
+		if (r.dim == 5)
+			out << "\t0x0000/0x0000"; // flags
+		out << '\n';
+	}
+	out.close();
+	return out.good();
+}
@@ -8,6 +8,10 @@ class OutputWriter {
 public:
 	static bool WriteCsvFile(const std::string& filename, const std::vector<std::string>& header, const std::vector<std::map<std::string, std::string>>& data);
 	static bool WriteJsonFile(const std::string& filename, const std::vector<std::string>& header, const std::vector<std::map<std::string, std::string>>& data);
+	/**
+	 * Write the rules in ClassBench format (rules are expected to be sorted by priority, highest first)
+	 */
+	static bool WriteClassBenchFile(const std::string& filename, const std::vector<Rule>& rules);
 
 private:
 	static int Callback(void *NotUsed, int argc, char **argv, char **azColName);
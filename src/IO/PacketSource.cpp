@@ -0,0 +1,207 @@
+#include "PacketSource.h"
+#include "BinaryFormat.h"
+#include "../ClassBenchTraceGenerator/trace_tools.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+void PacketSource::PrepareBatch(vector<Packet> &batch, size_t size) {
+	if (batch.size() < size)
+		batch.resize(size);
+	else
+		batch.erase(batch.begin() + size, batch.end());
+}
+
+FilePacketSource::FilePacketSource(const string &filename, size_t dim,
+		size_t batch_size, size_t total) :
+		PacketSource(batch_size), file(filename), binary(
+				BinaryFormat::HasMagic(file.data(), file.size())), dim(dim), begin(
+				file.data()), end(file.data() + file.size()), record_size(0), total(
+				total), produced(0), produced_in_pass(0) {
+	if (binary) {
+		const auto &h = BinaryFormat::CheckPacketFile(file, filename);
+		this->dim = h.dim;
+		record_size = h.record_size;
+		begin = file.data() + sizeof(BinaryFormat::BinaryFileHeader);
+		end = begin + h.record_cnt * h.record_size;
+	}
+	pos = begin;
+}
+
+static inline bool IsDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+bool FilePacketSource::ReadPacket(Packet &p) {
+	p.resize(dim);
+	if (binary) {
+		if (pos == end)
+			return false;
+		memcpy(&p[0], pos, record_size);
+		pos += record_size;
+		return true;
+	}
+	// text format: dim numbers on each line (the rest of the line is ignored)
+	while (pos != end) {
+		const char *eol = static_cast<const char*>(memchr(pos, '\n',
+				end - pos));
+		if (eol == nullptr)
+			eol = end;
+		const char *s = pos;
+		pos = eol == end ? end : eol + 1;
+		size_t i = 0;
+		for (; i < dim; i++) {
+			while (s != eol && !IsDigit(*s))
+				s++;
+			if (s == eol)
+				break;
+			Point1d v = 0;
+			for (; s != eol && IsDigit(*s); s++)
+				v = v * 10 + (*s - '0');
+			p[i] = v;
+		}
+		if (i == dim)
+			return true;
+		// empty or incomplete line
+	}
+	return false;
+}
+
+bool FilePacketSource::NextBatch(vector<Packet> &batch) {
+	size_t cnt = batch_size;
+	if (total)
+		cnt = min(cnt, total - produced);
+	PrepareBatch(batch, cnt);
+	size_t i = 0;
+	while (i < cnt) {
+		if (ReadPacket(batch[i])) {
+			i++;
+			produced_in_pass++;
+		} else if (total && produced_in_pass) {
+			// replay
+			pos = begin;
+			produced_in_pass = 0;
+		} else {
+			break;
+		}
+	}
+	PrepareBatch(batch, i);
+	produced += i;
+	return i != 0;
+}
+
+GeneratorPacketSource::GeneratorPacketSource(const vector<Rule> &rules,
+		size_t batch_size, size_t total) :
+		PacketSource(batch_size), rules(rules), header(
+				rules.empty() ? 0 : rules[0].dim), copies_left(0), total(total), produced(
+				0) {
+	if (rules.empty()) {
+		printf("warning there is no rule?\n");
+		this->total = 0;
+	}
+}
+
+bool GeneratorPacketSource::NextBatch(vector<Packet> &batch) {
+	size_t cnt = min(batch_size, total - produced);
+	PrepareBatch(batch, cnt);
+	// same as header_gen(d, rules, 1, 0.1f, total)
+	for (size_t i = 0; i < cnt; i++) {
+		if (copies_left == 0) {
+			int RandFilt = rand.random_int(0, rules.size() - 1);
+			RandomCorner(rand, rules[RandFilt], header, header.size());
+			copies_left = MyPareto(rand, 1, 0.1f);
+		}
+		copies_left--;
+		batch[i].assign(header.begin(), header.end());
+	}
+	produced += cnt;
+	return cnt != 0;
+}
+
+FlowTracePacketSource::FlowTracePacketSource(const FlowTraceGenerator &gen,
+		size_t total) :
+		PacketSource(FlowTraceGenerator::SEGMENT_SIZE), gen(gen), total(total), produced(
+				0) {
+}
+
+bool FlowTracePacketSource::NextBatch(vector<Packet> &batch) {
+	size_t cnt = min(batch_size, total - produced);
+	gen.GenerateSegment(produced / FlowTraceGenerator::SEGMENT_SIZE, cnt,
+			batch);
+	produced += cnt;
+	return cnt != 0;
+}
+
+PrefetchingPacketSource::PrefetchingPacketSource(
+		unique_ptr<PacketSource> _source) :
+		PacketSource(_source->BatchSize()), source(std::move(_source)), filled {
+				false, false }, last { false, false }, consumer_index(0), stop(
+				false), wait_time(0) {
+	producer = thread(&PrefetchingPacketSource::Produce, this);
+}
+
+PrefetchingPacketSource::~PrefetchingPacketSource() {
+	{
+		lock_guard<mutex> lk(buffer_mutex);
+		stop = true;
+	}
+	buffer_cv.notify_all();
+	producer.join();
+}
+
+void PrefetchingPacketSource::Produce() {
+	size_t i = 0;
+	while (true) {
+		{
+			unique_lock<mutex> lk(buffer_mutex);
+			buffer_cv.wait(lk, [this, i]() {
+				return stop || !filled[i];
+			});
+			if (stop)
+				return;
+		}
+		// the buffer is owned by the producer until it is marked as filled
+		bool more;
+		try {
+			more = source->NextBatch(buffers[i]);
+		} catch (...) {
+			lock_guard<mutex> lk(buffer_mutex);
+			error = current_exception();
+			more = false;
+		}
+		{
+			lock_guard<mutex> lk(buffer_mutex);
+			filled[i] = true;
+			last[i] = !more;
+		}
+		buffer_cv.notify_all();
+		if (!more)
+			return;
+		i ^= 1;
+	}
+}
+
+bool PrefetchingPacketSource::NextBatch(vector<Packet> &batch) {
+	size_t i = consumer_index;
+	auto start = chrono::steady_clock::now();
+	unique_lock<mutex> lk(buffer_mutex);
+	buffer_cv.wait(lk, [this, i]() {
+		return filled[i];
+	});
+	wait_time += chrono::steady_clock::now() - start;
+	if (error)
+		rethrow_exception(error);
+	if (last[i]) {
+		// keep the buffer filled, the producer has already finished
+		PrepareBatch(batch, 0);
+		return false;
+	}
+	batch.swap(buffers[i]);
+	filled[i] = false;
+	consumer_index ^= 1;
+	lk.unlock();
+	buffer_cv.notify_all();
+	return true;
+}
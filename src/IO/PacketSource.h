@@ -0,0 +1,140 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../ClassBenchTraceGenerator/flow_trace_gen.h"
+#include "../ElementaryClasses.h"
+#include "MappedFile.h"
+
+/**
+ * Source of the packets which produces the trace in batches of fixed size,
+ * so the whole trace does not have to be stored in memory.
+ */
+class PacketSource {
+public:
+	PacketSource(size_t batch_size) :
+			batch_size(batch_size) {
+	}
+	virtual ~PacketSource() {
+	}
+	/**
+	 * Fill the batch with the next packets (the packets already in the batch
+	 * are overwritten to avoid the allocations)
+	 *
+	 * @return false if there are no more packets (the batch is empty)
+	 */
+	virtual bool NextBatch(std::vector<Packet> &batch) = 0;
+
+	size_t BatchSize() const {
+		return batch_size;
+	}
+protected:
+	// resize the batch without the release of the packets which will be reused
+	static void PrepareBatch(std::vector<Packet> &batch, size_t size);
+
+	size_t batch_size;
+};
+
+/**
+ * Packets streamed from the memory mapped packet file (text or binary format)
+ *
+ * @note if total is larger than the number of packets in the file,
+ *       the file is replayed in loop
+ */
+class FilePacketSource: public PacketSource {
+public:
+	/**
+	 * @param dim number of the fields of the packet in the text format
+	 * @param total number of packets to produce, 0 = all packets once
+	 */
+	FilePacketSource(const std::string &filename, size_t dim,
+			size_t batch_size, size_t total = 0);
+	bool NextBatch(std::vector<Packet> &batch) override;
+private:
+	// @return false on the end of the file
+	bool ReadPacket(Packet &p);
+
+	MappedFile file;
+	bool binary;
+	size_t dim;
+	const char *begin;
+	const char *end;
+	const char *pos;
+	size_t record_size;
+	size_t total;
+	size_t produced;
+	// packets read since the last replay
+	size_t produced_in_pass;
+};
+
+/**
+ * Packets generated from the ruleset in the same way as GeneratePacketsFromRuleset,
+ * but without the limit on the number of packets
+ */
+class GeneratorPacketSource: public PacketSource {
+public:
+	GeneratorPacketSource(const std::vector<Rule> &rules, size_t batch_size,
+			size_t total);
+	bool NextBatch(std::vector<Packet> &batch) override;
+private:
+	const std::vector<Rule> &rules;
+	Random rand;
+	Packet header;
+	int copies_left;
+	size_t total;
+	size_t produced;
+};
+
+/**
+ * Packets from the FlowTraceGenerator, each batch is one segment of the trace
+ */
+class FlowTracePacketSource: public PacketSource {
+public:
+	FlowTracePacketSource(const FlowTraceGenerator &gen, size_t total);
+	bool NextBatch(std::vector<Packet> &batch) override;
+private:
+	const FlowTraceGenerator &gen;
+	size_t total;
+	size_t produced;
+};
+
+/**
+ * Wrapper which fills the batches of the wrapped source in a separate thread
+ * (double buffered), so the consumer does not have to wait for the IO/generator
+ *
+ * The batches are swapped with the consumer vector, so the packets are never copied.
+ */
+class PrefetchingPacketSource: public PacketSource {
+public:
+	using time_t = std::chrono::duration<double>;
+
+	PrefetchingPacketSource(std::unique_ptr<PacketSource> source);
+	~PrefetchingPacketSource();
+	bool NextBatch(std::vector<Packet> &batch) override;
+
+	// the time spent in NextBatch waiting for the producer thread
+	time_t WaitTime() const {
+		return wait_time;
+	}
+private:
+	void Produce();
+
+	std::unique_ptr<PacketSource> source;
+	std::vector<Packet> buffers[2];
+	bool filled[2];
+	bool last[2];
+	size_t consumer_index;
+	bool stop;
+	std::exception_ptr error;
+	std::mutex buffer_mutex;
+	std::condition_variable buffer_cv;
+	time_t wait_time;
+	std::thread producer;
+};
@@ -0,0 +1,226 @@
+#include "MegaflowCache.h"
+
+using namespace std;
+
+// number of lookups between the sorts of the subtables by hits
+static constexpr size_t SUBTABLE_SORT_PERIOD = 4096;
+
+MegaflowCache::MegaflowCache(size_t max_flows) :
+		max_flows(max<size_t>(max_flows, 1)), clock_hand(0), lookups_since_sort(
+				0), hits(0), misses(0), evictions(0), revalidated(0) {
+}
+
+MegaflowCache::~MegaflowCache() {
+	Clear();
+}
+
+uint32_t MegaflowCache::Hash(const Packet &packet, const FlowWildcards &mask) {
+	uint32_t hash = 0;
+	for (size_t d = 0; d < mask.size(); d++)
+		hash = hash_add(hash, packet[d] & mask[d]);
+	return hash_finish(hash, 16);
+}
+
+bool MegaflowCache::Lookup(const Packet &packet, int &result) {
+	if (++lookups_since_sort == SUBTABLE_SORT_PERIOD) {
+		stable_sort(subtables.begin(), subtables.end(),
+				[](const Subtable *a, const Subtable *b) {
+					return a->hits > b->hits;
+				});
+		for (auto st : subtables)
+			st->hits = 0;
+		lookups_since_sort = 0;
+	}
+	for (auto st : subtables) {
+		MEMORY_ACCESS_TRACE(st, sizeof(Subtable));
+		cmap_node *node = cmap_find(&st->map, Hash(packet, st->mask));
+		for (; node != nullptr; node = node->next) {
+			MEMORY_ACCESS_TRACE(node, sizeof(cmap_node));
+			if (node->rule_ptr->MatchesPacket(packet)) {
+				st->hits++;
+				flows[node->key].referenced = true;
+				result = node->priority;
+				hits++;
+				return true;
+			}
+		}
+	}
+	misses++;
+	return false;
+}
+
+void MegaflowCache::Install(const Packet &packet, const FlowWildcards &wc,
+		int result) {
+	if (flows.size() == max_flows) {
+		// CLOCK: evict the first megaflow which was not used since the last pass
+		while (flows[clock_hand].referenced) {
+			flows[clock_hand].referenced = false;
+			clock_hand = (clock_hand + 1) % flows.size();
+		}
+		Remove(clock_hand);
+		evictions++;
+		if (clock_hand >= flows.size())
+			clock_hand = 0;
+	}
+
+	Subtable *st = nullptr;
+	for (auto s : subtables) {
+		if (s->mask == wc) {
+			st = s;
+			break;
+		}
+	}
+	if (st == nullptr) {
+		st = new Subtable { wc, { }, 0 };
+		cmap_init(&st->map);
+		subtables.push_back(st);
+	}
+
+	Rule r(wc.size());
+	r.priority = result;
+	for (size_t d = 0; d < wc.size(); d++) {
+		r.range[d].low = packet[d] & wc[d];
+		r.range[d].high = packet[d] | ~wc[d];
+		r.prefix_length[d] = __builtin_popcount(wc[d]);
+	}
+	cmap_node *node = new cmap_node(r);
+	node->key = flows.size();
+	uint32_t hash = Hash(packet, wc);
+	cmap_insert(&st->map, node, hash);
+	flows.push_back( { node, st, hash, false });
+}
+
+void MegaflowCache::Remove(size_t index) {
+	Megaflow &f = flows[index];
+	Subtable *st = f.subtable;
+	cmap_remove(&st->map, f.node, f.hash);
+	delete f.node;
+	if (cmap_is_empty(&st->map)) {
+		cmap_destroy(&st->map);
+		subtables.erase(find(subtables.begin(), subtables.end(), st));
+		delete st;
+	}
+	if (index != flows.size() - 1) {
+		flows[index] = flows.back();
+		flows[index].node->key = index;
+	}
+	flows.pop_back();
+}
+
+static bool Overlaps(const Rule &a, const Rule &b) {
+	for (int d = 0; d < a.dim; d++) {
+		if (a.range[d].high < b.range[d].low || b.range[d].high < a.range[d].low)
+			return false;
+	}
+	return true;
+}
+
+template<typename Pred>
+void MegaflowCache::RemoveOverlapping(const Rule &rule, Pred pred) {
+	// backwards, the removal moves the last (already checked) megaflow to index
+	for (size_t i = flows.size(); i-- > 0;) {
+		const cmap_node *node = flows[i].node;
+		if (pred(node->priority) && Overlaps(*node->rule_ptr, rule)) {
+			Remove(i);
+			revalidated++;
+		}
+	}
+	if (clock_hand >= flows.size())
+		clock_hand = 0;
+}
+
+void MegaflowCache::RuleInserted(const Rule &rule) {
+	// only the packets matched by the new rule with lower priority result change
+	RemoveOverlapping(rule, [&rule](int result) {
+		return result < rule.priority;
+	});
+}
+
+void MegaflowCache::RuleDeleted(const Rule &rule) {
+	// only the packets for which the deleted rule was the result change
+	RemoveOverlapping(rule, [&rule](int result) {
+		return result == rule.priority;
+	});
+}
+
+void MegaflowCache::Clear() {
+	for (auto &f : flows)
+		delete f.node;
+	flows.clear();
+	for (auto st : subtables) {
+		cmap_destroy(&st->map);
+		delete st;
+	}
+	subtables.clear();
+	clock_hand = 0;
+}
+
+Memory MegaflowCache::MemSizeBytes() const {
+	Memory size = flows.capacity() * sizeof(Megaflow)
+			+ subtables.capacity() * sizeof(Subtable*);
+	for (auto st : subtables) {
+		size += sizeof(Subtable) + st->mask.size() * sizeof(uint32_t)
+				+ cmap_array_size(&st->map) * POINTER_SIZE_BYTES;
+	}
+	for (auto &f : flows)
+		size += sizeof(cmap_node) + sizeof(Rule)
+				+ f.node->rule_ptr->dim * (sizeof(Range1d) + sizeof(int));
+	return size;
+}
+
+void MegaflowCache::CollectStats(map<string, string> &summary) const {
+	summary["Megaflow.Hits"] = to_string(hits);
+	summary["Megaflow.Misses"] = to_string(misses);
+	uint64_t lookups = hits + misses;
+	summary["Megaflow.HitRate"] = to_string(
+			lookups ? double(hits) / lookups : 0.0);
+	summary["Megaflow.Flows"] = to_string(flows.size());
+	summary["Megaflow.Masks"] = to_string(subtables.size());
+	summary["Megaflow.Evictions"] = to_string(evictions);
+	summary["Megaflow.Revalidated"] = to_string(revalidated);
+}
+
+MegaflowClassifier::MegaflowClassifier(size_t max_flows) :
+		cache(max_flows), dim(5) {
+}
+
+void MegaflowClassifier::_ConstructClassifier(const vector<Rule> &rules) {
+	if (rules.size())
+		dim = rules[0].dim;
+	slow_path.ConstructClassifier(rules);
+	cache.Clear();
+}
+
+int MegaflowClassifier::ClassifyAPacket(const Packet &packet) {
+	int result;
+	if (cache.Lookup(packet, result)) {
+		QueryCountersUpdate(0);
+		return result;
+	}
+	int queried = slow_path.TablesQueried();
+	wc.assign(dim, 0);
+	result = slow_path.ClassifyAPacket(packet, wc);
+	QueryCountersUpdate(slow_path.TablesQueried() - queried);
+	cache.Install(packet, wc, result);
+	return result;
+}
+
+void MegaflowClassifier::_DeleteRule(size_t index) {
+	Rule rule = slow_path.GetRule(index);
+	slow_path.DeleteRule(index);
+	cache.RuleDeleted(rule);
+}
+
+void MegaflowClassifier::_InsertRule(const Rule &rule) {
+	slow_path.InsertRule(rule);
+	cache.RuleInserted(rule);
+}
+
+Memory MegaflowClassifier::MemSizeBytes() const {
+	return slow_path.MemSizeBytes() + cache.MemSizeBytes();
+}
+
+void MegaflowClassifier::CollectStats(map<string, string> &summary) const {
+	cache.CollectStats(summary);
+	slow_path.CollectStats(summary);
+}
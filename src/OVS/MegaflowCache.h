@@ -0,0 +1,120 @@
+#pragma once
+
+#include "TupleSpaceSearch.h"
+
+#include <map>
+#include <memory>
+
+/**
+ * Cache of the wildcarded lookup results (megaflows, as in the OVS datapath)
+ *
+ * A megaflow covers all packets which have the same value in the bits
+ * examined by the slow path lookup of a packet (FlowWildcards), so the cached
+ * result is valid for all of them. The megaflows are stored in a tuple space:
+ * one cmap (subtable) for each distinct mask. The megaflows do not need any
+ * priority, the overlapping megaflows always have the same result.
+ *
+ * The number of megaflows is limited, the CLOCK algorithm selects the victim
+ * when the cache is full.
+ */
+class MegaflowCache {
+public:
+	MegaflowCache(size_t max_flows);
+	~MegaflowCache();
+
+	/**
+	 * @param result set to the cached result if the packet is in cache
+	 * @return true if the packet is covered by some megaflow
+	 */
+	bool Lookup(const Packet &packet, int &result);
+	// add the megaflow for the packet, the wc have to contain the examined bits
+	void Install(const Packet &packet, const FlowWildcards &wc, int result);
+	/**
+	 * Revalidation after the update of the slow path classifier,
+	 * remove all megaflows for which the result may change
+	 */
+	void RuleInserted(const Rule &rule);
+	void RuleDeleted(const Rule &rule);
+	void Clear();
+
+	size_t NumFlows() const {
+		return flows.size();
+	}
+	size_t NumMasks() const {
+		return subtables.size();
+	}
+	Memory MemSizeBytes() const;
+	void CollectStats(std::map<std::string, std::string> &summary) const;
+
+private:
+	struct Subtable {
+		FlowWildcards mask;
+		cmap map;
+		// hits since last sort of the subtables
+		uint64_t hits;
+	};
+	struct Megaflow {
+		// node->rule_ptr contains the covered ranges, node->priority the result,
+		// node->key is the index of the megaflow in flows
+		cmap_node *node;
+		Subtable *subtable;
+		uint32_t hash;
+		// used since the last pass of the CLOCK hand
+		bool referenced;
+	};
+	static uint32_t Hash(const Packet &packet, const FlowWildcards &mask);
+	void Remove(size_t index);
+	// remove the megaflows overlapping the rule with the result selected by pred
+	template<typename Pred>
+	void RemoveOverlapping(const Rule &rule, Pred pred);
+
+	size_t max_flows;
+	// the subtables are sorted by hits periodically, so the most used
+	// are searched first
+	std::vector<Subtable*> subtables;
+	std::vector<Megaflow> flows;
+	size_t clock_hand;
+	size_t lookups_since_sort;
+
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+	uint64_t revalidated;
+};
+
+/**
+ * PriorityTupleSpaceSearch with the megaflow cache in front of it
+ */
+class MegaflowClassifier: public PacketClassifier {
+public:
+	MegaflowClassifier(size_t max_flows);
+
+	virtual void _ConstructClassifier(const std::vector<Rule> &rules);
+	virtual int ClassifyAPacket(const Packet &packet);
+	virtual void _DeleteRule(size_t index);
+	virtual void _InsertRule(const Rule &rule);
+	virtual Memory MemSizeBytes() const;
+	virtual int MemoryAccess() const {
+		return slow_path.MemoryAccess();
+	}
+	virtual bool SupportsMemoryAccessTrace() const {
+		return true;
+	}
+	virtual bool SupportsWideFields() const {
+		return true;
+	}
+	// tuples of the slow path (a cache hit queries 0 tables)
+	virtual size_t NumTables() const {
+		return slow_path.NumTables();
+	}
+	virtual size_t RulesInTable(size_t tableIndex) const {
+		return slow_path.RulesInTable(tableIndex);
+	}
+	virtual void CollectStats(std::map<std::string, std::string> &summary) const;
+
+private:
+	PriorityTupleSpaceSearch slow_path;
+	MegaflowCache cache;
+	size_t dim;
+	FlowWildcards wc;
+};
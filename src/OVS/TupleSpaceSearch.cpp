@@ -23,15 +23,19 @@
  */
 #include "TupleSpaceSearch.h"
 #include "../TupleMerge/SlottedTable.h"
+#include "../DimensionSchema.h"
+
+#include <stdexcept>
 
 // Values for Bernstein Hash
 #define HashBasis 5381
 #define HashMult 33
 
-void TupleTable::Insertion(const Rule& r) {
+cmap_node* TupleTable::Insertion(const Rule& r) {
 
 	cmap_node * new_node = new cmap_node(r); /*key & rule*/
 	cmap_insert(&map_in_tuple, new_node, HashRule(r));
+	return new_node;
 
 	/*uint32_t key = HashRule(r);
 	std::vector<Rule>& rl = table[key];
@@ -39,17 +43,8 @@ void TupleTable::Insertion(const Rule& r) {
 	sort(rl.begin(), rl.end(), [](const Rule& rx, const Rule& ry) { return rx.priority >= ry.priority; });*/
 }
 
-void TupleTable::Deletion(const Rule& r) {
-	//find node containing the rule
-	unsigned int hash_r = HashRule(r);
-	cmap_node * found_node = cmap_find(&map_in_tuple, hash_r);
-	while (found_node != nullptr) {
-		if (found_node->priority == r.priority) {
-			cmap_remove(&map_in_tuple, found_node, hash_r);
-			break;
-		}
-		found_node = found_node->next;
-	}
+void TupleTable::Deletion(cmap_node* node) {
+	cmap_remove(&map_in_tuple, node, HashRule(*node->rule_ptr));
 
 	/*uint32_t key = HashRule(r);
 	std::vector<Rule>& rl = table[key];
@@ -62,11 +57,20 @@ int TupleTable::WorstAccesses() const {
 }
 
 int TupleTable::ClassifyAPacket(const Packet& p)  {
+	return ClassifyAPacket<DynamicFieldSchema>(p);
+}
+
+template<class Schema>
+int TupleTable::ClassifyAPacket(const Packet& p)  {
+	MEMORY_ACCESS_TRACE(this, sizeof(TupleTable));
+	MEMORY_ACCESS_TRACE(dims.data(), dims.size() * sizeof(dims[0]));
+	MEMORY_ACCESS_TRACE(lengths.data(), lengths.size() * sizeof(lengths[0]));
 
 	cmap_node * found_node = cmap_find(&map_in_tuple, HashPacket(p));
 	int priority = -1;
 	while (found_node != nullptr) {
-		if (found_node->rule_ptr->MatchesPacket(p)) {
+		MEMORY_ACCESS_TRACE(found_node, sizeof(cmap_node));
+		if (Schema::Matches(*found_node->rule_ptr, p)) {
 			priority = std::max(priority, found_node->priority);
 		}
 		found_node = found_node->next;
@@ -84,6 +88,63 @@ int TupleTable::ClassifyAPacket(const Packet& p)  {
 	return -1;*/
 }
 
+/**
+ * Mask of the highest bits of v which decide whether v is in the range,
+ * (the largest aligned block around v which is inside or outside the range)
+ */
+static uint32_t RangeWildcards(uint32_t v, const Range1d &r) {
+	bool in = r.contains(v);
+	for (int k = 32; k > 0; k--) {
+		uint32_t low_bits = k == 32 ? 0xFFFFFFFF : (1u << k) - 1;
+		uint32_t lo = v & ~low_bits;
+		uint32_t hi = v | low_bits;
+		if (in ? (r.low <= lo && hi <= r.high) : (hi < r.low || lo > r.high))
+			return ~low_bits;
+	}
+	return 0xFFFFFFFF;
+}
+
+int TupleTable::ClassifyAPacket(const Packet& p, FlowWildcards& wc) {
+	MEMORY_ACCESS_TRACE(this, sizeof(TupleTable));
+	MEMORY_ACCESS_TRACE(dims.data(), dims.size() * sizeof(dims[0]));
+	MEMORY_ACCESS_TRACE(lengths.data(), lengths.size() * sizeof(lengths[0]));
+	// the packets with different bits in the tuple prefix hash to different bucket
+	for (size_t i = 0; i < dims.size(); i++) {
+		wc[dims[i]] |= lengths[i] != 32 ? ~(0xFFFFFFFF >> lengths[i]) : 0xFFFFFFFF;
+	}
+	cmap_node * found_node = cmap_find(&map_in_tuple, HashPacket(p));
+	int priority = -1;
+	while (found_node != nullptr) {
+		MEMORY_ACCESS_TRACE(found_node, sizeof(cmap_node));
+		const Rule &r = *found_node->rule_ptr;
+		if (r.MatchesPacket(p)) {
+			priority = std::max(priority, found_node->priority);
+			for (int d = 0; d < r.dim; d++)
+				wc[d] |= RangeWildcards(p[d], r.range[d]);
+		} else {
+			// one mismatching field is enough to keep the rule unmatched,
+			// use the one which adds the least bits
+			int best_d = -1;
+			uint32_t best_mask = 0;
+			int best_cost = 33;
+			for (int d = 0; d < r.dim; d++) {
+				if (r.range[d].contains(p[d]))
+					continue;
+				uint32_t mask = RangeWildcards(p[d], r.range[d]);
+				int cost = __builtin_popcount(mask & ~wc[d]);
+				if (cost < best_cost) {
+					best_d = d;
+					best_mask = mask;
+					best_cost = cost;
+				}
+			}
+			wc[best_d] |= best_mask;
+		}
+		found_node = found_node->next;
+	}
+	return priority;
+}
+
 bool inline TupleTable::IsPacketMatchToRule(const Packet& p, const Rule& r) {
 	for (int i = 0; i < r.dim; i++) {
 		if (p[i] < r.range[i].low) return false;
@@ -126,45 +187,65 @@ uint32_t inline TupleTable::HashPacket(const Packet& p) const {
 	return hash;*/
 }
 
+void TupleSpaceSearch::InitDims(int dim) {
+	const DimensionSchema &schema = DimensionSchema::ForDim(dim);
+	dims.clear();
+	for (size_t f = 0; f < std::min<size_t>(2, schema.NumFields()); f++) {
+		const auto &field = schema.GetField(f);
+		for (int i = 0; i < field.lanes; i++)
+			dims.push_back(field.first_lane + i);
+	}
+	// 6b of the key for each prefix length
+	if (dims.size() > 10)
+		throw std::runtime_error("TupleSpaceSearch: too many lanes in the tuple");
+}
+
 void TupleSpaceSearch::_ConstructClassifier(const std::vector<Rule>& r){
-	/*int multiples = 5;
-	for (int i = 0; i < r[0].dim / multiples; i++) {
-		dims.push_back(i * multiples);
-		dims.push_back(i * multiples + 1);
-	}*/
-	dims.push_back(FieldSA);
-	dims.push_back(FieldDA);
+	if (r.size())
+		InitDims(r[0].dim);
 
+	rule_nodes.reserve(r.size());
 	for (const auto& Rule : r) {
-		InsertRule(Rule);
+		_InsertRule(Rule);
 	}
-
-	rules = r;
-	rules.reserve(100000);
 }
 int TupleSpaceSearch::ClassifyAPacket(const Packet& packet) {
+	return Classify<DynamicFieldSchema>(packet);
+}
+template<class Schema>
+int TupleSpaceSearch::Classify(const Packet& packet) {
 	int priority = -1;
 	int query = 0;
 	for (auto& tuple : all_tuples) {
-		auto result = tuple.second.ClassifyAPacket(packet);
+		MEMORY_ACCESS_TRACE(&tuple, sizeof(tuple));
+		auto result = tuple.second.ClassifyAPacket<Schema>(packet);
 		priority = std::max(priority, result);
 		query++;
 	}
 	QueryCountersUpdate(query);
 	return priority;
 }
-void TupleSpaceSearch::DeleteRule(size_t i) {
+cmap_node* TupleSpaceSearch::PopRuleNode(size_t i) {
+	cmap_node* node = rule_nodes[i];
+	if (i != rule_nodes.size() - 1)
+		rule_nodes[i] = rule_nodes[rule_nodes.size() - 1];
+	rule_nodes.pop_back();
+	return node;
+}
+void TupleSpaceSearch::_DeleteRule(size_t i) {
 
-	if (i < 0 || i >= rules.size()) {
+	if (i < 0 || i >= rule_nodes.size()) {
 		printf("Warning index delete rule out of bound: do nothing here\n");
-		printf("%lu vs. size: %lu", i, rules.size());
+		printf("%lu vs. size: %lu", i, rule_nodes.size());
 		return;
 	}
 
-	auto hit = all_tuples.find(KeyRulePrefix(rules[i]));
+	cmap_node* node = PopRuleNode(i);
+	auto hit = all_tuples.find(KeyRulePrefix(*node->rule_ptr));
 	if (hit != end(all_tuples)) {
 		//there is a tuple
-		hit->second.Deletion(rules[i]);
+		hit->second.Deletion(node);
+		delete node;
 		if (hit->second.IsEmpty()) {
 			//destroy tuple and erase from the map
 			hit->second.Destroy();
@@ -175,24 +256,20 @@ void TupleSpaceSearch::DeleteRule(size_t i) {
 		printf("Warning DeleteRule: no matching tuple in the rule; it should be here when inserted\n");
 		exit(0);
 	}
-	if (i != rules.size() - 1)
-		rules[i] = std::move(rules[rules.size() - 1]);
-	rules.pop_back();
 }
-void TupleSpaceSearch::InsertRule(const Rule& rule) {
+void TupleSpaceSearch::_InsertRule(const Rule& rule) {
+	if (dims.empty())
+		InitDims(rule.dim);
 	auto hit = all_tuples.find(KeyRulePrefix(rule));
-	if (hit != end(all_tuples)) {
-		//there is a tuple
-		hit->second.Insertion(rule);
-	} else {
+	if (hit == end(all_tuples)) {
 		//create_tuple
 		std::vector<unsigned int> lengths;
 		for (int d : dims) {
 			lengths.push_back(rule.prefix_length[d]);
 		}
-		all_tuples.insert(std::make_pair(KeyRulePrefix(rule), TupleTable(dims, lengths, rule)));
+		hit = all_tuples.insert(std::make_pair(KeyRulePrefix(rule), TupleTable(dims, lengths))).first;
 	}
-	rules.push_back(rule);
+	rule_nodes.push_back(hit->second.Insertion(rule));
 }
 
 int TupleSpaceSearch::WorstAccesses() const {
@@ -203,63 +280,82 @@ int TupleSpaceSearch::WorstAccesses() const {
 	return cost;
 }
 
-void PriorityTuple::Insertion(const Rule& r, bool& priority_change) {
+cmap_node* PriorityTuple::Insertion(const Rule& r, bool& priority_change) {
 
 	if (r.priority > maxPriority) {
 		maxPriority = r.priority;
 		priority_change = true;
 	}
-	priority_container.insert(r.priority);
-	TupleTable::Insertion(r);
+	priorities.Insert(r.priority);
+	return TupleTable::Insertion(r);
 }
-void  PriorityTuple::Deletion(const Rule& r, bool& priority_change) {
+void  PriorityTuple::Deletion(cmap_node* node, bool& priority_change) {
 
-	auto pit = priority_container.equal_range(r.priority);
-	priority_container.erase(pit.first);
-	if (priority_container.size() == 0)  {
-		maxPriority = -1;
-		priority_change = true;
-	} else if (r.priority == maxPriority) {
-		maxPriority = *priority_container.rbegin();
-		priority_change = true;
-	} else priority_change = false;
-	TupleTable::Deletion(r);
+	priorities.Erase(node->priority);
+	priority_change = priorities.Max() != maxPriority;
+	maxPriority = priorities.Max();
+	TupleTable::Deletion(node);
 }
 
 
 int PriorityTupleSpaceSearch::ClassifyAPacket(const Packet& packet) {
+	return Classify<DynamicFieldSchema>(packet);
+}
+template<class Schema>
+int PriorityTupleSpaceSearch::Classify(const Packet& packet) {
 	int priority = -1;
 	int q = 0;
 	for (auto& tuple : priority_tuples_vector) {
+		MEMORY_ACCESS_TRACE(&tuple, sizeof(tuple));
+		MEMORY_ACCESS_TRACE(tuple, sizeof(PriorityTuple));
 		//if (tuple->maxPriority < 0) printf("priority %d\n", tuple->maxPriority);
 		if (priority > tuple->maxPriority) break;
-		auto result = tuple->ClassifyAPacket(packet);
+		auto result = tuple->ClassifyAPacket<Schema>(packet);
 		q++;
 		priority = priority > result ? priority : result;
 	}
 	QueryCountersUpdate(q);
 	return priority;
 }
-void PriorityTupleSpaceSearch::DeleteRule(size_t i) {
-	if (i < 0 || i >= rules.size()) {
+int PriorityTupleSpaceSearch::ClassifyAPacket(const Packet& packet, FlowWildcards& wc) {
+	int priority = -1;
+	int q = 0;
+	for (auto& tuple : priority_tuples_vector) {
+		MEMORY_ACCESS_TRACE(&tuple, sizeof(tuple));
+		MEMORY_ACCESS_TRACE(tuple, sizeof(PriorityTuple));
+		// the decision depends only on the result so far, no bits are examined
+		if (priority > tuple->maxPriority) break;
+		auto result = tuple->ClassifyAPacket(packet, wc);
+		q++;
+		priority = priority > result ? priority : result;
+	}
+	QueryCountersUpdate(q);
+	return priority;
+}
+void PriorityTupleSpaceSearch::_DeleteRule(size_t i) {
+	if (i < 0 || i >= rule_nodes.size()) {
 		printf("Warning index delete rule out of bound: do nothing here\n");
-		printf("%lu vs. size: %lu", i, rules.size());
+		printf("%lu vs. size: %lu", i, rule_nodes.size());
 		return;
 	}
 	bool priority_change = false;
 
-	auto hit = all_priority_tuples.find(KeyRulePrefix(rules[i]));
+	cmap_node* node = PopRuleNode(i);
+	auto hit = all_priority_tuples.find(KeyRulePrefix(*node->rule_ptr));
 
 	if (hit != end(all_priority_tuples)) {
 		//there is a tuple
-		hit->second->Deletion(rules[i], priority_change);
-		if (hit->second->IsEmpty()) {
+		PriorityTuple* ptuple = hit->second;
+		ptuple->Deletion(node, priority_change);
+		delete node;
+		if (ptuple->IsEmpty()) {
 			//destroy tuple and erase from the map
 
 			all_priority_tuples.erase(hit);
-			hit->second->Destroy();
+			ptuple->Destroy();
 			RetainInvaraintOfPriorityVector();
 			priority_tuples_vector.pop_back();
+			delete ptuple;
 
 		} else if (priority_change) {
 			//sort tuple again
@@ -271,33 +367,74 @@ void PriorityTupleSpaceSearch::DeleteRule(size_t i) {
 		printf("Warning DeleteRule: no matching tuple in the rule; it should be here when inserted\n");
 		exit(0);
 	}
-	if (i != rules.size() - 1)
-		rules[i] = std::move(rules[rules.size() - 1]);
-	rules.pop_back();
 
 }
-void PriorityTupleSpaceSearch::InsertRule(const Rule& rule) {
+void PriorityTupleSpaceSearch::_InsertRule(const Rule& rule) {
+	if (InsertRuleNode(rule)) {
+		RetainInvaraintOfPriorityVector();
+	}
+}
+bool PriorityTupleSpaceSearch::InsertRuleNode(const Rule& rule) {
+	if (dims.empty())
+		InitDims(rule.dim);
 	bool priority_change = false;
 	auto hit = all_priority_tuples.find(KeyRulePrefix(rule));
 	if (hit != end(all_priority_tuples)) {
 		//there is a tuple
-		hit->second->Insertion(rule, priority_change);
-		if (priority_change) {
-			RetainInvaraintOfPriorityVector();
-		}
+		rule_nodes.push_back(hit->second->Insertion(rule, priority_change));
+		return priority_change;
 	} else {
 		//create_tuple
 		std::vector<unsigned int> lengths;
 		for (int d : dims) {
 			lengths.push_back(rule.prefix_length[d]);
 		}
-		auto ptuple = new PriorityTuple(dims, lengths, rule);
+		auto ptuple = new PriorityTuple(dims, lengths);
+		rule_nodes.push_back(ptuple->Insertion(rule, priority_change));
 		all_priority_tuples.insert(std::make_pair(KeyRulePrefix(rule), ptuple));
 		// add to priority vector
 		priority_tuples_vector.push_back(ptuple);
+		return true;
+	}
+}
+void PriorityTupleSpaceSearch::_ApplyUpdates(const std::vector<size_t>& deleted,
+		const std::vector<const Rule*>& inserted) {
+	// the tuples emptied by the deletes are kept for the inserts of the batch,
+	// the vector is sorted once at the end
+	bool resort = false;
+	bool emptied = false;
+	for (size_t i : deleted) {
+		bool priority_change = false;
+		cmap_node* node = PopRuleNode(i);
+		PriorityTuple* ptuple = all_priority_tuples.at(KeyRulePrefix(*node->rule_ptr));
+		ptuple->Deletion(node, priority_change);
+		delete node;
+		resort |= priority_change;
+		emptied |= ptuple->IsEmpty();
+	}
+	for (const Rule* rule : inserted) {
+		resort |= InsertRuleNode(*rule);
+	}
+	if (emptied) {
+		for (auto it = all_priority_tuples.begin(); it != all_priority_tuples.end();) {
+			if (it->second->IsEmpty()) {
+				it = all_priority_tuples.erase(it);
+			} else {
+				++it;
+			}
+		}
+		auto last = std::remove_if(begin(priority_tuples_vector), end(priority_tuples_vector),
+				[](PriorityTuple* ptuple) {
+					if (!ptuple->IsEmpty()) return false;
+					ptuple->Destroy();
+					delete ptuple;
+					return true;
+				});
+		priority_tuples_vector.erase(last, end(priority_tuples_vector));
+	}
+	if (resort) {
 		RetainInvaraintOfPriorityVector();
 	}
-	rules.push_back(rule);
 }
 
 
@@ -308,3 +445,36 @@ int PriorityTupleSpaceSearch::WorstAccesses() const {
 	}
 	return cost;
 }
+
+template<class Schema>
+int TupleSpaceSearchFixed<Schema>::ClassifyAPacket(const Packet& packet) {
+	return Classify<Schema>(packet);
+}
+template<class Schema>
+void TupleSpaceSearchFixed<Schema>::CheckRule(const Rule& rule) const {
+	Schema::Check(rule);
+}
+template<class Schema>
+void TupleSpaceSearchFixed<Schema>::_InsertRule(const Rule& rule) {
+	Schema::Check(rule);
+	TupleSpaceSearch::_InsertRule(rule);
+}
+
+template<class Schema>
+int PriorityTupleSpaceSearchFixed<Schema>::ClassifyAPacket(const Packet& packet) {
+	return Classify<Schema>(packet);
+}
+template<class Schema>
+void PriorityTupleSpaceSearchFixed<Schema>::CheckRule(const Rule& rule) const {
+	Schema::Check(rule);
+}
+template<class Schema>
+void PriorityTupleSpaceSearchFixed<Schema>::_InsertRule(const Rule& rule) {
+	Schema::Check(rule);
+	PriorityTupleSpaceSearch::_InsertRule(rule);
+}
+
+template class TupleSpaceSearchFixed<IPv4FieldSchema>;
+template class TupleSpaceSearchFixed<IPv6FieldSchema>;
+template class PriorityTupleSpaceSearchFixed<IPv4FieldSchema>;
+template class PriorityTupleSpaceSearchFixed<IPv6FieldSchema>;
@@ -27,21 +27,28 @@
 #define POINTER_SIZE_BYTES 4
 
 #include "../Simulation.h"
+#include "../FieldSchema.h"
+#include "../Utilities/PriorityTracker.h"
 #include "cmap.h"
 #include <unordered_map>
 #include <algorithm>
 #include <fstream>
 
+/**
+ * Bits of the packet header examined by a lookup (a mask for each field),
+ * all packets which have the same value in these bits get the same result
+ */
+typedef std::vector<uint32_t> FlowWildcards;
+
 struct TupleTable {
 public:
 	TupleTable(const std::vector<int> &dims,
-			const std::vector<unsigned int> &lengths, const Rule &r) :
+			const std::vector<unsigned int> &lengths) :
 			dims(dims), lengths(lengths) {
 		for (int w : lengths) {
 			tuple.push_back(w);
 		}
 		cmap_init(&map_in_tuple);
-		Insertion(r);
 	}
 	//~TupleTable() { Destroy(); }
 	void Destroy() {
@@ -53,8 +60,15 @@ public:
 	}
 
 	int ClassifyAPacket(const Packet &p);
-	void Insertion(const Rule &r);
-	void Deletion(const Rule &r);
+	// lookup with the rule match specialized for Schema (FieldSchema.h)
+	template<class Schema>
+	int ClassifyAPacket(const Packet &p);
+	// lookup which also adds the examined bits to wc
+	int ClassifyAPacket(const Packet &p, FlowWildcards &wc);
+	// the rule in a new node
+	cmap_node* Insertion(const Rule &r);
+	// removes the node of a rule (it is not freed)
+	void Deletion(cmap_node *node);
 	int WorstAccesses() const;
 	int NumRules() const {
 		return cmap_count(&map_in_tuple);
@@ -81,21 +95,20 @@ protected:
 struct PriorityTuple: public TupleTable {
 public:
 	PriorityTuple(const std::vector<int> &dims,
-			const std::vector<unsigned int> &lengths, const Rule &r) :
-			TupleTable(dims, lengths, r) {
-		maxPriority = r.priority;
-		priority_container.insert(maxPriority);
+			const std::vector<unsigned int> &lengths) :
+			TupleTable(dims, lengths) {
 	}
-	void Insertion(const Rule &r, bool &priority_change);
-	void Deletion(const Rule &r, bool &priority_change);
+	cmap_node* Insertion(const Rule &r, bool &priority_change);
+	void Deletion(cmap_node *node, bool &priority_change);
 
 	int MaxPriority() const {
 		return maxPriority;
 	}
 	;
 
+	// priorities.Max(), read by the lookup
 	int maxPriority = -1;
-	std::multiset<int> priority_container;
+	PriorityTracker priorities;
 };
 
 class TupleSpaceSearch: public PacketClassifier {
@@ -105,16 +118,25 @@ public:
 		for (auto p : all_tuples) {
 			p.second.Destroy();
 		}
+		for (auto node : rule_nodes) {
+			delete node;
+		}
 	}
 
 	void _ConstructClassifier(const std::vector<Rule> &r);
 	int ClassifyAPacket(const Packet &one_packet);
-	void DeleteRule(size_t i);
-	void InsertRule(const Rule &one_rule);
+	void _DeleteRule(size_t i);
+	void _InsertRule(const Rule &one_rule);
 
 	int MemoryAccess() const {
 		return WorstAccesses();
 	}
+	bool SupportsMemoryAccessTrace() const {
+		return true;
+	}
+	bool SupportsWideFields() const {
+		return true;
+	}
 	virtual int WorstAccesses() const;
 	Memory MemSizeBytes() const {
 		int ruleSizeBytes = 19; // TODO variables sizes
@@ -165,9 +187,16 @@ public:
 	virtual size_t PriorityOfTable(size_t index) const {
 		return 0; //tables[index]->MaxPriority(); // TODO : assign some order
 	}
+	const Rule& GetRule(size_t index) const {
+		return *rule_nodes[index]->rule_ptr;
+	}
 protected:
+	template<class Schema>
+	int Classify(const Packet &packet);
+	// the tuple is formed by the lanes of the first two fields (SA, DA)
+	void InitDims(int dim);
 	uint64_t inline KeyRulePrefix(const Rule &r) {
-		int key = 0;
+		uint64_t key = 0;
 		for (int d : dims) {
 			key <<= 6;
 			key += r.prefix_length[d];
@@ -175,8 +204,11 @@ protected:
 		return key;
 	}
 	std::unordered_map<uint64_t, TupleTable> all_tuples;
-	//maintain rules for monitoring purpose
-	std::vector<Rule> rules;
+	// the node of each rule by its index (the rule is stored only in the node,
+	// so the rules which share a priority are told apart)
+	std::vector<cmap_node*> rule_nodes;
+	// removes the rule at the index from rule_nodes (the last one moves to the index)
+	cmap_node* PopRuleNode(size_t i);
 	std::vector<int> dims;
 };
 
@@ -184,8 +216,16 @@ class PriorityTupleSpaceSearch: public TupleSpaceSearch {
 
 public:
 	int ClassifyAPacket(const Packet &one_packet);
-	void DeleteRule(size_t i);
-	void InsertRule(const Rule &one_rule);
+	/**
+	 * Lookup which also reports the examined bits (for the megaflow cache),
+	 * wc has to have a mask for each field of the packet
+	 */
+	int ClassifyAPacket(const Packet &one_packet, FlowWildcards &wc);
+	void _DeleteRule(size_t i);
+	void _InsertRule(const Rule &one_rule);
+	// a single sort of the tuples after all updates
+	void _ApplyUpdates(const std::vector<size_t> &deleted,
+			const std::vector<const Rule*> &inserted);
 	int WorstAccesses() const;
 	Memory MemSizeBytes() const {
 		int ruleSizeBytes = 19; // TODO variables sizes
@@ -196,8 +236,8 @@ public:
 		int lookupSizeBytes = (all_priority_tuples.bucket_count()
 				+ all_priority_tuples.size()) * POINTER_SIZE_BYTES;
 		int arraySize = priority_tuples_vector.size() * POINTER_SIZE_BYTES;
-		return sizeBytes + rules.size() * ruleSizeBytes + lookupSizeBytes
-				+ arraySize;
+		return sizeBytes + rule_nodes.size() * POINTER_SIZE_BYTES
+				+ lookupSizeBytes + arraySize;
 	}
 
 	int GetNumberOfTuples() const {
@@ -233,7 +273,12 @@ public:
 	size_t PriorityOfTable(size_t index) const {
 		return priority_tuples_vector[index]->maxPriority;
 	}
+protected:
+	template<class Schema>
+	int Classify(const Packet &packet);
 private:
+	// the rule in its tuple (a new one if there is none), true if the tuples need a sort
+	bool InsertRuleNode(const Rule &rule);
 	void RetainInvaraintOfPriorityVector() {
 		std::sort(begin(priority_tuples_vector), end(priority_tuples_vector),
 				[](PriorityTuple *lhs, PriorityTuple *rhs) {
@@ -244,4 +289,24 @@ private:
 	std::vector<PriorityTuple*> priority_tuples_vector;
 };
 
+/**
+ * TupleSpaceSearch and PriorityTupleSpaceSearch with the rule match
+ * specialized for Schema, instantiated for IPv4FieldSchema and IPv6FieldSchema
+ */
+template<class Schema>
+class TupleSpaceSearchFixed: public TupleSpaceSearch {
+public:
+	int ClassifyAPacket(const Packet &one_packet);
+	void CheckRule(const Rule &one_rule) const;
+	void _InsertRule(const Rule &one_rule);
+};
+
+template<class Schema>
+class PriorityTupleSpaceSearchFixed: public PriorityTupleSpaceSearch {
+public:
+	int ClassifyAPacket(const Packet &one_packet);
+	void CheckRule(const Rule &one_rule) const;
+	void _InsertRule(const Rule &one_rule);
+};
+
 #endif
@@ -88,6 +88,7 @@ size_t cache_line_size() {
 #include <iostream>
 //#include "ovs-rcu.h"
 #include "random.h"
+#include "../Utilities/AllocationTracker.h"
 
 
 //#include "util.h"
@@ -242,6 +243,8 @@ xmalloc(size_t size)
 	if (p == NULL) {
 		printf("cannot allocate xmalloc");
 	}
+	if (__builtin_expect(AllocationTracker::enabled, 0))
+		AllocationTracker::Allocated(p);
 	return p;
 }
 /* Like xmalloc_cacheline() but clears the allocated memory to all zero
@@ -258,6 +261,8 @@ xmalloc_cacheline(size_t size)
 	if (error != 0) {
 		out_of_memory();
 	}
+	if (__builtin_expect(AllocationTracker::enabled, 0))
+		AllocationTracker::Allocated(p);
 	return p;
 #else
 	void **payload;
@@ -338,12 +343,16 @@ void
 free_cacheline(void *p)
 {
 #ifdef HAVE_POSIX_MEMALIGN
-	free(p);
+	void *base = p;
 #else
-	if (p) {
-		free(*(void **)((uintptr_t)p - MEM_ALIGN));
+	if (p == NULL) {
+		return;
 	}
+	void *base = *(void **)((uintptr_t)p - MEM_ALIGN);
 #endif
+	if (__builtin_expect(AllocationTracker::enabled, 0))
+		AllocationTracker::Released(base);
+	free(base);
 }
 
 
@@ -493,6 +502,7 @@ counter_changed(const struct cmap_bucket *b_, uint32_t c)
 static inline  struct cmap_node *
 cmap_find_in_bucket(const struct cmap_bucket *bucket, uint32_t hash)
 {
+	MEMORY_ACCESS_TRACE(bucket, sizeof(*bucket));
 	for (int i = 0; i < CMAP_K; i++) {
 		if (bucket->hashes[i] == hash) {
 			return bucket->nodes[i].next;
@@ -543,6 +553,7 @@ cmap_find(const struct cmap *cmap, uint32_t hash)
 
 	
 	const struct cmap_impl *impl = cmap_get_impl(cmap);
+	MEMORY_ACCESS_TRACE(impl, sizeof(*impl));
 	uint32_t h1 = rehash(impl, hash);
 	uint32_t h2 = other_hash(h1);
 
@@ -33,14 +33,14 @@ OptimizedMITree::~OptimizedMITree() {
 	delete root;
 }
 void OptimizedMITree::Insertion(const Rule& rule) {
-	priorityContainer.insert(rule.priority);
+	priorities.Insert(rule.priority);
 	maxPriority = std::max(maxPriority, rule.priority);
 	root->insertWithPathCompression(rule.range, 0, fieldOrder, rule.priority);
 	numRules++;
 }
 void OptimizedMITree::Insertion(const Rule& rule, bool& priorityChange) {
 	//	if (CanInsertRule(rule)) {
-	priorityContainer.insert(rule.priority);
+	priorities.Insert(rule.priority);
 	priorityChange = rule.priority > maxPriority;
 	maxPriority = std::max(maxPriority, rule.priority);
 	root->insertWithPathCompression(rule.range, 0, fieldOrder, rule.priority);
@@ -49,7 +49,7 @@ void OptimizedMITree::Insertion(const Rule& rule, bool& priorityChange) {
 }
 bool OptimizedMITree::TryInsertion(const Rule& rule, bool& priorityChange) {
 	if (CanInsertRule(rule)) {
-		priorityContainer.insert(rule.priority);
+		priorities.Insert(rule.priority);
 		priorityChange = rule.priority > maxPriority;
 		maxPriority = std::max(maxPriority, rule.priority);
 		root->insertWithPathCompression(rule.range, 0, fieldOrder,
@@ -62,16 +62,14 @@ bool OptimizedMITree::TryInsertion(const Rule& rule, bool& priorityChange) {
 }
 
 void OptimizedMITree::Deletion(const Rule& rule, bool& priorityChange) {
-	auto pit = priorityContainer.equal_range(rule.priority);
-
-	priorityContainer.erase(pit.first);
+	priorities.Erase(rule.priority);
 
 	if (numRules == 1) {
 		maxPriority = -1;
 		priorityChange = true;
 	} else if (rule.priority == maxPriority) {
 		priorityChange = true;
-		maxPriority = *priorityContainer.rbegin();
+		maxPriority = priorities.Max();
 	}
 	numRules--;
 	bool JustDeletedTree;
@@ -94,6 +92,7 @@ void OptimizedMITree::PrintFieldOrder() const {
 }
 
 int OptimizedMITree::ClassifyAPacket(const Packet& one_packet) const {
+	MEMORY_ACCESS_TRACE(fieldOrder.data(), fieldOrder.size() * sizeof(int));
 	return root->exactQueryIterative(one_packet, fieldOrder);
 }
 
@@ -109,7 +108,7 @@ int OptimizedMITree::MaxPriority() const {
 	return maxPriority;
 }
 bool OptimizedMITree::Empty() const {
-	return priorityContainer.empty();
+	return priorities.Empty();
 }
 
 void OptimizedMITree::ReconstructIfNumRulesLessThanOrEqualTo(
@@ -123,6 +122,8 @@ void OptimizedMITree::ReconstructIfNumRulesLessThanOrEqualTo(
 	}
 
 	std::vector<Rule> serialized_rules = SerializeIntoRules();
+	if (serialized_rules.empty())
+		return;
 	auto result =
 			SortableRulesetPartitioner::FastGreedyFieldSelectionForAdaptive(
 					serialized_rules);
@@ -166,7 +167,7 @@ void OptimizedMITree::Reset() {
 	delete root;
 	numRules = 0;
 	fieldOrder.clear();
-	priorityContainer.clear();
+	priorities.Clear();
 	maxPriority = -1;
 	root = new RedBlackTree();
 }
@@ -3,6 +3,7 @@
 #include "red_black_tree.h"
 #include "SortableRulesetPartitioner.h"
 #include "../Simulation.h"
+#include "../Utilities/PriorityTracker.h"
 
 /*
  * Multidimensional red-black tree
@@ -42,7 +43,7 @@ private:
 	RedBlackTree * root;
 	int numRules = 0;
 	std::vector<int> fieldOrder;
-	std::multiset<int> priorityContainer;
+	PriorityTracker priorities;
 	int maxPriority = -1;
 
 	bool IsIdenticalVector(const std::vector<int>& lhs,
@@ -5,8 +5,9 @@ using namespace std;
 void PartitionSort::_ConstructClassifier(const vector<Rule>& rules) {
 	//rb_selftest0();
 	this->rules.reserve(rules.size());
+	ruleTrees.reserve(rules.size());
 	for (const auto& r : rules) {
-		InsertRule(r);
+		_InsertRule(r);
 	}
 }
 
@@ -14,6 +15,8 @@ int PartitionSort::ClassifyAPacket(const Packet& packet) {
 	int result = -1;
 	int query = 0;
 	for (const auto& t : mitrees) {
+		MEMORY_ACCESS_TRACE(&t, sizeof(t));
+		MEMORY_ACCESS_TRACE(t, sizeof(OptimizedMITree));
 		if (result > t->MaxPriority()) {
 			break;
 		}
@@ -53,8 +56,8 @@ PartitionSort::~PartitionSort() {
 	}
 }
 
-void PartitionSort::DeleteRule(size_t i) {
-	if (i < 0 || i >= rules.size()) {
+void PartitionSort::_DeleteRule(size_t i) {
+	if (i >= rules.size()) {
 		cout << "Warning index delete rule out of bound: do nothing here"
 				<< endl;
 		cout << i << " vs. size: " << rules.size() << endl;
@@ -62,8 +65,8 @@ void PartitionSort::DeleteRule(size_t i) {
 	}
 	bool prioritychange = false;
 
-	OptimizedMITree * mitree = rules[i].second;
-	mitree->Deletion(rules[i].first, prioritychange);
+	OptimizedMITree * mitree = ruleTrees[i];
+	mitree->Deletion(rules[i], prioritychange);
 
 	if (prioritychange) {
 		InsertionSortMITrees();
@@ -74,14 +77,19 @@ void PartitionSort::DeleteRule(size_t i) {
 		delete mitree;
 	}
 
+	EraseRule(i);
+}
+
+void PartitionSort::EraseRule(size_t i) {
 	if (i != rules.size() - 1) {
-		rules[i] = move(rules[rules.size() - 1]);
+		rules[i] = move(rules.back());
+		ruleTrees[i] = ruleTrees.back();
 	}
 	rules.pop_back();
-
+	ruleTrees.pop_back();
 }
 
-void PartitionSort::InsertRule(const Rule& one_rule) {
+void PartitionSort::_InsertRule(const Rule& one_rule) {
 	for (auto mitree : mitrees) {
 		bool prioritychange = false;
 
@@ -91,7 +99,8 @@ void PartitionSort::InsertRule(const Rule& one_rule) {
 				InsertionSortMITrees();
 			}
 			mitree->ReconstructIfNumRulesLessThanOrEqualTo(10);
-			rules.push_back(make_pair(one_rule, mitree));
+			rules.push_back(one_rule);
+			ruleTrees.push_back(mitree);
 			return;
 		}
 	}
@@ -99,11 +108,57 @@ void PartitionSort::InsertRule(const Rule& one_rule) {
 
 	auto tree_ptr = new OptimizedMITree(one_rule);
 	tree_ptr->TryInsertion(one_rule, priority_change);
-	rules.push_back(make_pair(one_rule, tree_ptr));
+	rules.push_back(one_rule);
+	ruleTrees.push_back(tree_ptr);
 	mitrees.push_back(tree_ptr);
 	InsertionSortMITrees();
 }
 
+void PartitionSort::_ApplyUpdates(const vector<size_t>& deleted,
+		const vector<const Rule*>& inserted) {
+	// the emptied trees stay in mitrees until the end of the batch, they can
+	// take the inserted rules
+	bool prioritychange = false;
+	for (size_t i : deleted) {
+		bool change = false;
+		ruleTrees[i]->Deletion(rules[i], change);
+		prioritychange |= change;
+		EraseRule(i);
+	}
+	for (const Rule* one_rule : inserted) {
+		OptimizedMITree* target = nullptr;
+		for (auto mitree : mitrees) {
+			bool change = false;
+			if (mitree->TryInsertion(*one_rule, change)) {
+				prioritychange |= change;
+				mitree->ReconstructIfNumRulesLessThanOrEqualTo(10);
+				target = mitree;
+				break;
+			}
+		}
+		if (!target) {
+			bool change = false;
+			target = new OptimizedMITree(*one_rule);
+			target->TryInsertion(*one_rule, change);
+			mitrees.push_back(target);
+			prioritychange = true;
+		}
+		rules.push_back(*one_rule);
+		ruleTrees.push_back(target);
+	}
+	auto last = remove_if(mitrees.begin(), mitrees.end(),
+			[](OptimizedMITree* mitree) {
+				if (!mitree->Empty())
+					return false;
+				delete mitree;
+				return true;
+			});
+	mitrees.erase(last, mitrees.end());
+	if (prioritychange) {
+		InsertionSortMITrees();
+	}
+}
+
 void PartitionSort::InsertionSortMITrees() {
 	int i, j, numLength = mitrees.size();
 	OptimizedMITree * key;
@@ -24,15 +24,28 @@ public:
 	 * Get a sub-tree where rule is stored, delete it from tree,
 	 * sort/delete trees if required and remove rule from rules.
 	 */
-	void DeleteRule(size_t index);
+	void _DeleteRule(size_t index);
 
 	/**
 	 * Try insert rule in to an existing tree or create new tree if it is not possible.
 	 */
-	void InsertRule(const Rule& one_rule);
+	void _InsertRule(const Rule& one_rule);
+
+	/**
+	 * Deletes and inserts the rules as above, the trees are sorted and the
+	 * empty ones are deleted once after all updates.
+	 */
+	void _ApplyUpdates(const std::vector<size_t>& deleted,
+			const std::vector<const Rule*>& inserted);
 
 	virtual Memory MemSizeBytes() const override;
 	virtual int MemoryAccess() const override;
+	virtual bool SupportsMemoryAccessTrace() const override {
+		return true;
+	}
+	virtual bool SupportsWideFields() const override {
+		return true;
+	}
 	virtual size_t NumTables() const override;
 	virtual size_t RulesInTable(size_t index) const override;
 
@@ -41,8 +54,14 @@ public:
 protected:
 	// multiple decision trees for classification
 	std::vector<OptimizedMITree *> mitrees;
-	// vector used as a dictionary to find tree for rule
-	std::vector<std::pair<Rule, OptimizedMITree *>> rules;
+	// the rules by index, the trees keep only their ranges and the deletion
+	// of a rule needs them
+	std::vector<Rule> rules;
+	// the tree of the rule at the same index in rules
+	std::vector<OptimizedMITree *> ruleTrees;
+
+	// the deleted rule is replaced by the last one (the order of the indices)
+	void EraseRule(size_t index);
 
 	void InsertionSortMITrees();
 };
@@ -1,5 +1,6 @@
 #include "SortableRulesetPartitioner.h"
 #include "../Utilities/IntervalUtilities.h"
+#include "../DimensionSchema.h"
 #include <assert.h>
 using namespace std;
 
@@ -238,48 +239,22 @@ vector<SortableRuleset> SortableRulesetPartitioner::AdaptiveIncrementalInsertion
 }
 
 vector<int> SortableRulesetPartitioner::GetFieldOrderByRule(const Rule& r) {
+	const DimensionSchema& schema = DimensionSchema::ForDim(r.dim);
 	vector<unsigned> rank(r.dim, 0);
-	// 0 -> point, 1 -> shorter than half range, 2 -> longer than half range
-	//assign rank to each field
+	// 0 -> point, 1 -> shorter than half range, 2 -> longer than half range, 3 -> whole range
+	//assign rank to each lane (the width of the lane is given by its field)
 	for (int i = 0; i < r.dim; i++) {
 		int _r = 0;
-		auto length = r.range[i].high - r.range[i].low + 1;
-		switch (i) {
-			case FieldSA:
-			case FieldDA:
-				if (length == 1)
-					_r = 0;
-				else if (length > 0 && length < (1u << 31))
-					_r = 1;
-				else if (length == 0)
-					_r = 3;
-				else
-					_r = 2;
-				break;
-			case FieldSP:
-			case FieldDP:
-				if (length == 1)
-					_r = 0;
-				else if (length < (1 << 15))
-					_r = 1;
-				else if (length < (1 << 16))
-					_r = 2;
-				else
-					_r = 3;
-				break;
-			case FieldProto:
-				if (length == 1)
-					_r = 0;
-				else if (length < (1 << 7))
-					_r = 1;
-				else if (length < 256)
-					_r = 2;
-				else
-					_r = 3;
-				break;
-			default:
-				throw std::runtime_error("Not implemented for this dimension");
-		}
+		uint64_t length = uint64_t(r.range[i].high) - r.range[i].low + 1;
+		uint64_t size = uint64_t(schema.LaneMax(i)) + 1;
+		if (length == 1)
+			_r = 0;
+		else if (length < size / 2)
+			_r = 1;
+		else if (length < size)
+			_r = 2;
+		else
+			_r = 3;
 		rank[i] = _r;
 	}
 	return sort_indexes(rank);
@@ -50,52 +50,37 @@ RedBlackTree::RedBlackTree() {
 void RedBlackTree::rotateLeft(RedBlackTree_node* p) {
 	if (p->right == nullptr)
 		return;
-	else {
-		auto y = p->right;
-		if (y->left) {
-			p->right = y->left;
-			y->left->parent = p;
-		} else
-			p->right = nullptr;
-		if (p->parent)
-			y->parent = p->parent;
-
-		if (p->parent == nullptr)
-			root = y;
-		else {
-			if (p == p->parent->left)
-				p->parent->left = y;
-			else
-				p->parent->right = y;
-		}
-		y->left = p;
-		p->parent = y;
-	}
+	auto y = p->right;
+	p->right = y->left;
+	if (y->left)
+		y->left->parent = p;
+	y->parent = p->parent;
+	if (p->parent == nullptr)
+		root = y;
+	else if (p == p->parent->left)
+		p->parent->left = y;
+	else
+		p->parent->right = y;
+	y->left = p;
+	p->parent = y;
 }
 
 void RedBlackTree::rotateRight(RedBlackTree_node* p) {
 	if (p->left == nullptr)
 		return;
-	else {
-		auto y = p->left;
-		if (y->right) {
-			p->left = y->right;
-			y->right->parent = p;
-		} else
-			p->left = nullptr;
-		if (p->parent)
-			y->parent = p->parent;
-		if (p->parent == nullptr)
-			root = y;
-		else {
-			if (p == p->parent->left)
-				p->parent->left = y;
-			else
-				p->parent->right = y;
-		}
-		y->right = p;
-		p->parent = y;
-	}
+	auto y = p->left;
+	p->left = y->right;
+	if (y->right)
+		y->right->parent = p;
+	y->parent = p->parent;
+	if (p->parent == nullptr)
+		root = y;
+	else if (p == p->parent->left)
+		p->parent->left = y;
+	else
+		p->parent->right = y;
+	y->right = p;
+	p->parent = y;
 }
 
 bool RedBlackTree::canInsert(const std::vector<Range1d>& z, size_t level,
@@ -168,13 +153,15 @@ bool RedBlackTree::insertWithPathCompressionHelp(RedBlackTree_node* z,
 			return true;
 		} else { /* x.key || z.key */
 			// inserting colliding key
-			printf("Warning TreeInsertPathcompressionHelp : x.key || z.key\n");
+			throw std::runtime_error(
+					"TreeInsertPathcompressionHelp: overlapping keys");
 		}
 	}
 	z->parent = y;
-	if (root == nullptr) {
+	z->red = 1;
+	if (y == nullptr) {
 		root = z;
-	} else if (y == root || y->key > z->key) {
+	} else if (1 == y->key.cmp(z->key)) { /* y.key > z.key */
 		y->left = z;
 	} else {
 		y->right = z;
@@ -335,21 +322,16 @@ RedBlackTree::RedBlackTree_node * RedBlackTree::insertWithPathCompression(
 
 void RedBlackTree::_insertFix(RedBlackTree_node * t) {
 	RedBlackTree_node *u;
-	if (root == t) {
-		t->red = 0;
-		return;
-	}
+	// t is red, its parent is red only if it is not the root
 	while (t->parent != nullptr && t->parent->red) {
 		auto g = t->parent->parent;
 		if (g->left == t->parent) {
-			if (g->right != NULL) {
-				u = g->right;
-				if (u->red) {
-					t->parent->red = 0;
-					u->red = 0;
-					g->red = 1;
-					t = g;
-				}
+			u = g->right;
+			if (u != nullptr && u->red) {
+				t->parent->red = 0;
+				u->red = 0;
+				g->red = 1;
+				t = g;
 			} else {
 				if (t->parent->right == t) {
 					t = t->parent;
@@ -360,14 +342,12 @@ void RedBlackTree::_insertFix(RedBlackTree_node * t) {
 				rotateRight(g);
 			}
 		} else {
-			if (g->left != NULL) {
-				u = g->left;
-				if (u->red) {
-					t->parent->red = 0;
-					u->red = 0;
-					g->red = 1;
-					t = g;
-				}
+			u = g->left;
+			if (u != nullptr && u->red) {
+				t->parent->red = 0;
+				u->red = 0;
+				g->red = 1;
+				t = g;
 			} else {
 				if (t->parent->left == t) {
 					t = t->parent;
@@ -378,8 +358,8 @@ void RedBlackTree::_insertFix(RedBlackTree_node * t) {
 				rotateLeft(g);
 			}
 		}
-		root->red = 0;
 	}
+	root->red = 0;
 }
 
 RedBlackTree::RedBlackTree_node * RedBlackTree::insert(
@@ -431,15 +411,16 @@ bool RedBlackTree::insert_and_check_if_exists(RedBlackTree_node* z,
 			return true;
 		} else { /* x.key || z.key */
 			std::cout << "x:" << x->key << ", z:" << z->key << std::endl;
-			printf("Warning TreeInsertHelp : x.key || z.key\n");
+			throw std::runtime_error("TreeInsertHelp: overlapping keys");
 		}
 	}
 	z->parent = y;
-	if ((y == root) || (1 == y->key.cmp(z->key))) { /* y.key > z.key */
-		if (root == nullptr)
-			root = z;
-		else
-			y->left = z;
+	z->red = 1;
+	z->rb_tree_next_level = nullptr;
+	if (y == nullptr) {
+		root = z;
+	} else if (1 == y->key.cmp(z->key)) { /* y.key > z.key */
+		y->left = z;
 	} else {
 		y->right = z;
 	}
@@ -548,10 +529,13 @@ int RedBlackTree::exactQuery(const Packet& q, size_t level,
 
 int RedBlackTree::exactQueryIterative(const Packet& q, FieldOrder_t fieldOrder,
 		size_t level) {
+	MEMORY_ACCESS_TRACE(this, sizeof(RedBlackTree));
 	//check if singleton
 	if (level == fieldOrder.size()) {
 		return getMaxPriority(); // default rule
 	} else if (count == 1) { // use chain boxes
+		MEMORY_ACCESS_TRACE(chain_boxes.data(),
+				(fieldOrder.size() - level) * sizeof(Range1d));
 		//  auto chain_boxes = tree->chain_boxes;
 		for (size_t i = level; i < fieldOrder.size(); i++) {
 			if (q[fieldOrder[i]] < chain_boxes[i - level].low)
@@ -567,6 +551,7 @@ int RedBlackTree::exactQueryIterative(const Packet& q, FieldOrder_t fieldOrder,
 	if (x == nullptr)
 		return -1;
 
+	MEMORY_ACCESS_TRACE(x, sizeof(RedBlackTree_node));
 	int compVal = CompareQuery(x->key, q, level, fieldOrder);
 	// printf("Compval = %d\n", compVal);
 	while (0 != compVal) {/*assignemnt*/
@@ -577,6 +562,7 @@ int RedBlackTree::exactQueryIterative(const Packet& q, FieldOrder_t fieldOrder,
 		}
 		if (x == nullptr)
 			return -1;
+		MEMORY_ACCESS_TRACE(x, sizeof(RedBlackTree_node));
 		compVal = CompareQuery(x->key, q, level, fieldOrder);
 	}
 	// after the leaf of RedBlack tree on current level is fund use it to search further
@@ -625,61 +611,67 @@ int RedBlackTree::exactQueryPriority(const Packet& q, size_t level,
 			priority_so_far);
 }
 
-void RedBlackTree::deleteFixUp(RedBlackTree_node* p) {
+void RedBlackTree::deleteFixUp(RedBlackTree_node* p,
+		RedBlackTree_node* p_parent) {
+	auto isRed = [](RedBlackTree_node* n) {
+		return n != nullptr && n->red;
+	};
 	RedBlackTree_node *s;
-	while (p != root && !p->red) {
-		if (p->parent->left == p) {
-			s = p->parent->right;
+	while (p != root && !isRed(p)) {
+		if (p_parent->left == p) {
+			s = p_parent->right;
 			if (s->red) {
 				s->red = 0;
-				p->parent->red = 1;
-				rotateLeft(p->parent);
-				s = p->parent->right;
+				p_parent->red = 1;
+				rotateLeft(p_parent);
+				s = p_parent->right;
 			}
-			if (!s->right->red && !s->left->red) {
+			if (!isRed(s->right) && !isRed(s->left)) {
 				s->red = 1;
-				p = p->parent;
+				p = p_parent;
+				p_parent = p->parent;
 			} else {
-				if (!s->right->red) {
+				if (!isRed(s->right)) {
 					s->red = 1;
 					s->left->red = 0;
 					rotateRight(s);
-					s = p->parent->right;
+					s = p_parent->right;
 				}
-				s->red = p->parent->red;
-				p->parent->red = 0;
+				s->red = p_parent->red;
+				p_parent->red = 0;
 				s->right->red = 0;
-				rotateLeft(p->parent);
+				rotateLeft(p_parent);
 				p = root;
 			}
 		} else {
-			s = p->parent->left;
+			s = p_parent->left;
 			if (s->red) {
 				s->red = 0;
-				p->parent->red = 1;
-				rotateRight(p->parent);
-				s = p->parent->left;
+				p_parent->red = 1;
+				rotateRight(p_parent);
+				s = p_parent->left;
 			}
-			if (!s->left->red && !s->right->red) {
+			if (!isRed(s->left) && !isRed(s->right)) {
 				s->red = 1;
-				p = p->parent;
+				p = p_parent;
+				p_parent = p->parent;
 			} else {
-				if (!s->left->red) {
+				if (!isRed(s->left)) {
 					s->right->red = 0;
 					s->red = 1;
 					rotateLeft(s);
-					s = p->parent->left;
+					s = p_parent->left;
 				}
-				s->red = p->parent->red;
-				p->parent->red = 0;
+				s->red = p_parent->red;
+				p_parent->red = 0;
 				s->left->red = 0;
-				rotateRight(p->parent);
+				rotateRight(p_parent);
 				p = root;
 			}
 		}
-		p->red = 0;
-		root->red = 0;
 	}
+	if (p)
+		p->red = 0;
 }
 
 void ClearStack(
@@ -805,50 +797,59 @@ void RedBlackTree::deleteWithPathCompression(RedBlackTree*& tree,
 			std::string("Error RBTreeDeleteWithPathCompression: can't find a node at level ") + std::to_string(level));
 }
 
+void RedBlackTree::transplant(RedBlackTree_node* u, RedBlackTree_node* v) {
+	if (u->parent == nullptr)
+		root = v;
+	else if (u == u->parent->left)
+		u->parent->left = v;
+	else
+		u->parent->right = v;
+	if (v)
+		v->parent = u->parent;
+}
+
 void RedBlackTree::deleteNode(RedBlackTree_node* z) {
-	RedBlackTree_node* y;
 	RedBlackTree_node* x;
-	RedBlackTree_node* root = this->root;
-
-	y = ((z->left == nullptr) || (z->right == nullptr)) ? z : getSuccessor(z);
-	x = (y->left == nullptr) ? y->right : y->left;
-	if (root == (x->parent = y->parent)) { /* assignment of y->p to x->p is intentional */
-		root->left = x;
+	RedBlackTree_node* x_parent;
+	bool removed_red = z->red;
+
+	if (z->left == nullptr) {
+		x = z->right;
+		x_parent = z->parent;
+		transplant(z, z->right);
+	} else if (z->right == nullptr) {
+		x = z->left;
+		x_parent = z->parent;
+		transplant(z, z->left);
 	} else {
-		if (y == y->parent->left) {
-			y->parent->left = x;
+		/* y (the minimum of the right subtree) takes the place of z */
+		RedBlackTree_node* y = z->right;
+		while (y->left)
+			y = y->left;
+		removed_red = y->red;
+		x = y->right;
+		if (y->parent == z) {
+			x_parent = y;
 		} else {
-			y->parent->right = x;
+			x_parent = y->parent;
+			transplant(y, y->right);
+			y->right = z->right;
+			y->right->parent = y;
 		}
-	}
-	if (y != z) { /* y should not be nil in this case */
-		/* y is the node to splice out and x is its child */
-
-		if (!(y->red))
-			deleteFixUp(x);
-
+		transplant(z, y);
 		y->left = z->left;
-		y->right = z->right;
-		y->parent = z->parent;
+		y->left->parent = y;
 		y->red = z->red;
-		z->left->parent = z->right->parent = y;
-		if (z == z->parent->left) {
-			z->parent->left = y;
-		} else {
-			z->parent->right = y;
-		}
-		delete z;
-	} else {
-		if (!(y->red))
-			deleteFixUp(x);
-		delete y;
 	}
+	delete z;
+	if (!removed_red)
+		deleteFixUp(x, x_parent);
 }
 
 std::stack<RedBlackTree::RedBlackTree_node*> * RedBlackTree::RBEnumerate(
 		const Range1d& low, const Range1d& high) {
 	auto enumResultStack = new std::stack<RedBlackTree_node*>();
-	RedBlackTree_node* x = this->root->left;
+	RedBlackTree_node* x = this->root;
 	RedBlackTree_node* lastBest = nullptr;
 
 	while (x) {
@@ -918,7 +919,7 @@ void RedBlackTree::serializeIntoRulesRecursion(RedBlackTree_node * node,
 std::vector<Rule> RedBlackTree::serializeIntoRules(FieldOrder_t fieldOrder) {
 	std::vector<Range1d> boxes_so_far;
 	std::vector<Rule> rules_so_far;
-	serializeIntoRulesRecursion(this->root->left, 0, fieldOrder, boxes_so_far,
+	serializeIntoRulesRecursion(this->root, 0, fieldOrder, boxes_so_far,
 			rules_so_far);
 	return rules_so_far;
 }
@@ -963,7 +964,7 @@ int RedBlackTree::calculateMemoryConsumptionRecursion(RedBlackTree_node * node,
 	int memory_usage = 0;
 	auto tree = node->rb_tree_next_level;
 
-	memory_usage += tree->calculateMemoryConsumptionRecursion(tree->root->left,
+	memory_usage += tree->calculateMemoryConsumptionRecursion(tree->root,
 			level + 1, fieldOrder);
 	memory_usage += calculateMemoryConsumptionRecursion(node->left, level,
 			fieldOrder);
@@ -993,5 +994,5 @@ int RedBlackTree::calculateMemoryConsumptionRecursion(RedBlackTree_node * node,
 }
 
 int RedBlackTree::calculateMemoryConsumption(FieldOrder_t fieldOrder) {
-	return calculateMemoryConsumptionRecursion(this->root->left, 0, fieldOrder);
+	return calculateMemoryConsumptionRecursion(this->root, 0, fieldOrder);
 }
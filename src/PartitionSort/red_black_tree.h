@@ -28,12 +28,8 @@ public:
 		RedBlackTree_node* parent;
 	};
 
-	/*  A sentinel is used for root and for nil.  These sentinels are */
-	/*  created when RBTreeCreate is caled.  root->left should always */
-	/*  point to the node which is the root of the tree.  nil points to a */
-	/*  node which should always be black but has aribtrary children and */
-	/*  parent and no key or info.  The point of using these sentinels is so */
-	/*  that the root and nil nodes do not require special cases in the code */
+	/*  root of the tree (nullptr if the tree is empty or the rules are */
+	/*  stored in chain_boxes), the leaves are nullptr */
 	RedBlackTree_node* root;
 
 	int count = 0;
@@ -264,8 +260,14 @@ private:
 	/*    Modifies Input: tree, x */
 	/**/
 	/*    The algorithm from this function is from _Introduction_To_Algorithms_ */
+	/*    (x may be a nullptr leaf, its parent is passed in x_parent) */
 	/***********************************************************************/
-	void deleteFixUp(RedBlackTree_node* x);
+	void deleteFixUp(RedBlackTree_node* x, RedBlackTree_node* x_parent);
+
+	/*
+	 * Replaces the subtree of u by the subtree of v (v may be nullptr)
+	 * */
+	void transplant(RedBlackTree_node* u, RedBlackTree_node* v);
 
 	/***********************************************************************/
 	/*  INPUTS:  This takes a tree so that it can access the appropriate */
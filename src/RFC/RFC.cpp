@@ -0,0 +1,290 @@
+#include "RFC.h"
+
+#include <boost/functional/hash.hpp>
+#include <cerrno>
+#include <functional>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace std;
+
+const string RFC::DEFAULT_TREE = "0.1,2.3,4.5.6/0.1.2";
+
+// the tables larger than this are not built
+static constexpr size_t MAX_TABLE_ENTRIES = size_t(1) << 30;
+
+void RFCTable::Build(const vector<uint32_t> &entries, bool compress) {
+	this->entries = entries.size();
+	compressed = compress;
+	blocks.clear();
+	if (!compress) {
+		values = entries;
+		return;
+	}
+	values.clear();
+	for (size_t i = 0; i < entries.size(); i++) {
+		if (i % BLOCK_SIZE == 0)
+			blocks.push_back( { 0, uint32_t(values.size()) });
+		// the first entry of each block starts a run so the block can be
+		// decoded without the previous blocks
+		if (i % BLOCK_SIZE == 0 || entries[i] != entries[i - 1]) {
+			blocks.back().runs |= 1ull << (i % BLOCK_SIZE);
+			values.push_back(entries[i]);
+		}
+	}
+	values.shrink_to_fit();
+}
+
+RFC::RFC(const string &tree, bool compress) :
+		compress(compress) {
+	chunks = { { FieldSA, 16, 0xFFFF }, { FieldSA, 0, 0xFFFF }, { FieldDA, 16,
+			0xFFFF }, { FieldDA, 0, 0xFFFF }, { FieldSP, 0, 0xFFFF }, { FieldDP,
+			0, 0xFFFF }, { FieldProto, 0, 0xFF } };
+	ParseTree(tree);
+}
+
+void RFC::ParseTree(const string &tree) {
+	phases.clear();
+	phases.push_back(Phase(chunks.size()));
+	vector<string> phase_tokens;
+	Split(tree, '/', phase_tokens);
+	for (const string &p : phase_tokens) {
+		size_t inputs = phases.back().size();
+		vector<bool> used(inputs, false);
+		Phase phase;
+		vector<string> group_tokens;
+		Split(p, ',', group_tokens);
+		for (const string &g : group_tokens) {
+			Group group;
+			vector<string> member_tokens;
+			Split(g, '.', member_tokens);
+			for (const string &m : member_tokens) {
+				size_t i = stoul(m);
+				if (i >= inputs || used[i])
+					throw runtime_error(
+							"RFC.Tree: invalid or duplicate input " + m
+									+ " in phase \"" + p + "\"");
+				used[i] = true;
+				group.members.push_back(i);
+			}
+			phase.push_back(move(group));
+		}
+		if (find(used.begin(), used.end(), false) != used.end())
+			throw runtime_error(
+					"RFC.Tree: unused output of the previous phase in \"" + p
+							+ "\"");
+		if (phase.size() > MAX_GROUPS)
+			throw runtime_error("RFC.Tree: too many groups in \"" + p + "\"");
+		phases.push_back(move(phase));
+	}
+	if (phases.size() < 2 || phases.back().size() != 1)
+		throw runtime_error("RFC.Tree: the last phase has to have a single group");
+}
+
+/**
+ * Range of the chunk values of the rule, false if the range can not be split
+ * in to the chunks (it is not a prefix)
+ */
+static bool ChunkRange(const Range1d &r, int shift, Point1d mask,
+		Range1d &chunk_range) {
+	int width = __builtin_popcount(mask);
+	Point1d low = (r.low >> shift) & mask;
+	Point1d high = (r.high >> shift) & mask;
+	if ((uint64_t(r.low) >> (shift + width))
+			== (uint64_t(r.high) >> (shift + width))) {
+		chunk_range = {low, high};
+		return true;
+	}
+	// the higher chunks differ, the range has to contain all values of this chunk
+	chunk_range = {0, mask};
+	return low == 0 && high == mask;
+}
+
+typedef unordered_map<vector<uint64_t>, uint32_t, boost::hash<vector<uint64_t>>> ClassIndex;
+
+static uint32_t ClassOf(const vector<uint64_t> &bitmap, ClassIndex &index,
+		vector<vector<uint64_t>> &classes) {
+	auto c = index.find(bitmap);
+	if (c != index.end())
+		return c->second;
+	uint32_t id = classes.size();
+	index[bitmap] = id;
+	classes.push_back(bitmap);
+	return id;
+}
+
+void RFC::BuildChunk(const Chunk &chunk, Group &g,
+		vector<ClassBitmap> &classes) {
+	size_t words = (rules.size() + 63) / 64;
+	vector<Range1d> ranges;
+	set<uint64_t> starts = { 0 };
+	for (const Rule &r : rules) {
+		ranges.emplace_back();
+		ChunkRange(r.range[chunk.field], chunk.shift, chunk.mask, ranges.back());
+		starts.insert(ranges.back().low);
+		starts.insert(uint64_t(ranges.back().high) + 1);
+	}
+	starts.insert(uint64_t(chunk.mask) + 1);
+
+	vector<uint32_t> entries(size_t(chunk.mask) + 1);
+	ClassIndex index;
+	// the elementary intervals between the starts have the same set of rules
+	for (auto s = starts.begin(); *s <= chunk.mask; s++) {
+		ClassBitmap bitmap(words, 0);
+		for (size_t i = 0; i < rules.size(); i++) {
+			if (ranges[i].contains(*s))
+				bitmap[i / 64] |= 1ull << (i % 64);
+		}
+		uint32_t id = ClassOf(bitmap, index, classes);
+		fill(entries.begin() + *s, entries.begin() + *next(s), id);
+	}
+	g.table.Build(entries, compress);
+	g.classes = classes.size();
+}
+
+void RFC::BuildGroup(const vector<vector<ClassBitmap>> &inputs,
+		const vector<uint32_t> &input_classes, Group &g,
+		vector<ClassBitmap> &classes, bool last) {
+	size_t size = 1;
+	for (int m : g.members) {
+		size *= input_classes[m];
+		if (size > MAX_TABLE_ENTRIES)
+			throw runtime_error("RFC: the phase table is too large, use different RFC.Tree");
+	}
+	size_t words = (rules.size() + 63) / 64;
+	vector<uint32_t> entries;
+	entries.reserve(size);
+	ClassIndex index;
+	// bitmaps of the cross-product of the first i members
+	vector<ClassBitmap> partial(g.members.size(), ClassBitmap(words));
+
+	function<void(size_t)> cross_product = [&](size_t level) {
+		int m = g.members[level];
+		for (uint32_t c = 0; c < input_classes[m]; c++) {
+			const ClassBitmap &b = inputs[m][c];
+			for (size_t w = 0; w < words; w++)
+				partial[level][w] = level ? partial[level - 1][w] & b[w] : b[w];
+			if (level + 1 < g.members.size()) {
+				cross_product(level + 1);
+			} else if (last) {
+				// the highest priority rule (priority + 1, 0 if there is no rule)
+				uint32_t res = 0;
+				for (size_t w = 0; w < words; w++) {
+					if (partial[level][w]) {
+						size_t i = w * 64 + __builtin_ctzll(partial[level][w]);
+						res = rules[i].priority + 1;
+						break;
+					}
+				}
+				entries.push_back(res);
+			} else {
+				entries.push_back(ClassOf(partial[level], index, classes));
+			}
+		}
+	};
+	cross_product(0);
+	g.table.Build(entries, compress);
+	g.classes = last ? 0 : classes.size();
+}
+
+void RFC::_ConstructClassifier(const vector<Rule> &rules) {
+	// the chunks cover only the IPv4 5-tuple
+	for (const Rule &r : rules) {
+		if (r.dim != 5) {
+			printf("RFC supports only the IPv4 5-tuple rules (rule %d has %d dimensions)\n",
+					r.priority, r.dim);
+			exit(EINVAL);
+		}
+		for (const Chunk &c : chunks) {
+			Range1d range;
+			if (!ChunkRange(r.range[c.field], c.shift, c.mask, range)) {
+				printf("RFC supports only the prefix addresses (rule %d has %s)\n",
+						r.priority, string(r.range[c.field]).c_str());
+				exit(EINVAL);
+			}
+		}
+	}
+
+	this->rules = rules;
+	sort(this->rules.begin(), this->rules.end(),
+			[](const Rule &r0, const Rule &r1) {
+				return r0.priority > r1.priority;
+			});
+
+	vector<vector<ClassBitmap>> prev(chunks.size());
+	for (size_t c = 0; c < chunks.size(); c++)
+		BuildChunk(chunks[c], phases[0][c], prev[c]);
+
+	for (size_t p = 1; p < phases.size(); p++) {
+		vector<uint32_t> input_classes;
+		for (const Group &g : phases[p - 1])
+			input_classes.push_back(g.classes);
+		vector<vector<ClassBitmap>> cur(phases[p].size());
+		for (size_t g = 0; g < phases[p].size(); g++)
+			BuildGroup(prev, input_classes, phases[p][g], cur[g],
+					p == phases.size() - 1);
+		prev.swap(cur);
+	}
+}
+
+int RFC::ClassifyAPacket(const Packet &packet) {
+	array<uint32_t, MAX_GROUPS> prev, cur;
+	const Phase &chunk_tables = phases[0];
+	for (size_t c = 0; c < chunks.size(); c++) {
+		const Chunk &ch = chunks[c];
+		prev[c] = chunk_tables[c].table[(packet[ch.field] >> ch.shift) & ch.mask];
+	}
+	for (size_t p = 1; p < phases.size(); p++) {
+		const Phase &inputs = phases[p - 1];
+		const Phase &phase = phases[p];
+		for (size_t g = 0; g < phase.size(); g++) {
+			size_t index = 0;
+			for (int m : phase[g].members)
+				index = index * inputs[m].classes + prev[m];
+			cur[g] = phase[g].table[index];
+		}
+		prev = cur;
+	}
+	return int(prev[0]) - 1;
+}
+
+Memory RFC::MemSizeBytes() const {
+	size_t size = 0;
+	for (const Phase &p : phases) {
+		for (const Group &g : p)
+			size += g.table.MemSizeBytes();
+	}
+	return size;
+}
+
+int RFC::MemoryAccess() const {
+	int tables = 0;
+	for (const Phase &p : phases)
+		tables += p.size();
+	return tables * (compress ? 2 : 1);
+}
+
+void RFC::CollectStats(map<string, string> &summary) const {
+	stringstream bytes, entries, classes;
+	for (size_t p = 0; p < phases.size(); p++) {
+		size_t b = 0, e = 0, c = 0;
+		for (const Group &g : phases[p]) {
+			b += g.table.MemSizeBytes();
+			e += g.table.Entries();
+			c += g.classes;
+		}
+		if (p != 0) {
+			bytes << "-";
+			entries << "-";
+			classes << "-";
+		}
+		bytes << b;
+		entries << e;
+		classes << c;
+	}
+	summary["RFC.PhaseBytes"] = bytes.str();
+	summary["RFC.PhaseEntries"] = entries.str();
+	// equivalence classes of all groups in phase (0 for the last phase)
+	summary["RFC.PhaseClasses"] = classes.str();
+}
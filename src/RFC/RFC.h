@@ -0,0 +1,136 @@
+#pragma once
+
+#include "../Simulation.h"
+
+#include <array>
+
+/**
+ * Table of the equivalence class IDs indexed by the value of chunk
+ * or by the combination of the class IDs from previous phase
+ *
+ * The compressed table stores only the first value of each run of the same
+ * values. The index is split into blocks of 64 entries, each block has
+ * a bitmap of the run starts and the index of its first run, so the lookup
+ * takes constant 2 memory accesses.
+ */
+class RFCTable {
+public:
+	void Build(const std::vector<uint32_t> &entries, bool compress);
+
+	inline uint32_t operator[](size_t i) const {
+		if (!compressed) {
+			MEMORY_ACCESS_TRACE(&values[i], sizeof(uint32_t));
+			return values[i];
+		}
+		const Block &b = blocks[i / BLOCK_SIZE];
+		MEMORY_ACCESS_TRACE(&b, sizeof(Block));
+		// run starts up to the i-th entry (the first entry of block is always set)
+		uint64_t runs = b.runs & (~0ull >> (BLOCK_SIZE - 1 - i % BLOCK_SIZE));
+		const uint32_t &v = values[b.base + __builtin_popcountll(runs) - 1];
+		MEMORY_ACCESS_TRACE(&v, sizeof(uint32_t));
+		return v;
+	}
+	size_t Entries() const {
+		return entries;
+	}
+	size_t MemSizeBytes() const {
+		return values.size() * sizeof(uint32_t) + blocks.size() * sizeof(Block);
+	}
+
+private:
+	static constexpr size_t BLOCK_SIZE = 64;
+	struct Block {
+		uint64_t runs;
+		uint32_t base;
+	};
+	bool compressed = false;
+	size_t entries = 0;
+	std::vector<uint32_t> values;
+	std::vector<Block> blocks;
+};
+
+/**
+ * Recursive Flow Classification (Gupta, McKeown, SIGCOMM 1999)
+ *
+ * Phase 0 maps each chunk of the packet header (16b halves of the addresses,
+ * ports and 8b protocol) to the equivalence class of the chunk value
+ * (values matched by the same set of rules). Each following phase combines
+ * groups of the class IDs from the previous phase in to the class ID of their
+ * cross-product, the single table of the last phase contains the result.
+ *
+ * The reduction tree is specified by "RFC.Tree" as phases separated by '/',
+ * groups of the phase separated by ',' and indices of the outputs
+ * of the previous phase in the group separated by '.'. The phase 0 outputs are
+ * the chunks 0: SA[31:16], 1: SA[15:0], 2: DA[31:16], 3: DA[15:0], 4: SP,
+ * 5: DP, 6: Proto. The default "0.1,2.3,4.5.6/0.1.2" has 3 phases.
+ * "RFC.Compress=0" disables the compression of tables.
+ *
+ * The rules have to be IPv4 5-tuples and the address ranges have to be
+ * prefixes (the range in 32b field has to be a cross-product of the ranges
+ * of its chunks), the construction exits with an error otherwise.
+ */
+class RFC: public PacketClassifier {
+public:
+	RFC(const std::string &tree = DEFAULT_TREE, bool compress = true);
+	RFC(const std::unordered_map<std::string, std::string> &args) :
+			RFC(GetOrElse(args, "RFC.Tree", DEFAULT_TREE),
+					GetBoolOrElse(args, "RFC.Compress", true)) {
+	}
+
+	virtual void _ConstructClassifier(const std::vector<Rule> &rules);
+	virtual int ClassifyAPacket(const Packet &packet);
+	virtual void _DeleteRule(size_t) {
+		printf("Deletion not supported\n");
+	}
+	virtual void _InsertRule(const Rule&) {
+		printf("Insertion not supported\n");
+	}
+	virtual Memory MemSizeBytes() const;
+	// the number of memory accesses is the same for all packets
+	virtual int MemoryAccess() const;
+	virtual bool SupportsMemoryAccessTrace() const {
+		return true;
+	}
+	virtual size_t NumTables() const {
+		return 1;
+	}
+	virtual size_t RulesInTable(size_t) const {
+		return rules.size();
+	}
+	virtual void CollectStats(std::map<std::string, std::string> &summary) const;
+
+	static const std::string DEFAULT_TREE;
+
+private:
+	static constexpr size_t MAX_GROUPS = 8;
+	// set of rules as a bitmap (bit i = i-th rule ordered by priority)
+	typedef std::vector<uint64_t> ClassBitmap;
+
+	struct Chunk {
+		int field;
+		int shift;
+		Point1d mask;
+	};
+	struct Group {
+		// indices of the outputs of previous phase
+		std::vector<int> members;
+		RFCTable table;
+		// number of equivalence classes (output values)
+		uint32_t classes;
+	};
+	typedef std::vector<Group> Phase;
+
+	void ParseTree(const std::string &tree);
+	void BuildChunk(const Chunk &chunk, Group &g,
+			std::vector<ClassBitmap> &classes);
+	void BuildGroup(const std::vector<std::vector<ClassBitmap>> &inputs,
+			const std::vector<uint32_t> &input_classes, Group &g,
+			std::vector<ClassBitmap> &classes, bool last);
+
+	std::vector<Chunk> chunks;
+	bool compress;
+	// phases[0] are the chunk tables
+	std::vector<Phase> phases;
+	// rules ordered by priority
+	std::vector<Rule> rules;
+};
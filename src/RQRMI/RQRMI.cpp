@@ -0,0 +1,236 @@
+#include "RQRMI.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+
+RQRMIClassifier::RQRMIClassifier(unique_ptr<PacketClassifier> remainder,
+		size_t max_isets, double min_coverage, size_t submodels) :
+		max_isets(max_isets), min_coverage(min_coverage), submodels(
+				submodels), dim(5), remainder(move(remainder)), remainder_constructed(
+				false) {
+}
+
+/**
+ * The largest set of the rules with non-overlapping ranges in the field
+ * (interval scheduling, the ranges are taken in the order of their high end)
+ */
+static vector<size_t> IndependentSet(const vector<Rule> &rules,
+		vector<size_t> candidates, int field) {
+	sort(candidates.begin(), candidates.end(), [&](size_t a, size_t b) {
+		return rules[a].range[field].high < rules[b].range[field].high;
+	});
+	vector<size_t> res;
+	int64_t last_high = -1;
+	for (size_t i : candidates) {
+		const Range1d &r = rules[i].range[field];
+		if (int64_t(r.low) > last_high) {
+			res.push_back(i);
+			last_high = r.high;
+		}
+	}
+	return res;
+}
+
+void RQRMIClassifier::BuildISet(int field, const vector<size_t> &members) {
+	isets.emplace_back();
+	ISet &s = isets.back();
+	s.field = field;
+	s.live = members.size();
+	vector<Point1d> lows;
+	// the members are sorted by the high end, the ranges do not overlap
+	for (size_t i : members) {
+		const Rule &r = rules[i];
+		locations[i] = {int(isets.size() - 1), s.priorities.size()};
+		lows.push_back(r.range[field].low);
+		s.priorities.push_back(r.priority);
+		s.ranges.insert(s.ranges.end(), r.range.begin(), r.range.end());
+	}
+	s.model.Train(lows, submodels);
+}
+
+void RQRMIClassifier::_ConstructClassifier(const vector<Rule> &rules) {
+	this->rules = rules;
+	locations.assign(rules.size(), { REMAINDER, 0 });
+	vector<size_t> remaining(rules.size());
+	for (size_t i = 0; i < rules.size(); i++)
+		remaining[i] = i;
+
+	if (rules.size())
+		dim = rules[0].dim;
+	while (isets.size() < max_isets && !remaining.empty()) {
+		vector<size_t> best;
+		int best_field = 0;
+		for (int d = 0; d < dim; d++) {
+			vector<size_t> s = IndependentSet(this->rules, remaining, d);
+			if (s.size() > best.size()) {
+				best.swap(s);
+				best_field = d;
+			}
+		}
+		if (best.size() < min_coverage * rules.size())
+			break;
+		BuildISet(best_field, best);
+		vector<bool> taken(rules.size(), false);
+		for (size_t i : best)
+			taken[i] = true;
+		remaining.erase(remove_if(remaining.begin(), remaining.end(),
+				[&taken](size_t i) {
+					return taken[i];
+				}), remaining.end());
+	}
+
+	vector<Rule> residue;
+	for (size_t i : remaining) {
+		locations[i] = {REMAINDER, residue.size()};
+		remainder_rules.push_back(i);
+		remainder_priorities.Insert(rules[i].priority);
+		residue.push_back(rules[i]);
+	}
+	if (residue.size()) {
+		remainder->ConstructClassifier(residue);
+		remainder_constructed = true;
+	}
+}
+
+int RQRMIClassifier::ClassifyAPacket(const Packet &packet) {
+	int result = -1;
+	int query = 0;
+	for (const ISet &s : isets) {
+		Point1d key = packet[s.field];
+		int64_t i = s.model.Find(key);
+		query++;
+		if (i < 0)
+			continue;
+		MEMORY_ACCESS_TRACE(&s.priorities[i], sizeof(int));
+		if (s.priorities[i] <= result)
+			continue;
+		const Range1d *r = &s.ranges[i * dim];
+		MEMORY_ACCESS_TRACE(r, dim * sizeof(Range1d));
+		bool match = true;
+		for (int d = 0; d < dim && match; d++)
+			match = packet[d] >= r[d].low && packet[d] <= r[d].high;
+		if (match)
+			result = s.priorities[i];
+	}
+	if (remainder_priorities.Max() > result) {
+		result = max(result, remainder->ClassifyAPacket(packet));
+		query++;
+	}
+	QueryCountersUpdate(query);
+	return result;
+}
+
+void RQRMIClassifier::InsertRemainder(const Rule &rule, size_t index) {
+	if (remainder_constructed) {
+		remainder->InsertRule(rule);
+	} else {
+		remainder->ConstructClassifier( { rule });
+		remainder_constructed = true;
+	}
+	remainder_rules.push_back(index);
+	remainder_priorities.Insert(rule.priority);
+}
+
+void RQRMIClassifier::DeleteRemainder(size_t index) {
+	size_t ri = locations[index].pos;
+	remainder->DeleteRule(ri);
+	remainder_priorities.Erase(rules[index].priority);
+	// the remainder moves its last rule on the place of the removed one
+	size_t last = remainder_rules.size() - 1;
+	if (ri != last) {
+		remainder_rules[ri] = remainder_rules[last];
+		locations[remainder_rules[ri]].pos = ri;
+	}
+	remainder_rules.pop_back();
+}
+
+void RQRMIClassifier::_InsertRule(const Rule &rule) {
+	size_t index = rules.size();
+	locations.push_back( { REMAINDER, remainder_rules.size() });
+	rules.push_back(rule);
+	InsertRemainder(rule, index);
+}
+
+void RQRMIClassifier::_DeleteRule(size_t index) {
+	if (index >= rules.size()) {
+		printf("Warning index delete rule out of bound: do nothing here\n");
+		printf("%lu vs. size: %lu\n", index, rules.size());
+		return;
+	}
+	const Location &loc = locations[index];
+	if (loc.iset == REMAINDER) {
+		DeleteRemainder(index);
+	} else {
+		ISet &s = isets[loc.iset];
+		s.priorities[loc.pos] = -1;
+		s.live--;
+	}
+
+	size_t last = rules.size() - 1;
+	if (index != last) {
+		rules[index] = move(rules[last]);
+		locations[index] = locations[last];
+		if (locations[index].iset == REMAINDER)
+			remainder_rules[locations[index].pos] = index;
+	}
+	rules.pop_back();
+	locations.pop_back();
+}
+
+Memory RQRMIClassifier::MemSizeBytes() const {
+	Memory mem = 0;
+	for (const ISet &s : isets) {
+		mem += s.model.MemSizeBytes() + s.priorities.size() * sizeof(int)
+				+ s.ranges.size() * sizeof(Range1d);
+	}
+	if (remainder_constructed)
+		mem += remainder->MemSizeBytes();
+	return mem;
+}
+
+int RQRMIClassifier::MemoryAccess() const {
+	// submodel, search, priority and the ranges per iSet
+	return 4 * isets.size()
+			+ (remainder_constructed ? remainder->MemoryAccess() : 0);
+}
+
+size_t RQRMIClassifier::NumTables() const {
+	return isets.size() + (remainder_constructed ? remainder->NumTables() : 0);
+}
+
+size_t RQRMIClassifier::RulesInTable(size_t tableIndex) const {
+	if (tableIndex < isets.size())
+		return isets[tableIndex].live;
+	return remainder->RulesInTable(tableIndex - isets.size());
+}
+
+void RQRMIClassifier::CollectStats(map<string, string> &summary) const {
+	stringstream sizes, fields, errors;
+	size_t in_isets = 0, models = 0;
+	for (size_t i = 0; i < isets.size(); i++) {
+		const ISet &s = isets[i];
+		if (i) {
+			sizes << "-";
+			fields << "-";
+			errors << "-";
+		}
+		sizes << s.live;
+		fields << s.field;
+		errors << s.model.MaxError();
+		in_isets += s.live;
+		models += s.model.Submodels();
+	}
+	summary["RQRMI.ISets"] = to_string(isets.size());
+	summary["RQRMI.ISetSizes"] = sizes.str();
+	summary["RQRMI.ISetFields"] = fields.str();
+	// the largest secondary search window of each iSet
+	summary["RQRMI.MaxError"] = errors.str();
+	summary["RQRMI.Submodels"] = to_string(models);
+	summary["RQRMI.Coverage"] = to_string(
+			rules.size() ? double(in_isets) / rules.size() : 0.0);
+	summary["RQRMI.RemainderRules"] = to_string(remainder_rules.size());
+	if (remainder_constructed)
+		remainder->CollectStats(summary);
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../Simulation.h"
+#include "RQRMIModel.h"
+#include "../Utilities/PriorityTracker.h"
+
+#include <memory>
+
+/**
+ * Learned packet classifier (NuevoMatch, Rashelbach et al., SIGCOMM 2020)
+ *
+ * The rules are partitioned in to iSets, each iSet contains the rules with
+ * non-overlapping ranges in one field and it is indexed by RQRMIModel
+ * (the position of the only candidate rule is predicted from the packet field,
+ * the candidate is then validated against the ranges of the rule which are
+ * stored in the iSet). The iSets are
+ * selected greedily (the largest independent set of the remaining rules over
+ * all fields) until "RQRMI.MaxISets" iSets are created or the next iSet would
+ * contain less than "RQRMI.MinCoverage" of the rules. The rest of the rules
+ * (the remainder) is stored in the remainder classifier which is queried only
+ * if it contains a rule with higher priority than the iSet match (if any).
+ *
+ * The inserted rules are added to the remainder, the deleted iSet rules are
+ * only marked as deleted.
+ */
+class RQRMIClassifier: public PacketClassifier {
+public:
+	RQRMIClassifier(std::unique_ptr<PacketClassifier> remainder,
+			size_t max_isets = 4, double min_coverage = 0.05,
+			size_t submodels = 0);
+	RQRMIClassifier(std::unique_ptr<PacketClassifier> remainder,
+			const std::unordered_map<std::string, std::string> &args) :
+			RQRMIClassifier(std::move(remainder),
+					GetIntOrElse(args, "RQRMI.MaxISets", 4),
+					GetDoubleOrElse(args, "RQRMI.MinCoverage", 0.05),
+					GetIntOrElse(args, "RQRMI.Submodels", 0)) {
+	}
+
+	virtual void _ConstructClassifier(const std::vector<Rule> &rules);
+	virtual int ClassifyAPacket(const Packet &packet);
+	virtual void _DeleteRule(size_t index);
+	virtual void _InsertRule(const Rule &rule);
+	virtual Memory MemSizeBytes() const;
+	virtual int MemoryAccess() const;
+	virtual bool SupportsMemoryAccessTrace() const {
+		return remainder->SupportsMemoryAccessTrace();
+	}
+	virtual bool SupportsWideFields() const {
+		return remainder->SupportsWideFields();
+	}
+	virtual void CheckRule(const Rule &rule) const {
+		remainder->CheckRule(rule);
+	}
+	virtual size_t Maintain(size_t budget) {
+		return remainder_constructed ? remainder->Maintain(budget) : 0;
+	}
+	// iSets + tables of the remainder classifier
+	virtual size_t NumTables() const;
+	virtual size_t RulesInTable(size_t tableIndex) const;
+	virtual void CollectStats(std::map<std::string, std::string> &summary) const;
+
+private:
+	static constexpr int REMAINDER = -1;
+
+	struct ISet {
+		int field;
+		RQRMIModel model;
+		// sorted by the low end of the range in field (the lows are in model),
+		// -1 for deleted rules
+		std::vector<int> priorities;
+		// dim ranges per rule
+		std::vector<Range1d> ranges;
+		size_t live;
+	};
+	struct Location {
+		// index of the iSet or REMAINDER
+		int iset;
+		// index in the iSet or in the remainder classifier
+		size_t pos;
+	};
+	void BuildISet(int field, const std::vector<size_t> &members);
+	void InsertRemainder(const Rule &rule, size_t index);
+	void DeleteRemainder(size_t index);
+
+	size_t max_isets;
+	double min_coverage;
+	size_t submodels;
+	int dim;
+	std::vector<ISet> isets;
+
+	std::unique_ptr<PacketClassifier> remainder;
+	// the remainder is constructed with the first rule which is not in an iSet
+	bool remainder_constructed;
+	// index in remainder -> index in rules
+	std::vector<size_t> remainder_rules;
+	PriorityTracker remainder_priorities;
+
+	std::vector<Rule> rules;
+	std::vector<Location> locations;
+};
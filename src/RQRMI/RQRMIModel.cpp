@@ -0,0 +1,105 @@
+#include "RQRMIModel.h"
+
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * Least squares fit of y = slope * x + intercept, the slope is not negative
+ * (the trained functions are non-decreasing)
+ */
+static void FitLinear(const vector<pair<double, double>> &points,
+		double &slope, double &intercept) {
+	if (points.empty()) {
+		slope = intercept = 0;
+		return;
+	}
+	double mx = 0, my = 0;
+	for (auto &p : points) {
+		mx += p.first;
+		my += p.second;
+	}
+	mx /= points.size();
+	my /= points.size();
+	double sxx = 0, sxy = 0;
+	for (auto &p : points) {
+		sxx += (p.first - mx) * (p.first - mx);
+		sxy += (p.first - mx) * (p.second - my);
+	}
+	slope = sxx > 0 ? max(0.0, sxy / sxx) : 0;
+	intercept = my - slope * mx;
+}
+
+void RQRMIModel::Train(const vector<Point1d> &sorted, size_t submodel_cnt) {
+	keys.clear();
+	submodels.clear();
+	if (sorted.empty())
+		return;
+	size_t n = sorted.size();
+	for (Point1d k : sorted)
+		keys.push_back(Bias(k));
+	if (submodel_cnt == 0)
+		submodel_cnt = max<size_t>(1, n / DEFAULT_KEYS_PER_SUBMODEL);
+	submodels.resize(submodel_cnt);
+
+	// stage 1 distributes the keys uniformly among the submodels
+	vector<pair<double, double>> points;
+	for (size_t i = 0; i < n; i++)
+		points.push_back( { double(sorted[i]), double(i) * submodel_cnt / n });
+	FitLinear(points, slope, intercept);
+
+	// the domain of the submodel m is [start[m], start[m + 1])
+	const uint64_t END = uint64_t(1) << 32;
+	vector<uint64_t> start(submodel_cnt + 1, END);
+	start[0] = 0;
+	for (size_t m = 1; m < submodel_cnt; m++) {
+		uint64_t lo = start[m - 1], hi = END;
+		while (lo < hi) {
+			uint64_t mid = lo + (hi - lo) / 2;
+			if (Stage1(Point1d(mid)) >= m)
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+		start[m] = lo;
+	}
+
+	for (size_t m = 0; m < submodel_cnt; m++) {
+		Submodel &sm = submodels[m];
+		sm = {0, 0, 0, 0};
+		if (start[m] >= start[m + 1])
+			continue;
+		// the values [segment begin, end] have the same position i (the values
+		// lower than the first key are searched at the position 0)
+		size_t first = upper_bound(sorted.begin(), sorted.end(), start[m])
+				- sorted.begin();
+		size_t last = upper_bound(sorted.begin(), sorted.end(), start[m + 1] - 1)
+				- sorted.begin();
+		first = first ? first - 1 : 0;
+		last = last ? last - 1 : 0;
+		points.clear();
+		for (size_t i = first; i <= last; i++) {
+			uint64_t begin = max<uint64_t>(i ? sorted[i] : 0, start[m]);
+			uint64_t end = min<uint64_t>(i + 1 < n ? sorted[i + 1] : END,
+					start[m + 1]) - 1;
+			points.push_back( { double(begin), double(i) });
+			points.push_back( { double(end), double(i) });
+		}
+		FitLinear(points, sm.slope, sm.intercept);
+		for (auto &p : points) {
+			size_t predicted = Predict(sm, Point1d(p.first));
+			size_t position = size_t(p.second);
+			if (predicted > position)
+				sm.under = max<uint32_t>(sm.under, predicted - position);
+			else
+				sm.over = max<uint32_t>(sm.over, position - predicted);
+		}
+	}
+}
+
+size_t RQRMIModel::MaxError() const {
+	size_t err = 0;
+	for (const Submodel &m : submodels)
+		err = max<size_t>(err, m.under + m.over + 1);
+	return err;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "../ElementaryClasses.h"
+#include "../Utilities/MemoryAccessTrace.h"
+
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/**
+ * Learned index of sorted distinct keys (range-query recursive model index,
+ * Rashelbach et al., SIGCOMM 2020)
+ *
+ * The first stage is a linear model which selects the submodel, the second
+ * stage is a linear model per submodel which predicts the position of the last
+ * key <= the looked up value. The error of each submodel is computed exactly
+ * at the training: the prediction is monotone, so the largest error within
+ * a run of values with the same result is at its ends. The secondary search
+ * is a binary search down to SCAN_WINDOW entries and a scan (AVX2) of the rest.
+ */
+class RQRMIModel {
+public:
+	/**
+	 * @param keys sorted distinct keys
+	 * @param submodels number of submodels of the second stage (0 = auto)
+	 */
+	void Train(const std::vector<Point1d> &keys, size_t submodels = 0);
+
+	/**
+	 * @return index of the last key <= key, -1 if there is none
+	 */
+	inline int64_t Find(Point1d key) const {
+		if (keys.empty())
+			return -1;
+		const Submodel &m = submodels[Stage1(key)];
+		MEMORY_ACCESS_TRACE(&m, sizeof(Submodel));
+		size_t p = Predict(m, key);
+		size_t lo = p - std::min<size_t>(p, m.under);
+		size_t hi = std::min(keys.size() - 1, p + m.over);
+		// the keys are biased so that the signed comparison can be used
+		int32_t k = Bias(key);
+		while (hi - lo >= SCAN_WINDOW) {
+			size_t mid = lo + (hi - lo) / 2;
+			MEMORY_ACCESS_TRACE(&keys[mid], sizeof(int32_t));
+			if (keys[mid] <= k)
+				lo = mid;
+			else
+				hi = mid - 1;
+		}
+		MEMORY_ACCESS_TRACE(&keys[lo], (hi - lo + 1) * sizeof(int32_t));
+		// the keys are sorted, the number of keys <= key in the window gives
+		// the position (the keys after the window are > key)
+		size_t j = lo, count = 0;
+#ifdef __AVX2__
+		__m256i kv = _mm256_set1_epi32(k);
+		for (; j <= hi && j + 8 <= keys.size(); j += 8) {
+			__m256i v = _mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(&keys[j]));
+			uint32_t gt = _mm256_movemask_ps(
+					_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, kv)));
+			count += 8 - __builtin_popcount(gt);
+		}
+#endif
+		for (; j <= hi; j++)
+			count += keys[j] <= k;
+		return int64_t(lo + count) - 1;
+	}
+
+	size_t Size() const {
+		return keys.size();
+	}
+	size_t Submodels() const {
+		return submodels.size();
+	}
+	// the largest search window of the submodels
+	size_t MaxError() const;
+	size_t MemSizeBytes() const {
+		return keys.size() * sizeof(int32_t) + submodels.size() * sizeof(Submodel)
+				+ sizeof(RQRMIModel);
+	}
+
+	// the window which is searched without the binary search
+	static constexpr size_t SCAN_WINDOW = 32;
+	static constexpr size_t DEFAULT_KEYS_PER_SUBMODEL = 64;
+
+private:
+	struct Submodel {
+		double slope;
+		double intercept;
+		// max error of the prediction (prediction - position, position - prediction)
+		uint32_t under;
+		uint32_t over;
+	};
+
+	static inline int32_t Bias(Point1d key) {
+		return int32_t(key ^ 0x80000000u);
+	}
+	static inline size_t Clamp(double x, size_t size) {
+		if (!(x > 0))
+			return 0;
+		if (x >= double(size - 1))
+			return size - 1;
+		return size_t(x);
+	}
+	inline size_t Stage1(Point1d key) const {
+		return Clamp(slope * key + intercept, submodels.size());
+	}
+	inline size_t Predict(const Submodel &m, Point1d key) const {
+		return Clamp(m.slope * key + m.intercept, keys.size());
+	}
+
+	double slope = 0;
+	double intercept = 0;
+	std::vector<Submodel> submodels;
+	std::vector<int32_t> keys;
+};
@@ -1,6 +1,11 @@
 #include "Simulation.h"
+#include "Utilities/MemoryAccessTrace.h"
+#include <array>
+#include <cmath>
+#include <numeric>
 #include <string>
 #include <sstream>
+#include <unordered_set>
 
 std::vector<Request> PacketClassficationSimulator::GenerateRequests(
 		Random &rand, size_t num_packet, size_t num_insert,
@@ -136,10 +141,18 @@ PacketClassficationSimulator::time_t PacketClassficationSimulator::sumTime(
 void PacketClassficationSimulator::load_ruleset_into_classifier(
 		std::map<std::string, std::string> &summary) {
 	std::vector<std::future<time_t>> elapsed_time;
+	std::vector<PerfCounters::Values> perf(packet_classifiers.size());
+	std::vector<AllocationTracker::Stats> alloc(packet_classifiers.size());
 	// Submit a lambda object to the pool.
 	for (size_t i = 0; i < packet_classifiers.size(); i++) {
-		auto t = pool.enqueue([this, i]() {
-			return packet_classifiers[i]->ConstructClassifier(ruleset);
+		auto t = pool.enqueue([this, i, &perf, &alloc]() {
+			PerfCounters counters;
+			AllocationTracker::Scope alloc_scope(alloc[i]);
+			counters.Start();
+			auto t = packet_classifiers[i]->ConstructClassifier(ruleset);
+			counters.Stop();
+			perf[i] = counters.values();
+			return t;
 		});
 		elapsed_time.push_back(std::move(t));
 	}
@@ -148,23 +161,39 @@ void PacketClassficationSimulator::load_ruleset_into_classifier(
 	std::cout << "\tConstruction time: " << res.count() << " s" << std::endl;
 	summary["ConstructionTime(ms)"] = std::to_string(
 			std::chrono::duration_cast<std::chrono::milliseconds>(res).count());
+	for (size_t i = 1; i < perf.size(); i++)
+		perf[0].merge(perf[i]);
+	perf[0].Report(summary, "Perf.classifier_construction", 0);
+	if (AllocationTracker::enabled)
+		alloc[0].Report(summary, "Alloc");
 }
 
 PacketClassficationSimulator::time_t PacketClassficationSimulator::run_only_packet_classification(
 		const std::vector<Packet> &packets, PacketClassifier &classifier,
-		size_t trials, std::vector<int> *results) {
+		size_t trials, std::vector<int> *results, LatencyHistogram *latency,
+		size_t sample_period, PerfCounters::Values *perf) {
 
 	std::chrono::time_point<std::chrono::steady_clock> start, end;
 	time_t sum_time(0);
+	PerfCounters counters;
 
 	LIKWID_MARKER_START("classification");
+	counters.Start();
 	assert(trials > 0);
 	for (size_t t = 0; t < trials; t++) {
 		if (results)
 			results->clear();
+		LatencySampler sample(latency ? sample_period : 0);
 		start = std::chrono::steady_clock::now();
 		for (auto const &p : packets) {
-			auto r = classifier.ClassifyAPacket(p);
+			int r;
+			if (sample()) {
+				uint64_t t0 = LatencyHistogram::Start();
+				r = classifier.ClassifyAPacket(p);
+				latency->record(LatencyHistogram::Stop() - t0);
+			} else {
+				r = classifier.ClassifyAPacket(p);
+			}
 			if (results)
 				results->push_back(r);
 		}
@@ -172,7 +201,10 @@ PacketClassficationSimulator::time_t PacketClassficationSimulator::run_only_pack
 		time_t elapsed_seconds = end - start;
 		sum_time += elapsed_seconds;
 	}
+	counters.Stop();
 	LIKWID_MARKER_STOP("classification");
+	if (perf)
+		*perf = counters.values();
 	return sum_time;
 }
 
@@ -183,15 +215,20 @@ std::vector<int> PacketClassficationSimulator::ruhn_only_packet_classification(
 	load_ruleset_into_classifier(summary);
 	std::vector<int> results;
 	results.reserve(packets.size());
+	std::vector<LatencyHistogram> latency(packet_classifiers.size());
+	std::vector<PerfCounters::Values> perf(packet_classifiers.size());
 
 	// Submit a lambda object to the pool.
 	for (size_t i = 0; i < packet_classifiers.size(); i++) {
 		auto &cls = *packet_classifiers[i];
 		auto &_packets = packets;
+		auto sample_period = latency_sample_period;
 		auto t = pool.enqueue(
-				[&cls, &_packets, i, &results, trials]() {
+				[&cls, &_packets, i, &results, trials, &latency, &perf,
+						sample_period]() {
 					return run_only_packet_classification(_packets, cls, trials,
-							i == 0 ? &results : nullptr);
+							i == 0 ? &results : nullptr, &latency[i],
+							sample_period, &perf[i]);
 				});
 		elapsed_time.push_back(std::move(t));
 	}
@@ -203,7 +240,21 @@ std::vector<int> PacketClassficationSimulator::ruhn_only_packet_classification(
 	std::cout << "\tClassification time: " << sum_time.count() << " s"
 			<< std::endl;
 	summary["ClassificationTime(s)"] = std::to_string(sum_time.count());
+	for (size_t i = 1; i < latency.size(); i++)
+		latency[0].merge(latency[i]);
+	latency[0].Report(summary, "ClassifyLatency");
+	for (size_t i = 1; i < perf.size(); i++)
+		perf[0].merge(perf[i]);
+	perf[0].Report(summary, "Perf.classification",
+			trials * packets.size() * packet_classifiers.size());
+	collect_classifier_stats(summary, trials * packets.size());
 
+	return results;
+}
+
+void PacketClassficationSimulator::collect_classifier_stats(
+		std::map<std::string, std::string> &summary,
+		size_t packets_classified) {
 	PacketClassifier &classifier = *packet_classifiers[0];
 	int memSize = classifier.MemSizeBytes();
 	std::cout << "\tSize(bytes): " << memSize << std::endl;
@@ -229,32 +280,218 @@ std::vector<int> PacketClassficationSimulator::ruhn_only_packet_classification(
 
 	printf("\tTotal tables queried: %d\n", classifier.TablesQueried());
 	printf("\tAverage tables queried: %f\n",
-			1.0 * classifier.TablesQueried() / (trials * packets.size()));
+			1.0 * classifier.TablesQueried() / packets_classified);
 	summary["AvgQueries"] = std::to_string(
-			1.0 * classifier.TablesQueried() / (trials * packets.size()));
+			1.0 * classifier.TablesQueried() / packets_classified);
+	classifier.CollectStats(summary);
+}
 
-	return results;
+PacketClassficationSimulator::time_t PacketClassficationSimulator::run_streamed_packet_classification(
+		PacketSource &packets, PacketClassifier &classifier,
+		size_t &packet_cnt, LatencyHistogram *latency, size_t sample_period,
+		PerfCounters::Values *perf) {
+	std::chrono::time_point<std::chrono::steady_clock> start, end;
+	time_t sum_time(0);
+	std::vector<Packet> batch;
+	PerfCounters counters;
+
+	LIKWID_MARKER_START("classification");
+	counters.Start();
+	LatencySampler sample(latency ? sample_period : 0);
+	while (packets.NextBatch(batch)) {
+		start = std::chrono::steady_clock::now();
+		for (auto const &p : batch) {
+			if (sample()) {
+				uint64_t t0 = LatencyHistogram::Start();
+				classifier.ClassifyAPacket(p);
+				latency->record(LatencyHistogram::Stop() - t0);
+			} else {
+				classifier.ClassifyAPacket(p);
+			}
+		}
+		end = std::chrono::steady_clock::now();
+		sum_time += end - start;
+		packet_cnt += batch.size();
+	}
+	counters.Stop();
+	LIKWID_MARKER_STOP("classification");
+	if (perf)
+		perf->merge(counters.values());
+	return sum_time;
+}
+
+void PacketClassficationSimulator::ruhn_streamed_packet_classification(
+		std::map<std::string, std::string> &summary, size_t trials,
+		const std::function<std::unique_ptr<PacketSource>()> &make_source) {
+	assert(trials > 0);
+	std::vector<std::future<time_t>> elapsed_time;
+	load_ruleset_into_classifier(summary);
+	std::vector<size_t> packet_cnt(packet_classifiers.size(), 0);
+	std::vector<time_t> wait_time(packet_classifiers.size(), time_t(0));
+	std::vector<LatencyHistogram> latency(packet_classifiers.size());
+	std::vector<PerfCounters::Values> perf(packet_classifiers.size());
+
+	for (size_t i = 0; i < packet_classifiers.size(); i++) {
+		auto &cls = *packet_classifiers[i];
+		auto sample_period = latency_sample_period;
+		auto t = pool.enqueue(
+				[&cls, &make_source, &packet_cnt, &wait_time, &latency, &perf,
+						i, trials, sample_period]() {
+					time_t sum_time(0);
+					for (size_t t = 0; t < trials; t++) {
+						PrefetchingPacketSource packets(make_source());
+						sum_time += run_streamed_packet_classification(packets,
+								cls, packet_cnt[i], &latency[i], sample_period,
+								&perf[i]);
+						wait_time[i] += packets.WaitTime();
+					}
+					return sum_time;
+				});
+		elapsed_time.push_back(std::move(t));
+	}
+
+	auto sum_time = sumTime(elapsed_time);
+	sum_time /= trials;
+	size_t packets_per_trial = packet_cnt[0] / trials;
+	std::cout << "\tClassification time: " << sum_time.count() << " s ("
+			<< packets_per_trial << " packets)" << std::endl;
+	summary["ClassificationTime(s)"] = std::to_string(sum_time.count());
+	summary["Packets"] = std::to_string(packets_per_trial);
+	std::cout << "\tStream wait time: " << wait_time[0].count() / trials
+			<< " s" << std::endl;
+	summary["StreamWait(s)"] = std::to_string(wait_time[0].count() / trials);
+	for (size_t i = 1; i < latency.size(); i++)
+		latency[0].merge(latency[i]);
+	latency[0].Report(summary, "ClassifyLatency");
+	size_t packet_cnt_total = 0;
+	for (size_t i = 0; i < perf.size(); i++) {
+		packet_cnt_total += packet_cnt[i];
+		if (i)
+			perf[0].merge(perf[i]);
+	}
+	perf[0].Report(summary, "Perf.classification", packet_cnt_total);
+	collect_classifier_stats(summary, packet_cnt[0]);
+}
+
+void PacketClassficationSimulator::ruhn_memory_access_trace(
+		std::map<std::string, std::string> &summary, size_t packet_cnt) {
+	load_ruleset_into_classifier(summary);
+	PacketClassifier &classifier = *packet_classifiers[0];
+	if (packet_cnt == 0 || packet_cnt > packets.size())
+		packet_cnt = packets.size();
+
+	MemoryAccessTrace trace;
+	std::vector<size_t> lines;
+	lines.reserve(packet_cnt);
+	std::unordered_set<uintptr_t> working_set;
+	size_t touches = 0;
+	MemoryAccessTrace::active = &trace;
+	for (size_t i = 0; i < packet_cnt; i++) {
+		trace.Begin();
+		classifier.ClassifyAPacket(packets[i]);
+		lines.push_back(trace.End());
+		touches += trace.Touches();
+		working_set.insert(trace.Lines().begin(), trace.Lines().end());
+	}
+	MemoryAccessTrace::active = nullptr;
+	if (packet_cnt == 0)
+		return;
+
+	std::sort(lines.begin(), lines.end());
+	double avg = std::accumulate(lines.begin(), lines.end(), 0.0) / packet_cnt;
+	std::cout << "\tCache lines per packet: " << avg << " (max " << lines.back()
+			<< ")" << std::endl;
+	summary["CacheLines.avg"] = std::to_string(avg);
+	const std::pair<const char*, double> percentiles[] = { { "p50", 50 }, {
+			"p90", 90 }, { "p99", 99 } };
+	for (auto &p : percentiles) {
+		size_t rank = std::max<size_t>(1, std::ceil(p.second / 100 * packet_cnt));
+		summary[std::string("CacheLines.") + p.first] = std::to_string(
+				lines[rank - 1]);
+	}
+	summary["CacheLines.max"] = std::to_string(lines.back());
+	// "<lines>:<packets>" for each number of lines which was seen
+	std::stringstream histogram;
+	for (size_t i = 0; i < lines.size();) {
+		size_t j = i;
+		while (j < lines.size() && lines[j] == lines[i])
+			j++;
+		if (i != 0)
+			histogram << "-";
+		histogram << lines[i] << ":" << j - i;
+		i = j;
+	}
+	summary["CacheLines.Histogram"] = histogram.str();
+	summary["Touches.avg"] = std::to_string(1.0 * touches / packet_cnt);
+	size_t working_set_bytes = working_set.size()
+			* MemoryAccessTrace::CACHE_LINE_SIZE;
+	std::cout << "\tWorking set: " << working_set_bytes << " bytes"
+			<< std::endl;
+	summary["WorkingSet(bytes)"] = std::to_string(working_set_bytes);
+	collect_classifier_stats(summary, packet_cnt);
 }
 
 std::vector<int> PacketClassficationSimulator::run_task_sequnce(
 		const std::vector<Request> &sequence,
-		std::map<std::string, double> &res, size_t trial_cnt) {
+		std::map<std::string, double> &res, size_t trial_cnt,
+		std::map<std::string, std::string> &latency_summary) {
 	if (available_pool.size() == 0) {
 		throw std::runtime_error(
 				"Warning no available pool left: need to generate computation first\n");
 	}
 
-	std::vector<std::future<time_t>> elapsed_time_total(
-			packet_classifiers.size());
+	std::vector<std::future<time_t>> elapsed_time_total;
+	elapsed_time_total.reserve(packet_classifiers.size());
 
 	std::vector<int> _results;
+	// classify, insert, delete, batch of updates for each classifier
+	std::vector<std::array<LatencyHistogram, 4>> latency(
+			packet_classifiers.size());
+	// lookups while some updates were not visible yet (a rebuild in progress)
+	// and the other lookups, their count and time for each classifier
+	std::vector<std::array<size_t, 2>> lookups(packet_classifiers.size(), {
+			0, 0 });
+	std::vector<std::array<time_t, 2>> lookup_time(packet_classifiers.size(),
+			{ time_t(0), time_t(0) });
+	// heap of the classifier after the construction and after the updates
+	std::vector<AllocationTracker::Stats> alloc(packet_classifiers.size());
+	std::vector<int64_t> alloc_constructed(packet_classifiers.size());
+	// number of tables in TABLE_SAMPLES points of the sequence (first trial)
+	const size_t TABLE_SAMPLES = 32;
+	size_t table_sample_period = std::max<size_t>(1,
+			sequence.size() / TABLE_SAMPLES);
+	std::vector<size_t> tables_over_time;
 	for (size_t i = 0; i < packet_classifiers.size(); i++) {
-		auto t = pool.enqueue([this, i, &_results, trial_cnt, &sequence]() {
+		auto t = pool.enqueue([this, i, &_results, trial_cnt, &sequence, &latency,
+				&alloc, &alloc_constructed, table_sample_period,
+				&tables_over_time, &lookups, &lookup_time]() {
 			PacketClassifier &classifier = *packet_classifiers[i];
+			auto &classify_latency = latency[i][0];
+			auto &insert_latency = latency[i][1];
+			auto &delete_latency = latency[i][2];
+			auto &batch_latency = latency[i][3];
+			LatencySampler sample(latency_sample_period);
 			Bookkeeper rules_in_use_temp = rules_in_use;
 			Bookkeeper available_pool_temp = available_pool;
 
-			time_t elapsed_seconds = classifier.ConstructClassifier(rules_in_use_temp.GetRules());
+			auto initial_rules = rules_in_use_temp.GetRules();
+			time_t elapsed_seconds;
+			{
+				AllocationTracker::Scope alloc_scope(alloc[i]);
+				elapsed_seconds = classifier.ConstructClassifier(initial_rules);
+			}
+			alloc_constructed[i] = alloc[i].live_bytes;
+			// the handles of rules_in_use_temp for the batches, a rule inserted
+			// by the pending batch has the index of its insert instead
+			const uint32_t PENDING = UINT32_MAX;
+			std::vector<RuleHandle> rule_handles;
+			std::vector<RuleUpdate> batch;
+			uint32_t batch_inserts = 0;
+			if (update_batch > 1) {
+				for (size_t k = 0; k < initial_rules.size(); k++)
+					rule_handles.push_back(classifier.HandleOf(k));
+				batch.reserve(update_batch);
+			}
 
 			for (size_t t = 0; t < trial_cnt; t++) {
 				std::vector<int> *results = nullptr;
@@ -265,23 +502,56 @@ std::vector<int> PacketClassficationSimulator::run_task_sequnce(
 				}
 
 				size_t packet_counter = 0;
+				size_t request_counter = 0;
+				size_t update_counter = 0;
 				std::chrono::time_point<std::chrono::steady_clock> start, end;
 				//invariant: at all time, DS.rules = rules_in_use.rules
 				time_t elapsed_seconds_cnt2(0);
+				auto apply_batch = [&]() {
+					std::vector<RuleHandle> inserted;
+					{
+						AllocationTracker::Scope alloc_scope(alloc[i]);
+						start = std::chrono::steady_clock::now();
+						uint64_t t0 = LatencyHistogram::Start();
+						inserted = classifier.ApplyUpdates(batch);
+						batch_latency.record(LatencyHistogram::Stop() - t0);
+						end = std::chrono::steady_clock::now();
+					}
+					elapsed_seconds_cnt2 += end - start;
+					for (RuleHandle &h : rule_handles) {
+						if (h.generation == PENDING)
+							h = inserted[h.slot];
+					}
+					batch.clear();
+					batch_inserts = 0;
+				};
+				if (results)
+					tables_over_time.push_back(classifier.NumTables());
 				for (Request n : sequence) {
 					Rule temp_rule;
 					int result = -1;
+					bool pending;
 					switch (n.request_type) {
 					case RequestType::ClassifyPacket:
 						/*if (packets.size() == 0) {
 						 printf("Warning packets.size() = 0 in packet request");
 						 break;
 						 }*/
+						pending = classifier.UpdatesPending();
 						start = std::chrono::steady_clock::now();
-						result = classifier.ClassifyAPacket(
-								packets[packet_counter++]);
+						if (sample()) {
+							uint64_t t0 = LatencyHistogram::Start();
+							result = classifier.ClassifyAPacket(
+									packets[packet_counter++]);
+							classify_latency.record(LatencyHistogram::Stop() - t0);
+						} else {
+							result = classifier.ClassifyAPacket(
+									packets[packet_counter++]);
+						}
 						end = std::chrono::steady_clock::now();
 						elapsed_seconds_cnt2 += end - start;
+						lookups[i][pending]++;
+						lookup_time[i][pending] += end - start;
 						if (packet_counter == packets.size())
 							packet_counter = 0;
 						if (results)
@@ -296,9 +566,25 @@ std::vector<int> PacketClassficationSimulator::run_task_sequnce(
 						temp_rule = available_pool_temp.GetOneRuleAndPop(
 								n.random_index_trace);
 						rules_in_use_temp.InsertRule(temp_rule);
-						start = std::chrono::steady_clock::now();
-						classifier.InsertRule(temp_rule);
-						end = std::chrono::steady_clock::now();
+						if (update_batch > 1) {
+							rule_handles.push_back( { batch_inserts++, PENDING });
+							batch.push_back(RuleUpdate::Insertion(temp_rule));
+							if (batch.size() == update_batch)
+								apply_batch();
+							break;
+						}
+						{
+							AllocationTracker::Scope alloc_scope(alloc[i]);
+							start = std::chrono::steady_clock::now();
+							if (sample()) {
+								uint64_t t0 = LatencyHistogram::Start();
+								classifier.InsertRule(temp_rule);
+								insert_latency.record(LatencyHistogram::Stop() - t0);
+							} else {
+								classifier.InsertRule(temp_rule);
+							}
+							end = std::chrono::steady_clock::now();
+						}
 						elapsed_seconds_cnt2 += end - start;
 
 						break;
@@ -311,17 +597,54 @@ std::vector<int> PacketClassficationSimulator::run_task_sequnce(
 						temp_rule = rules_in_use_temp.GetOneRuleAndPop(
 								n.random_index_trace);
 						available_pool_temp.InsertRule(temp_rule);
+						if (update_batch > 1) {
+							// a batch can not delete the rules it inserts
+							if (rule_handles[n.random_index_trace].generation
+									== PENDING)
+								apply_batch();
+							batch.push_back(
+									RuleUpdate::Deletion(
+											rule_handles[n.random_index_trace]));
+							rule_handles[n.random_index_trace] =
+									rule_handles.back();
+							rule_handles.pop_back();
+							if (batch.size() == update_batch)
+								apply_batch();
+							break;
+						}
 
-						start = std::chrono::steady_clock::now();
-						classifier.DeleteRule(n.random_index_trace);
-						end = std::chrono::steady_clock::now();
+						{
+							AllocationTracker::Scope alloc_scope(alloc[i]);
+							start = std::chrono::steady_clock::now();
+							if (sample()) {
+								uint64_t t0 = LatencyHistogram::Start();
+								classifier.DeleteRule(n.random_index_trace);
+								delete_latency.record(LatencyHistogram::Stop() - t0);
+							} else {
+								classifier.DeleteRule(n.random_index_trace);
+							}
+							end = std::chrono::steady_clock::now();
+						}
 						elapsed_seconds_cnt2 += end - start;
 
 						break;
 					default:
 						break;
 					}
+					if (n.request_type != RequestType::ClassifyPacket
+							&& maintain_budget
+							&& ++update_counter % maintain_interval == 0) {
+						AllocationTracker::Scope alloc_scope(alloc[i]);
+						start = std::chrono::steady_clock::now();
+						classifier.Maintain(maintain_budget);
+						end = std::chrono::steady_clock::now();
+						elapsed_seconds_cnt2 += end - start;
+					}
+					if (results && ++request_counter % table_sample_period == 0)
+						tables_over_time.push_back(classifier.NumTables());
 				}
+				if (!batch.empty())
+					apply_batch();
 				elapsed_seconds += elapsed_seconds_cnt2;
 			}
 			return elapsed_seconds;
@@ -337,5 +660,37 @@ std::vector<int> PacketClassficationSimulator::run_task_sequnce(
 	}
 	res["UpdateTime(s)"] += sum_elapsed2.count() / trial_cnt;
 
+	for (size_t i = 1; i < latency.size(); i++)
+		for (size_t k = 0; k < 4; k++)
+			latency[0][k].merge(latency[i][k]);
+	latency[0][0].Report(latency_summary, "ClassifyLatency");
+	latency[0][1].Report(latency_summary, "InsertLatency");
+	latency[0][2].Report(latency_summary, "DeleteLatency");
+	latency[0][3].Report(latency_summary, "BatchLatency");
+	for (size_t i = 1; i < lookups.size(); i++) {
+		for (size_t k = 0; k < 2; k++) {
+			lookups[0][k] += lookups[i][k];
+			lookup_time[0][k] += lookup_time[i][k];
+		}
+	}
+	if (lookups[0][1]) {
+		latency_summary["Rebuild.Lookups.DuringRebuild"] = std::to_string(
+				lookups[0][1]);
+		latency_summary["Rebuild.LookupRate.DuringRebuild(Mpps)"] =
+				std::to_string(lookups[0][1] / lookup_time[0][1].count() / 1e6);
+		if (lookups[0][0])
+			latency_summary["Rebuild.LookupRate.Idle(Mpps)"] = std::to_string(
+					lookups[0][0] / lookup_time[0][0].count() / 1e6);
+	}
+	std::stringstream tables;
+	for (size_t k = 0; k < tables_over_time.size(); k++)
+		tables << (k ? "-" : "") << tables_over_time[k];
+	latency_summary["Tables.OverTime"] = tables.str();
+	if (AllocationTracker::enabled) {
+		latency_summary["Alloc.Construction.Live(bytes)"] = std::to_string(
+				alloc_constructed[0]);
+		alloc[0].Report(latency_summary, "Alloc");
+	}
+
 	return _results;
 }
@@ -3,11 +3,17 @@
 #include "likwid_common.h"
 #include "ElementaryClasses.h"
 #include "Utilities/MapExtensions.h"
+#include "Utilities/AllocationTracker.h"
+#include "Utilities/LatencyHistogram.h"
+#include "Utilities/PerfCounters.h"
 #include <Utilities/thread_pool.h>
 
+#include <functional>
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include "packet_classifier.h"
+#include "IO/PacketSource.h"
 
 enum RequestType {
 	ClassifyPacket, Insertion, Deletion
@@ -76,18 +82,78 @@ public:
 			std::map<std::string, std::string> &summary, size_t trials);
 	static time_t run_only_packet_classification(
 			const std::vector<Packet> &packets, PacketClassifier &classifier,
-			size_t trials, std::vector<int> *results);
+			size_t trials, std::vector<int> *results,
+			LatencyHistogram *latency = nullptr, size_t sample_period = 0,
+			PerfCounters::Values *perf = nullptr);
+	/**
+	 * Classification of the packets from the PacketSource (each classifier
+	 * thread gets its own source for each trial), the packets are prefetched
+	 * by a separate thread and the results are not stored
+	 */
+	void ruhn_streamed_packet_classification(
+			std::map<std::string, std::string> &summary, size_t trials,
+			const std::function<std::unique_ptr<PacketSource>()> &make_source);
+	static time_t run_streamed_packet_classification(PacketSource &packets,
+			PacketClassifier &classifier, size_t &packet_cnt,
+			LatencyHistogram *latency = nullptr, size_t sample_period = 0,
+			PerfCounters::Values *perf = nullptr);
+	/**
+	 * Classify the packets with the MemoryAccessTrace enabled and add
+	 * the distribution of the distinct cache lines touched per packet
+	 * (CacheLines.*) and the cache lines touched by the whole trace
+	 * (WorkingSet(bytes)) to the summary
+	 *
+	 * @param packet_cnt number of the packets to trace (0 = all)
+	 */
+	void ruhn_memory_access_trace(std::map<std::string, std::string> &summary,
+			size_t packet_cnt);
+	/*
+	 * @param latency output for the latency percentiles of the classify/insert/delete
+	 * 		(and of the heap usage if AllocationTracker is enabled) and of the
+	 * 		number of tables during the sequence (Tables.OverTime)
+	 */
 	std::vector<int> run_task_sequnce(const std::vector<Request> &sequence,
-			std::map<std::string, double> &trial, size_t trial_cnt);
+			std::map<std::string, double> &trial, size_t trial_cnt,
+			std::map<std::string, std::string> &latency);
+
+	/**
+	 * Measure the latency of each n-th operation (0 = disabled),
+	 * the percentiles are added to the summary as ClassifyLatency.p50(ns) ...
+	 */
+	void set_latency_sampling(size_t period) {
+		latency_sample_period = period;
+	}
+	/**
+	 * Call PacketClassifier::Maintain(budget) after each interval-th update
+	 * (budget 0 = never), the time is counted in the update time
+	 */
+	void set_maintenance(size_t budget, size_t interval) {
+		maintain_budget = budget;
+		maintain_interval = interval;
+	}
+	/**
+	 * Apply the inserts and deletes by PacketClassifier::ApplyUpdates in
+	 * batches of size updates (1 = each update by InsertRule/DeleteRule), the
+	 * latency of each batch is added to the summary as BatchLatency.p50(ns) ...
+	 */
+	void set_update_batch(size_t size) {
+		update_batch = std::max<size_t>(size, 1);
+	}
 
 private:
 	std::vector<Request> GenerateRequests(Random &rand, size_t num_packet,
 			size_t num_insert, size_t num_delete) const;
 	time_t sumTime(std::vector<std::future<time_t>> &elapsed_seconds);
+	void collect_classifier_stats(std::map<std::string, std::string> &summary,
+			size_t packets_classified);
 	const std::vector<PacketClassifier*> &packet_classifiers;
 	std::vector<Rule> ruleset;
 	std::vector<Packet> packets;
 	ThreadPool pool;
 	Bookkeeper rules_in_use;
 	Bookkeeper available_pool;
+	size_t latency_sample_period = 64;
+	size_t maintain_budget = 0;
+	size_t maintain_interval = 64;
+	size_t update_batch = 1;
 };
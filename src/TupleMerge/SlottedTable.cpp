@@ -22,6 +22,7 @@
  * SOFTWARE.
  */
 #include "SlottedTable.h"
+#include "../DimensionSchema.h"
 
 using namespace TupleMergeUtils;
 using namespace std;
@@ -272,13 +273,13 @@ inline uint32_t HashRuleAddress(const Rule& r) {
 	return (r.prefix_length[0] << 6) + r.prefix_length[1];
 }
 
+// the lanes with some bits in the tuple (the narrow fields are in the low bits of the lane)
 inline vector<int> Dimify(const Tuple& t) {
+	const DimensionSchema& schema = DimensionSchema::ForDim(t.size());
 	vector<int> sol;
-	if (t[FieldSA] > 0) sol.push_back(FieldSA);
-	if (t[FieldDA] > 0) sol.push_back(FieldDA);
-	if (t[FieldSP] > 16) sol.push_back(FieldSP);
-	if (t[FieldDP] > 16) sol.push_back(FieldDP);
-	if (t[FieldProto] > 24) sol.push_back(FieldProto);
+	for (size_t d = 0; d < t.size(); d++) {
+		if (t[d] > DimensionSchema::LANE_WIDTH - schema.LaneWidth(d)) sol.push_back(d);
+	}
 	return sol;
 }
 
@@ -305,11 +306,20 @@ int SlottedTable::WorstAccesses() const {
 	return 1;//cmap_largest_chain(&map_in_tuple);
 }
 
-int SlottedTable::ClassifyAPacket(const Packet& p) const {
-	
+template<bool COUNT>
+int SlottedTable::Classify(const Packet& p) const {
+	MEMORY_ACCESS_TRACE(dims.data(), dims.size() * sizeof(dims[0]));
+	MEMORY_ACCESS_TRACE(lengths.data(), lengths.size() * sizeof(lengths[0]));
+
 	cmap_node * found_node = cmap_find(&map_in_tuple, HashPacket(p));
 	int priority = -1;
+	if (COUNT) {
+		stats.probes++;
+		stats.hits += found_node != nullptr;
+	}
 	while (found_node != nullptr) {
+		MEMORY_ACCESS_TRACE(found_node, sizeof(cmap_node));
+		if (COUNT) stats.checks++;
 		if (found_node->rule_ptr->MatchesPacket(p)) {
 			priority = std::max(priority, found_node->priority);
 		}
@@ -318,6 +328,14 @@ int SlottedTable::ClassifyAPacket(const Packet& p) const {
 	return priority;
 }
 
+int SlottedTable::ClassifyAPacket(const Packet& p) const {
+	return Classify<false>(p);
+}
+
+int SlottedTable::ClassifyAPacketCounted(const Packet& p) const {
+	return Classify<true>(p);
+}
+
 bool SlottedTable::IsThatTuple(const Tuple& tuple) const {
 	auto td = Dimify(tuple);
 	if (td == dims) {
@@ -377,6 +395,18 @@ vector<Rule> SlottedTable::GetRules() const {
 	return rules;
 }
 
+vector<cmap_node*> SlottedTable::GetNodes() const {
+	vector<cmap_node*> nodes;
+	cmap_cursor cursor = cmap_cursor_start(&map_in_tuple);
+	
+	while (cursor.node != nullptr) {
+		nodes.push_back(cursor.node);
+		cmap_cursor_advance(&cursor);
+	}
+	
+	return nodes;
+}
+
 uint32_t inline SlottedTable::HashRule(const Rule& r) const {
 	uint32_t hash = HashBasis;
 	for (size_t i = 0; i < dims.size(); i++) {
@@ -396,40 +426,27 @@ uint32_t inline SlottedTable::HashPacket(const Packet& p) const {
 	return hash;
 }
 
-void SlottedTable::Insertion(const Rule& r, bool& priority_change) {
+cmap_node* SlottedTable::Insertion(const Rule& r, bool& priority_change) {
 	cmap_node * new_node = new cmap_node(r);
-	cmap_insert(&map_in_tuple, new_node, HashRule(r));
+	Insertion(new_node, priority_change);
+	return new_node;
+}
+
+void SlottedTable::Insertion(cmap_node* node, bool& priority_change) {
+	cmap_insert(&map_in_tuple, node, HashRule(*node->rule_ptr));
 
-	priority_container.insert(r.priority);
-	if (r.priority > maxPriority) {
-		maxPriority = r.priority;
+	if (node->priority > priorities.Max()) {
 		priority_change = true;
 	}
-	
+	priorities.Insert(node->priority);
 }
-bool SlottedTable::Deletion(const Rule& r, bool& priority_change) {
-	auto pit = priority_container.equal_range(r.priority);
-	if (pit.first != pit.second) {
-		unsigned int hash_r = HashRule(r);
-		cmap_node * found_node = cmap_find(&map_in_tuple, hash_r);
-		while (found_node != nullptr) {
-			if (found_node->priority == r.priority) {
-				cmap_remove(&map_in_tuple, found_node, hash_r);
-				break;
-			}
-			found_node = found_node->next;
-		}
-		priority_container.erase(pit.first);
-		if (priority_container.size() == 0)  {
-			maxPriority = -1;
-			priority_change = true;
-		} else if (r.priority == maxPriority) {
-			maxPriority = *priority_container.rbegin();
-			priority_change = true;
-		} //else priority_change = false;
-		return true;
-	} else {
-		return false;
+
+void SlottedTable::Deletion(cmap_node* node, bool& priority_change) {
+	cmap_remove(&map_in_tuple, node, HashRule(*node->rule_ptr));
+	int maxPriority = priorities.Max();
+	priorities.Erase(node->priority);
+	if (priorities.Max() != maxPriority) {
+		priority_change = true;
 	}
 }
 
@@ -25,6 +25,7 @@
 
 #include "../Simulation.h"
 #include "../OVS/TupleSpaceSearch.h"
+#include "../Utilities/PriorityTracker.h"
 #include <unordered_set>
 
 namespace TupleMergeUtils {
@@ -74,7 +75,7 @@ namespace TupleMergeUtils {
 struct SlottedTable {
 public:
 	SlottedTable(const std::vector<int>& dims, const std::vector<unsigned int>& lengths) 
-			: dims(dims), lengths(lengths), maxPriority(-1) {
+			: dims(dims), lengths(lengths) {
 		cmap_init(&map_in_tuple);
 	}
 	SlottedTable(const TupleMergeUtils::Tuple& tuple);
@@ -83,8 +84,14 @@ public:
 	bool IsEmpty() { return NumRules() == 0; }
 
 	int ClassifyAPacket(const Packet& p) const;
-	void Insertion(const Rule& r, bool& priority_change);
-	bool Deletion(const Rule& r, bool& priority_change);
+	// ClassifyAPacket which also updates stats
+	int ClassifyAPacketCounted(const Packet& p) const;
+	// the rule in a new node (node->key is left to the owner of the table)
+	cmap_node* Insertion(const Rule& r, bool& priority_change);
+	// the node of a rule of an other table
+	void Insertion(cmap_node* node, bool& priority_change);
+	// removes the node of the rule (it is not freed, the rules may share a priority)
+	void Deletion(cmap_node* node, bool& priority_change);
 	
 	bool CanInsert(const TupleMergeUtils::Tuple& tuple) const {
 		for (size_t i = 0; i < dims.size(); i++) {
@@ -94,12 +101,19 @@ public:
 		return true;
 	}
 	bool IsThatTuple(const TupleMergeUtils::Tuple& tuple) const;
+	// the prefix lengths of the table (0 in the other dimensions of tuple)
+	void GetTuple(TupleMergeUtils::Tuple& tuple) const {
+		std::fill(tuple.begin(), tuple.end(), 0);
+		for (size_t i = 0; i < dims.size(); i++)
+			tuple[dims[i]] = lengths[i];
+	}
 	bool CanTakeRulesFrom(const SlottedTable* table) const;
 	bool HaveSameTuple(const SlottedTable* table) const;
 	
 	size_t NumCollisions(const Rule& r) const;
 	std::vector<Rule> Collisions(const Rule& r) const;
 	std::vector<Rule> GetRules() const;
+	std::vector<cmap_node*> GetNodes() const;
 	
 	int WorstAccesses() const;
 	int NumRules() const  {
@@ -109,9 +123,21 @@ public:
 		return 	cmap_count(&map_in_tuple)* ruleSizeBytes + cmap_array_size(&map_in_tuple) * POINTER_SIZE_BYTES;
 	}
 
-	int MaxPriority() const { return maxPriority; };
+	int MaxPriority() const { return priorities.Max(); };
+
+	// lookup counters of the table (the cost model of TupleMergeOnline),
+	// updated only by ClassifyAPacketCounted
+	struct Stats {
+		uint64_t probes = 0; // lookups in the table
+		uint64_t hits = 0; // lookups which found a chain of rules
+		uint64_t checks = 0; // rules compared
+		uint64_t since = 0; // lookups of the classifier when the table was created
+	};
+	mutable Stats stats;
 	
 protected:
+	template<bool COUNT>
+	int Classify(const Packet& p) const;
 	uint32_t inline HashRule(const Rule& r) const;
 	uint32_t inline HashPacket(const Packet& p) const;
 	
@@ -120,7 +146,6 @@ protected:
 	std::vector<int> dims;
 	std::vector<unsigned int> lengths;
 	
-	int maxPriority = -1;
-	std::multiset<int> priority_container;
+	PriorityTracker priorities;
 };
 
@@ -23,6 +23,8 @@
  */
 #include "TupleMergeOffline.h"
 
+#include <numeric>
+
 using namespace std;
 using namespace TupleMergeUtils;
 
@@ -38,24 +40,26 @@ TupleMergeOffline::~TupleMergeOffline() {
 }
 
 void TupleMergeOffline::_ConstructClassifier(const vector<Rule>& rules) {
-	this->rules = rules;
+	assignments.resize(rules.size());
 	
-	vector<Rule> remain = rules;
-	sort(remain.begin(), remain.end(), [](const Rule& x, const Rule& y) { return x.priority > y.priority; } );
+	vector<size_t> remain(rules.size());
+	iota(remain.begin(), remain.end(), 0);
+	stable_sort(remain.begin(), remain.end(), [&rules](size_t x, size_t y) { return rules[x].priority > rules[y].priority; } );
 	
 	while (!remain.empty()) {
-		remain = SelectTable(remain);
+		remain = SelectTable(rules, remain);
 	}
 	Resort();
 }
 
-vector<Rule> TupleMergeOffline::SelectTable(const vector<Rule>& rules) {
+vector<size_t> TupleMergeOffline::SelectTable(const vector<Rule>& rules, const vector<size_t>& order) {
 	Tuple bestTuple;
 	size_t bestIndex = 0;
 	size_t bestSize = 0;
 	
 	Tuple current;
-	for (const Rule& r : rules) {
+	for (size_t index : order) {
+		const Rule& r = rules[index];
 		Tuple t;
 		PreferedTuple(r, t);
 		bool hasChanged = false;
@@ -70,14 +74,14 @@ vector<Rule> TupleMergeOffline::SelectTable(const vector<Rule>& rules) {
 			}
 		}
 		if (hasChanged) {
-			size_t firstOut = rules.size();
+			size_t firstOut = order.size();
 			size_t size = 0;
 			unordered_map<uint32_t, size_t> hashCounts;
-			for (size_t i = 0; i < rules.size(); i++) {
+			for (size_t i = 0; i < order.size(); i++) {
 				Tuple ti;
-				PreferedTuple(rules[i], ti);
+				PreferedTuple(rules[order[i]], ti);
 				if (CompatibilityCheck(ti, current)) {
-					uint32_t hash = Hash(rules[i], current);
+					uint32_t hash = Hash(rules[order[i]], current);
 					hashCounts[hash]++;
 					if (hashCounts[hash] > collideLimit) {
 						firstOut = min(firstOut, i);
@@ -102,20 +106,20 @@ vector<Rule> TupleMergeOffline::SelectTable(const vector<Rule>& rules) {
 breakout:
 	
 	SlottedTable* table = new SlottedTable(bestTuple);
-	vector<Rule> remain;
-	for (const Rule& r : rules) {
+	vector<size_t> remain;
+	for (size_t index : order) {
+		const Rule& r = rules[index];
 		Tuple tr;
 		PreferedTuple(r, tr);
 		if (table->CanInsert(tr)) {
 			if ((int)table->NumCollisions(r) < collideLimit) {
 				bool ignore;
-				table->Insertion(r, ignore);
-				assignments[r.priority] = table;
+				Assign(index, table, r, ignore);
 			} else {
-				remain.push_back(r);
+				remain.push_back(index);
 			}
 		} else {
-			remain.push_back(r);
+			remain.push_back(index);
 		}
 	}
 	tables.push_back(table);
@@ -129,11 +133,9 @@ void TupleMergeOffline::CombineTables() {
 				// If all rules from i2 can go into i1, transfer them
 				// Don't worry about collision limits
 				// Then delete i2
-				vector<Rule> rl = (*i2)->GetRules();
-				for (Rule& r : rl) {
+				for (cmap_node* node : (*i2)->GetNodes()) {
 					bool ignore;
-					(*i1)->Insertion(r, ignore);
-					assignments[r.priority] = *i1;
+					Move(node, *i1, ignore);
 				}
 				delete (*i2);
 				i2 = tables.erase(i2);
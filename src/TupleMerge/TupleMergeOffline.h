@@ -37,7 +37,8 @@ public:
 	void _ConstructClassifier(const std::vector<Rule>& rules) override;
 	
 private:
-	std::vector<Rule> SelectTable(const std::vector<Rule>& rules);
+	// the next table from the rules at the indexes of order, returns the rules left
+	std::vector<size_t> SelectTable(const std::vector<Rule>& rules, const std::vector<size_t>& order);
 	void CombineTables();
 };
 
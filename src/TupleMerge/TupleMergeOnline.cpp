@@ -22,6 +22,7 @@
  * SOFTWARE.
  */
 #include "TupleMergeOnline.h"
+#include "../DimensionSchema.h"
 
 using namespace std;
 using namespace ForgeUtils;
@@ -38,29 +39,48 @@ int Delta(Tuple t1, Tuple t2) {
 	return Sum(t1) - Sum(t2);
 }
 
-void ForgeUtils::Crazify(Tuple& tuple) {
-	// int delta = abs(tuple[FieldSA] - tuple[FieldDA]);
-	
-	if (tuple[FieldSA] > tuple[FieldDA] + 4) {
-		tuple[FieldDA] = 0;
-		tuple[FieldDP] = 16;
-	}
-	else if (tuple[FieldDA] > tuple[FieldSA] + 4) {
-		tuple[FieldSA] = 0;
-		tuple[FieldSP] = 16;
+// change of the relaxation level of the Adaptive policy by a split or a new table
+static const double RELAX_STEP = 1.0 / 16;
+// the chains of the merged tables are at most 1/MERGE_HEADROOM of the limit
+static const int MERGE_HEADROOM = 4;
+
+// prefix length of the table for the address prefix of length len
+// (32b address: 32 -> 28, 25-31 -> -3, 17-24 -> -2, 9-16 -> -1),
+// the shortening is scaled by level
+static int RelaxLength(int len, int width, double level) {
+	int shorter = 0;
+	if (len == width) shorter = width / 8;
+	else if (len > width * 3 / 4) shorter = width * 3 / 32;
+	else if (len > width / 2) shorter = width / 16;
+	else if (len > width / 4) shorter = width / 32;
+	return max(0, len - int(lround(shorter * level)));
+}
+
+// the tuple is relaxed on the address fields (the first two fields of the
+// DimensionSchema), the lanes of the wide fields are updated together
+void Relax(Tuple& tuple, double level) {
+	const DimensionSchema& schema = DimensionSchema::ForDim(tuple.size());
+	if (schema.NumFields() <= FieldDA) return;
+	int saWidth = schema.GetField(FieldSA).width;
+	int daWidth = schema.GetField(FieldDA).width;
+	bool hasPorts = schema.NumFields() > FieldDP;
+	const int deltaThreshold = min(saWidth, daWidth) / 8;
+	int sa = schema.FieldPrefixLength(tuple, FieldSA);
+	int da = schema.FieldPrefixLength(tuple, FieldDA);
+	int delta = sa - da;
+	if (-delta > deltaThreshold) {
+		sa = 0;
+		if (hasPorts) schema.SetFieldPrefixLength(tuple, FieldSP, 0);
+	} else if (delta > deltaThreshold) {
+		da = 0;
+		if (hasPorts) schema.SetFieldPrefixLength(tuple, FieldDP, 0);
 	}
-	
-	
-	if (tuple[FieldSA] == 32) tuple[FieldSA] -= 4;
-	else if (tuple[FieldSA] > 24) tuple[FieldSA] -= 3;
-	else if (tuple[FieldSA] > 16) tuple[FieldSA] -= 2;
-	else if (tuple[FieldSA] > 8) tuple[FieldSA] -= 1;
-	
-	if (tuple[FieldDA] == 32) tuple[FieldDA] -= 4;
-	else if (tuple[FieldDA] > 24) tuple[FieldDA] -= 3;
-	else if (tuple[FieldDA] > 16) tuple[FieldDA] -= 2;
-	else if (tuple[FieldDA] > 8) tuple[FieldDA] -= 1;
+	schema.SetFieldPrefixLength(tuple, FieldSA, RelaxLength(sa, saWidth, level));
+	schema.SetFieldPrefixLength(tuple, FieldDA, RelaxLength(da, daWidth, level));
+}
 
+void ForgeUtils::Crazify(Tuple& tuple, double level) {
+	Relax(tuple, level);
 }
 
 size_t CollisionsForTuple(const std::vector<Rule>& rules, const Tuple& tuple) {
@@ -80,26 +100,44 @@ size_t CollisionsForTuple(const std::vector<Rule>& rules, const Tuple& tuple) {
 
 TupleMergeOnline::TupleMergeOnline(const std::unordered_map<std::string, std::string>& args) 
 	: collideLimit(GetIntOrElse(args, "TM.Limit.Collide", 10)) {
+	string policy = GetOrElse(args, "TM.Policy", "Classic");
+	if (policy != "Adaptive" && policy != "Classic")
+		throw invalid_argument("TM.Policy: unknown policy " + policy);
+	adaptive = policy == "Adaptive";
+	collideLimitMax = GetIntOrElse(args, "TM.Limit.Collide.Max", 4 * collideLimit);
+	ruleCost = stod(GetOrElse(args, "TM.Cost.Rule", "1"));
+	// a probe costs as much as the chain of TM.Limit.Collide rules
+	tableCost = stod(GetOrElse(args, "TM.Cost.Table", to_string(collideLimit * ruleCost)));
+	relaxLevel = 1;
 }
 
 TupleMergeOnline::~TupleMergeOnline() {
+	for (auto& a : assignments) {
+		delete a.node;
+	}
 	for (auto t : tables) {
 		delete t;
 	}
 }
 
 void TupleMergeOnline::_ConstructClassifier(const std::vector<Rule>& rules) {
+	constructing = true;
 	for (const Rule& r : rules) {
-		InsertRule(r);
+		_InsertRule(r);
 	}
+	constructing = false;
 }
 
 int TupleMergeOnline::ClassifyAPacket(const Packet& p) {
 	int prior = -1;
 	int q = 0;
+	// the lookup counters are used only by the Adaptive policy
+	if (adaptive) lookups++;
 	for (auto & t : tables) {
+		MEMORY_ACCESS_TRACE(&t, sizeof(t));
+		MEMORY_ACCESS_TRACE(t, sizeof(SlottedTable));
 		if (t->MaxPriority() > prior) {
-			prior = max(prior, t->ClassifyAPacket(p));
+			prior = max(prior, adaptive ? t->ClassifyAPacketCounted(p) : t->ClassifyAPacket(p));
 			q++;
 		}
 	}
@@ -107,114 +145,385 @@ int TupleMergeOnline::ClassifyAPacket(const Packet& p) {
 	return prior;
 }
 
-void TupleMergeOnline::DeleteRule(size_t index){
-	Rule r = rules[index];
-	rules[index] = rules[rules.size() - 1];
-	rules.pop_back();
-
-	SlottedTable* tbl = assignments[r.priority];
-	assignments.erase(r.priority);
-
-	bool hasChanged;
-	tbl->Deletion(r, hasChanged);
+void TupleMergeOnline::_DeleteRule(size_t index){
+	if (Delete(index)) {
+		Resort();
+	}
+}
 
-	if (tbl->IsEmpty()) {
-		tables.erase(find(tables.begin(), tables.end(), tbl), tables.end());
-		delete tbl;
+void TupleMergeOnline::_InsertRule(const Rule& rule) {
+	if (Insert(rule)) {
+		Resort();
 	}
+}
 
+void TupleMergeOnline::_ApplyUpdates(const std::vector<size_t>& deleted, const std::vector<const Rule*>& inserted) {
+	bool hasChanged = false;
+	for (size_t index : deleted) {
+		hasChanged |= Delete(index);
+	}
+	for (const Rule* rule : inserted) {
+		hasChanged |= Insert(*rule);
+	}
 	if (hasChanged) {
 		Resort();
 	}
 }
 
-void Relax(Tuple& tuple) {
-	const int deltaThreshold = 4;
-	int delta = tuple[FieldSA] - tuple[FieldDA];
-	if (-delta > deltaThreshold) {
-		tuple[FieldSA] = 0;
-		tuple[FieldSP] = 16;
-	} else if (delta > deltaThreshold) {
-		tuple[FieldDA] = 0;
-		tuple[FieldDP] = 16;
+bool TupleMergeOnline::Delete(size_t index) {
+	Assignment a = assignments[index];
+	if (index != assignments.size() - 1) {
+		assignments[index] = assignments.back();
+		assignments[index].node->key = index;
 	}
-	
-	if (tuple[FieldSA] == 32) tuple[FieldSA] -= 4;
-	else if (tuple[FieldSA] > 24) tuple[FieldSA] -= 3;
-	else if (tuple[FieldSA] > 16) tuple[FieldSA] -= 2;
-	else if (tuple[FieldSA] > 8) tuple[FieldSA] -= 1;
-	
-	if (tuple[FieldDA] == 32) tuple[FieldDA] -= 4;
-	else if (tuple[FieldDA] > 24) tuple[FieldDA] -= 3;
-	else if (tuple[FieldDA] > 16) tuple[FieldDA] -= 2;
-	else if (tuple[FieldDA] > 8) tuple[FieldDA] -= 1;
+	assignments.pop_back();
+
+	SlottedTable* tbl = a.table;
+	bool hasChanged = false;
+	tbl->Deletion(a.node, hasChanged);
+	delete a.node;
+
+	if (tbl->NumRules() <= LowOccupancy()) {
+		// a sparse table for Maintain
+		generation++;
+	}
+	if (tbl->IsEmpty()) {
+		RemoveTable(tbl);
+	} else if (adaptive && tbl->NumRules() <= CollideLimit(tbl) && TryMerge(tbl)) {
+		hasChanged = true;
+	}
+	return hasChanged;
 }
 
-void TupleMergeOnline::InsertRule(const Rule& rule) {
-	rules.push_back(rule);
+bool TupleMergeOnline::Insert(const Rule& rule) {
 	Tuple tuple;
 	PreferedTuple(rule, tuple);
 	
 	for (auto table : tables) {
 		if (table->CanInsert(tuple)) {
 			bool hasChanged = false;
-			table->Insertion(rule, hasChanged);
-			assignments[rule.priority] = table;
+			Assign(assignments.size(), table, rule, hasChanged);
 			
-			if (int(table->NumCollisions(rule)) > collideLimit) {
-				// Split Table
-				vector<Rule> collisions = table->Collisions(rule);
-				Tuple compatTuple;
-				BestTuple(collisions, compatTuple);
-				Tuple superTuple = compatTuple;
-				for (const Rule& r : collisions) {
-					Tuple t;
-					PreferedTuple(r, t);
-					for (size_t d = 0; d < tuple.size(); d++) {
-						superTuple[d] = max(superTuple[d], t[d]);
-					}
-				}
-				size_t bestD = 0;
-				int bestDelta = 0;
-				for (size_t d = 0; d < tuple.size(); d++) {
-					int delta = superTuple[d] - compatTuple[d];
-					if (delta > bestDelta) {
-						bestD = d;
-						bestDelta = delta;
-					}
-				}
-				compatTuple[bestD] = (superTuple[bestD] + compatTuple[bestD]) / 2;
-				SlottedTable* target = FindOrMake(compatTuple);
-				
-				vector<Rule> rl = table->GetRules();
-				for (Rule& r : rl) {
-					Tuple t;
-					PreferedTuple(r, t);
-					if (target->CanInsert(t)) {
-						table->Deletion(r, hasChanged);
-						target->Insertion(r, hasChanged);
-						assignments[r.priority] = target;
-					}
-				}
+			if (int(table->NumCollisions(rule)) > CollideLimit(table)) {
+				Split(table, rule, hasChanged);
 			}
-			
-			if (hasChanged) {
-				Resort();
-			}
-			return;
+			return hasChanged;
 		}
 	}
 	// Could not insert
 	// So create a new table
 	{
 		bool ignore;
-		Relax(tuple);
+		Relax(tuple, relaxLevel);
 		SlottedTable * table = new SlottedTable(tuple);
-		table->Insertion(rule, ignore);
+		table->stats.since = lookups;
+		Assign(assignments.size(), table, rule, ignore);
 		tables.push_back(table);
-		assignments[rule.priority] = table;
+		generation++;
+		if (adaptive && !constructing) {
+			relaxLevel = min(2.0, relaxLevel + RELAX_STEP);
+		}
+		return true;
+	}
+}
+
+void TupleMergeOnline::Assign(size_t index, SlottedTable* table, const Rule& rule, bool& hasChanged) {
+	if (index >= assignments.size()) {
+		assignments.resize(index + 1);
+	}
+	cmap_node* node = table->Insertion(rule, hasChanged);
+	node->key = index;
+	assignments[index] = {table, node};
+}
+
+void TupleMergeOnline::Move(cmap_node* node, SlottedTable* table, bool& hasChanged) {
+	Assignment& a = assignments[node->key];
+	a.table->Deletion(node, hasChanged);
+	table->Insertion(node, hasChanged);
+	a.table = table;
+}
+
+SlottedTable* TupleMergeOnline::Split(SlottedTable* table, const Rule& rule, bool& hasChanged) {
+	vector<Rule> collisions = table->Collisions(rule);
+	Tuple compatTuple;
+	BestTuple(collisions, compatTuple);
+	Tuple superTuple = compatTuple;
+	for (const Rule& r : collisions) {
+		Tuple t;
+		PreferedTuple(r, t);
+		for (size_t d = 0; d < t.size(); d++) {
+			superTuple[d] = max(superTuple[d], t[d]);
+		}
+	}
+	size_t bestD = 0;
+	int bestDelta = 0;
+	size_t bestChain = collisions.size();
+	for (size_t d = 0; d < compatTuple.size(); d++) {
+		int delta = superTuple[d] - compatTuple[d];
+		if (delta <= 0) continue;
+		if (!adaptive) {
+			// Classic: the largest difference of the prefix lengths
+			if (delta > bestDelta) {
+				bestD = d;
+				bestDelta = delta;
+			}
+			continue;
+		}
+		// Adaptive: the shortest chain left in the table or in the target
+		Tuple split = compatTuple;
+		split[d] = (superTuple[d] + compatTuple[d]) / 2;
+		vector<Rule> moved, kept;
+		for (const Rule& r : collisions) {
+			Tuple t;
+			PreferedTuple(r, t);
+			(CompatibilityCheck(t, split) ? moved : kept).push_back(r);
+		}
+		size_t chain = max(CollisionsForTuple(moved, split), kept.size());
+		if (chain < bestChain || (chain == bestChain && delta > bestDelta)) {
+			bestD = d;
+			bestDelta = delta;
+			bestChain = chain;
+		}
+	}
+	if (adaptive && bestChain >= collisions.size()) {
+		// the split would not make the chain shorter
+		return nullptr;
+	}
+	compatTuple[bestD] = (superTuple[bestD] + compatTuple[bestD]) / 2;
+	SlottedTable* target = FindOrMake(compatTuple);
+	if (target == table) {
+		return nullptr;
+	}
+	
+	for (cmap_node* node : table->GetNodes()) {
+		Tuple t;
+		PreferedTuple(*node->rule_ptr, t);
+		if (target->CanInsert(t)) {
+			Move(node, target, hasChanged);
+		}
+	}
+	splits++;
+	if (adaptive && !constructing) {
+		relaxLevel = max(0.0, relaxLevel - RELAX_STEP);
+	}
+	if (table->IsEmpty()) {
+		RemoveTable(table);
+		hasChanged = true;
+	}
+	if (target->IsEmpty()) {
+		RemoveTable(target);
+		return nullptr;
+	}
+	return target;
+}
+
+SlottedTable* TupleMergeOnline::MergeTarget(const SlottedTable* table) const {
+	// the candidate which costs the least when its chains get longer
+	SlottedTable* best = nullptr;
+	double bestCost = 0;
+	for (auto t : tables) {
+		if (t == table || !t->CanTakeRulesFrom(table)) continue;
+		double cost = ProbeFraction(t) * HitFraction(t);
+		if (!best || cost < bestCost) {
+			best = t;
+			bestCost = cost;
+		}
+	}
+	return best;
+}
+
+bool TupleMergeOnline::TryMerge(SlottedTable* table) {
+	SlottedTable* best = MergeTarget(table);
+	if (!best) return false;
+
+	bool ignore;
+	vector<cmap_node*> nodes = table->GetNodes();
+	size_t chain = 0;
+	for (cmap_node* node : nodes) {
+		Move(node, best, ignore);
+		chain = max(chain, best->NumCollisions(*node->rule_ptr));
+	}
+	// a hit in best finds a moved rule with the probability of the share of its rules
+	double saved = ProbeFraction(table) * tableCost;
+	double added = ProbeFraction(best) * HitFraction(best) * ruleCost * chain
+			* nodes.size() / best->NumRules();
+	// most of the limit is left for the inserts, so the merged table is not split again
+	if (int(chain) * MERGE_HEADROOM > CollideLimit(best) || added >= saved) {
+		for (cmap_node* node : nodes) {
+			Move(node, table, ignore);
+		}
+		return false;
+	}
+	RemoveTable(table);
+	merges++;
+	return true;
+}
+
+void TupleMergeOnline::RemoveTable(SlottedTable* table) {
+	if (table == migrateFrom || table == migrateTo) {
+		SlottedTable* other = table == migrateFrom ? migrateTo : migrateFrom;
+		migrateFrom = migrateTo = nullptr;
+		if (other->IsEmpty()) {
+			RemoveTable(other);
+		}
+	}
+	tables.erase(find(tables.begin(), tables.end(), table));
+	delete table;
+	generation++;
+}
+
+size_t TupleMergeOnline::Maintain(size_t budget) {
+	if (idleGeneration == generation) {
+		// nothing to do since the last pass over all tables
+		return 0;
+	}
+	size_t work = 0;
+	size_t examined = 0;
+	size_t moved = 0;
+	while (work < budget && !tables.empty()) {
+		if (!migrateFrom) {
+			// each table is examined at most once per call
+			if (examined == tables.size()) {
+				if (!moved) idleGeneration = generation;
+				break;
+			}
+			examined++;
+			work++;
+			SelectMigration();
+			continue;
+		}
+		size_t n = Migrate(budget - work);
+		work += n;
+		moved += n;
+	}
+	if (moved) {
 		Resort();
 	}
+	maintainMoved += moved;
+	return work;
+}
+
+int TupleMergeOnline::LowOccupancy() const {
+	return max(collideLimit, int(assignments.size() / (tables.size() * 8)));
+}
+
+bool TupleMergeOnline::SelectMigration() {
+	SlottedTable* source = tables[maintainCursor++ % tables.size()];
+	if (source->NumRules() > LowOccupancy()) return false;
+	vector<Rule> rl = source->GetRules();
+	Tuple sourceTuple(rl[0].dim);
+	source->GetTuple(sourceTuple);
+	SlottedTable* target = MergeTarget(source);
+	if (target) {
+		// all rules fit in to the chains of the target (upper bound)
+		Tuple tuple(sourceTuple.size());
+		target->GetTuple(tuple);
+		size_t chain = CollisionsForTuple(rl, tuple);
+		size_t longest = 0;
+		for (const Rule& r : rl) {
+			longest = max(longest, target->NumCollisions(r));
+		}
+		if (int(chain + longest) * MERGE_HEADROOM > CollideLimit(target)) {
+			target = nullptr;
+		}
+	}
+	if (!target) {
+		// the looser tuple of source and of another sparse table
+		// with the most specific fields
+		Tuple best;
+		SlottedTable* other = nullptr;
+		int bestSum = -1;
+		for (auto t : tables) {
+			if (t == source || t->NumRules() > LowOccupancy()) continue;
+			Tuple tuple(sourceTuple.size());
+			t->GetTuple(tuple);
+			for (size_t d = 0; d < tuple.size(); d++) {
+				tuple[d] = min(tuple[d], sourceTuple[d]);
+			}
+			if (Sum(tuple) <= bestSum) continue;
+			vector<Rule> both = t->GetRules();
+			both.insert(both.end(), rl.begin(), rl.end());
+			if (int(CollisionsForTuple(both, tuple)) * MERGE_HEADROOM > collideLimit) continue;
+			best = tuple;
+			bestSum = Sum(tuple);
+			other = t;
+		}
+		if (bestSum < 0) return false;
+		target = FindOrMake(best);
+		if (target == source) {
+			// source has the looser tuple, the other table is drained
+			source = other;
+		}
+	}
+	migrateFrom = source;
+	migrateTo = target;
+	return true;
+}
+
+size_t TupleMergeOnline::Migrate(size_t budget) {
+	bool ignore;
+	vector<cmap_node*> nodes = migrateFrom->GetNodes();
+	size_t moved = 0;
+	for (cmap_node* node : nodes) {
+		if (moved == budget) return moved;
+		Move(node, migrateTo, ignore);
+		if (int(migrateTo->NumCollisions(*node->rule_ptr)) * MERGE_HEADROOM > CollideLimit(migrateTo)) {
+			Move(node, migrateFrom, ignore);
+			CancelMigration();
+			return moved;
+		}
+		moved++;
+	}
+	RemoveTable(migrateFrom);
+	maintainMerged++;
+	return moved;
+}
+
+void TupleMergeOnline::CancelMigration() {
+	SlottedTable* target = migrateTo;
+	migrateFrom = migrateTo = nullptr;
+	if (target->IsEmpty()) {
+		RemoveTable(target);
+	}
+}
+
+double TupleMergeOnline::ProbeFraction(const SlottedTable* table) const {
+	uint64_t n = lookups - table->stats.since;
+	return n ? min(1.0, double(table->stats.probes) / n) : 1;
+}
+
+double TupleMergeOnline::HitFraction(const SlottedTable* table) const {
+	const auto& s = table->stats;
+	return s.probes ? double(s.hits) / s.probes : 1;
+}
+
+int TupleMergeOnline::CollideLimit(const SlottedTable* table) const {
+	if (!adaptive) return collideLimit;
+	double h = HitFraction(table);
+	if (h * ruleCost * collideLimitMax <= tableCost) return collideLimitMax;
+	return max(2, min(collideLimitMax, int(tableCost / (ruleCost * h))));
+}
+
+double TupleMergeOnline::ExpectedLookupCost() const {
+	double cost = 0;
+	for (auto t : tables) {
+		const auto& s = t->stats;
+		double checks = s.probes ? double(s.checks) / s.probes : 1;
+		cost += ProbeFraction(t) * (tableCost + ruleCost * checks);
+	}
+	return cost;
+}
+
+void TupleMergeOnline::CollectStats(map<string, string> &summary) const {
+	summary["TM.Policy"] = adaptive ? "Adaptive" : "Classic";
+	summary["TM.Splits"] = to_string(splits);
+	summary["TM.Merges"] = to_string(merges);
+	summary["TM.RelaxLevel"] = to_string(relaxLevel);
+	if (adaptive) {
+		summary["TM.ExpectedCost"] = to_string(ExpectedLookupCost());
+	}
+	summary["TM.Maintain.Moved"] = to_string(maintainMoved);
+	summary["TM.Maintain.Merged"] = to_string(maintainMerged);
 }
 
 SlottedTable* TupleMergeOnline::FindOrMake(const Tuple& t) {
@@ -224,6 +533,8 @@ SlottedTable* TupleMergeOnline::FindOrMake(const Tuple& t) {
 		}
 	}
 	SlottedTable* table = new SlottedTable(t);
+	table->stats.since = lookups;
 	tables.push_back(table);
+	generation++;
 	return table;
 }
@@ -28,9 +28,43 @@
 #include "SlottedTable.h"
 
 namespace ForgeUtils {
-	void Crazify(TupleMergeUtils::Tuple& tuple);
+	// level scales the shortening of the address prefixes (1 = TupleMerge)
+	void Crazify(TupleMergeUtils::Tuple& tuple, double level = 1);
 }
 
+/**
+ * TupleMerge with the incremental updates
+ *
+ * The splits and merges of the tables are selected by TM.Policy:
+ *
+ * Classic (the default) is the heuristic of the TupleMerge paper. A table is split when an
+ * insert makes a chain of more than TM.Limit.Collide colliding rules (on the
+ * dimension with the largest difference of the prefix lengths of the colliding
+ * rules) and the tuple of a new table is relaxed by fixed address lengths.
+ *
+ * Adaptive minimizes the expected cost of a lookup
+ *   sum over the tables t: f(t) * (TM.Cost.Table + h(t) * chain(t) * TM.Cost.Rule)
+ * where f(t) is the fraction of the lookups which probe t and h(t) the fraction
+ * of the probes which find a chain of rules, both counted by the lookups
+ * (1 before the first lookup, which gives the Classic limit):
+ * - the collision limit of a table is the chain which costs as much as a probe
+ *   of another table, TM.Cost.Table / (TM.Cost.Rule * h(t)), clamped to
+ *   [2, TM.Limit.Collide.Max]
+ * - the split is on the dimension which leaves the shortest chain, useless
+ *   splits (the chain is not shorter) are skipped
+ * - after a delete, a table is merged in to a table which can take its rules
+ *   when the probe saved costs more than the longer chains (up to a quarter
+ *   of the collision limit)
+ * - the relaxation of the tuples of the new tables (0 - 2x of Classic) goes
+ *   down with the splits and up with the tables created for a single rule,
+ *   it is not changed by the construction
+ *
+ * Maintain drains the sparse tables (less rules than TM.Limit.Collide or than
+ * 1/8 of the average table) in to a table which can take their rules, or in to
+ * a new table with the looser tuple of two sparse tables. The rules are moved
+ * one by one, so a migration can span more calls and the lookups and updates
+ * between the calls see each rule in exactly one table.
+ */
 class TupleMergeOnline : public PacketClassifier {
 public:
 	TupleMergeOnline(const std::unordered_map<std::string, std::string>& args);
@@ -38,15 +72,17 @@ public:
 	
 	virtual void _ConstructClassifier(const std::vector<Rule>& rules);
 	virtual int ClassifyAPacket(const Packet& p);
-	virtual void DeleteRule(size_t index);
-	virtual void InsertRule(const Rule& r);
+	virtual void _DeleteRule(size_t index);
+	virtual void _InsertRule(const Rule& r);
+	// a single sort of the tables after all updates
+	virtual void _ApplyUpdates(const std::vector<size_t>& deleted, const std::vector<const Rule*>& inserted);
 	virtual Memory MemSizeBytes() const {
 		int ruleSizeBytes = 19; // TODO variables sizes
 		int sizeBytes = 0;
 		for (const auto table : tables) {
 			sizeBytes += table->MemSizeBytes(ruleSizeBytes);
 		}
-		int assignmentsSizeBytes = rules.size() * POINTER_SIZE_BYTES;
+		int assignmentsSizeBytes = assignments.size() * 2 * POINTER_SIZE_BYTES;
 		int arraySize = tables.size() * POINTER_SIZE_BYTES;
 		return sizeBytes + assignmentsSizeBytes + arraySize;
 	}
@@ -58,24 +94,84 @@ public:
 		}*/
 		return cost;
 	}
+	virtual bool SupportsMemoryAccessTrace() const {
+		return true;
+	}
+	virtual bool SupportsWideFields() const {
+		return true;
+	}
 	virtual size_t NumTables() const { return tables.size(); }
 	virtual size_t RulesInTable(size_t index) const { return tables[index]->NumRules(); }
 	virtual size_t PriorityOfTable(size_t index) const {
 		return tables[index]->MaxPriority();
 	}
+	virtual void CollectStats(std::map<std::string, std::string> &summary) const;
+	virtual size_t Maintain(size_t budget);
+
+	// expected cost of a lookup by the Adaptive cost model
+	double ExpectedLookupCost() const;
 
 protected:
 	void Resort() {
 		sort(tables.begin(), tables.end(), [](auto& tx, auto& ty) { return tx->MaxPriority() > ty->MaxPriority(); });
 	}
+	// the updates without the sort of the tables (true if the tables need it)
+	bool Delete(size_t index);
+	bool Insert(const Rule& rule);
 	SlottedTable* FindOrMake(const TupleMergeUtils::Tuple& t);
+	void RemoveTable(SlottedTable* table);
+
+	// the cost model of the Adaptive policy
+	double ProbeFraction(const SlottedTable* table) const;
+	double HitFraction(const SlottedTable* table) const;
+	int CollideLimit(const SlottedTable* table) const;
+	// split of the table after the insert of rule (returns the target or nullptr)
+	SlottedTable* Split(SlottedTable* table, const Rule& rule, bool& hasChanged);
+	// merge of the table in to a table which can take its rules
+	bool TryMerge(SlottedTable* table);
+	// the cheapest table which can take the rules of table (or nullptr)
+	SlottedTable* MergeTarget(const SlottedTable* table) const;
+
+	// the maintenance (migrateFrom -> migrateTo)
+	int LowOccupancy() const;
+	bool SelectMigration();
+	size_t Migrate(size_t budget);
+	void CancelMigration();
 	
-	std::vector<SlottedTable*> tables;
-	std::unordered_map<int, SlottedTable*> assignments; // Priority -> Table
+	// the table of the rule and its node (node->key is the index of the rule)
+	struct Assignment {
+		SlottedTable* table;
+		cmap_node* node;
+	};
+	// the rule in a new node of table at the index
+	void Assign(size_t index, SlottedTable* table, const Rule& rule, bool& hasChanged);
+	// moves the node from its table to the table
+	void Move(cmap_node* node, SlottedTable* table, bool& hasChanged);
 
-	std::vector<Rule> rules;
+	std::vector<SlottedTable*> tables;
+	std::vector<Assignment> assignments; // Index of rule -> Table
 
 	int collideLimit;
+	bool adaptive;
+	int collideLimitMax;
+	double tableCost;
+	double ruleCost;
+	double relaxLevel;
+	// the relaxation level is kept during _ConstructClassifier
+	bool constructing = false;
+
+	uint64_t lookups = 0;
+	size_t splits = 0;
+	size_t merges = 0;
+
+	SlottedTable* migrateFrom = nullptr;
+	SlottedTable* migrateTo = nullptr;
+	size_t maintainCursor = 0;
+	// changes of the tables, Maintain is idle until the next change
+	uint64_t generation = 0;
+	uint64_t idleGeneration = UINT64_MAX;
+	size_t maintainMoved = 0;
+	size_t maintainMerged = 0;
 };
 
 
@@ -0,0 +1,106 @@
+/*
+ * Replacement of the global operator new/delete which reports
+ * the allocations to the AllocationTracker (if enabled)
+ *
+ * Has to be linked to the executable (the replacement functions
+ * have to be defined in the program).
+ */
+#include "AllocationTracker.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+static inline void* tracked_alloc(std::size_t size) {
+	void *p = std::malloc(size ? size : 1);
+	if (__builtin_expect(AllocationTracker::enabled, 0))
+		AllocationTracker::Allocated(p);
+	return p;
+}
+
+static inline void* tracked_aligned_alloc(std::size_t size,
+		std::align_val_t al) {
+	void *p = nullptr;
+	std::size_t a = std::max(static_cast<std::size_t>(al), sizeof(void*));
+	if (posix_memalign(&p, a, size ? size : 1) != 0)
+		return nullptr;
+	if (__builtin_expect(AllocationTracker::enabled, 0))
+		AllocationTracker::Allocated(p);
+	return p;
+}
+
+static inline void tracked_free(void *p) noexcept {
+	if (__builtin_expect(AllocationTracker::enabled, 0))
+		AllocationTracker::Released(p);
+	std::free(p);
+}
+
+void* operator new(std::size_t size) {
+	void *p = tracked_alloc(size);
+	if (p == nullptr)
+		throw std::bad_alloc();
+	return p;
+}
+void* operator new[](std::size_t size) {
+	return operator new(size);
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	return tracked_alloc(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	return tracked_alloc(size);
+}
+void* operator new(std::size_t size, std::align_val_t al) {
+	void *p = tracked_aligned_alloc(size, al);
+	if (p == nullptr)
+		throw std::bad_alloc();
+	return p;
+}
+void* operator new[](std::size_t size, std::align_val_t al) {
+	return operator new(size, al);
+}
+void* operator new(std::size_t size, std::align_val_t al,
+		const std::nothrow_t&) noexcept {
+	return tracked_aligned_alloc(size, al);
+}
+void* operator new[](std::size_t size, std::align_val_t al,
+		const std::nothrow_t&) noexcept {
+	return tracked_aligned_alloc(size, al);
+}
+
+void operator delete(void *p) noexcept {
+	tracked_free(p);
+}
+void operator delete[](void *p) noexcept {
+	tracked_free(p);
+}
+void operator delete(void *p, std::size_t) noexcept {
+	tracked_free(p);
+}
+void operator delete[](void *p, std::size_t) noexcept {
+	tracked_free(p);
+}
+void operator delete(void *p, const std::nothrow_t&) noexcept {
+	tracked_free(p);
+}
+void operator delete[](void *p, const std::nothrow_t&) noexcept {
+	tracked_free(p);
+}
+void operator delete(void *p, std::align_val_t) noexcept {
+	tracked_free(p);
+}
+void operator delete[](void *p, std::align_val_t) noexcept {
+	tracked_free(p);
+}
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+	tracked_free(p);
+}
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept {
+	tracked_free(p);
+}
+void operator delete(void *p, std::align_val_t, const std::nothrow_t&) noexcept {
+	tracked_free(p);
+}
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t&) noexcept {
+	tracked_free(p);
+}
@@ -0,0 +1,45 @@
+#include "AllocationTracker.h"
+
+#include <algorithm>
+#include <malloc.h>
+
+using namespace std;
+
+bool AllocationTracker::enabled = false;
+
+// stats of the innermost scope of the thread
+static thread_local AllocationTracker::Stats *current_stats = nullptr;
+
+AllocationTracker::Scope::Scope(Stats &stats) :
+		prev(current_stats) {
+	current_stats = &stats;
+}
+
+AllocationTracker::Scope::~Scope() {
+	current_stats = prev;
+}
+
+void AllocationTracker::Allocated(void *ptr) {
+	Stats *s = current_stats;
+	if (s == nullptr || ptr == nullptr)
+		return;
+	s->live_bytes += malloc_usable_size(ptr);
+	s->peak_bytes = std::max(s->peak_bytes, s->live_bytes);
+	s->allocations++;
+}
+
+void AllocationTracker::Released(void *ptr) {
+	Stats *s = current_stats;
+	if (s == nullptr || ptr == nullptr)
+		return;
+	s->live_bytes -= malloc_usable_size(ptr);
+	s->deallocations++;
+}
+
+void AllocationTracker::Stats::Report(map<string, string> &summary,
+		const string &prefix) const {
+	summary[prefix + ".Live(bytes)"] = to_string(live_bytes);
+	summary[prefix + ".Peak(bytes)"] = to_string(peak_bytes);
+	summary[prefix + ".Allocations"] = to_string(allocations);
+	summary[prefix + ".Deallocations"] = to_string(deallocations);
+}
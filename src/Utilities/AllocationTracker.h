@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+ * Accounting of the heap memory allocated by the classifiers
+ *
+ * The global operator new/delete (AllocationHooks.cpp, linked to the main
+ * executable) and the malloc based allocator of the cmap hash tables
+ * (OVS/cmap.cpp) report each allocation to the Stats of the Scope which is
+ * active in the calling thread. The size of the allocation is the usable
+ * size of the malloc block, so the values correspond to the real heap usage
+ * (without the allocator metadata). Memory released in a different scope
+ * than it was allocated in is subtracted from the stats of the scope
+ * which released it.
+ */
+class AllocationTracker {
+public:
+	struct Stats {
+		int64_t live_bytes = 0;
+		int64_t peak_bytes = 0;
+		uint64_t allocations = 0;
+		uint64_t deallocations = 0;
+
+		/**
+		 * Store the stats as "<prefix>.Live(bytes)", "<prefix>.Peak(bytes)",
+		 * "<prefix>.Allocations" and "<prefix>.Deallocations"
+		 */
+		void Report(std::map<std::string, std::string> &summary,
+				const std::string &prefix) const;
+	};
+
+	/**
+	 * The allocations of the calling thread are accounted to the stats
+	 * while the scope exists (scopes can be nested)
+	 */
+	class Scope {
+	public:
+		Scope(Stats &stats);
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		~Scope();
+	private:
+		Stats *prev;
+	};
+
+	// tracking has to be enabled explicitly, otherwise the hooks only check this flag
+	static bool enabled;
+
+	static void Allocated(void *ptr);
+	static void Released(void *ptr);
+};
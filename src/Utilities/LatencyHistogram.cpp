@@ -0,0 +1,74 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+LatencyHistogram::LatencyHistogram() {
+	clear();
+}
+
+void LatencyHistogram::clear() {
+	counts.fill(0);
+	total = 0;
+	max_value = 0;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+	for (unsigned i = 0; i < BUCKET_CNT; i++)
+		counts[i] += other.counts[i];
+	total += other.total;
+	max_value = std::max(max_value, other.max_value);
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(unsigned index) {
+	if (index < SUB_BUCKET_CNT)
+		return index;
+	unsigned shift = index / SUB_BUCKET_CNT;
+	unsigned sub = index % SUB_BUCKET_CNT;
+	uint64_t low = uint64_t(SUB_BUCKET_CNT + sub) << (shift - 1);
+	return low + (uint64_t(1) << (shift - 1)) - 1;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+	if (total == 0)
+		return 0;
+	uint64_t rank = std::max<uint64_t>(1, ceil(p / 100.0 * total));
+	uint64_t seen = 0;
+	for (unsigned i = 0; i < BUCKET_CNT; i++) {
+		seen += counts[i];
+		if (seen >= rank)
+			return min(BucketUpperBound(i), max_value);
+	}
+	return max_value;
+}
+
+double LatencyHistogram::CyclesPerNs() {
+	static const double cycles_per_ns = []() {
+		auto t0 = chrono::steady_clock::now();
+		uint64_t c0 = Start();
+		while (chrono::steady_clock::now() - t0 < chrono::milliseconds(20))
+			;
+		uint64_t c1 = Stop();
+		auto t1 = chrono::steady_clock::now();
+		double ns = chrono::duration<double, nano>(t1 - t0).count();
+		return (c1 - c0) / ns;
+	}();
+	return cycles_per_ns;
+}
+
+void LatencyHistogram::Report(map<string, string> &summary,
+		const string &prefix) const {
+	if (total == 0)
+		return;
+	double f = CyclesPerNs();
+	const pair<const char*, double> percentiles[] = { { "p50", 50 }, { "p90",
+			90 }, { "p99", 99 }, { "p99.9", 99.9 } };
+	for (auto &p : percentiles) {
+		summary[prefix + "." + p.first + "(ns)"] = to_string(
+				percentile(p.second) / f);
+	}
+	summary[prefix + ".max(ns)"] = to_string(max_value / f);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+/**
+ * Histogram of the operation latencies with logarithmic buckets (HDR style)
+ *
+ * Each power of 2 is split to 2^SUB_BUCKET_BITS linear sub-buckets,
+ * which gives the relative error of the reported values < 1/2^SUB_BUCKET_BITS.
+ * The values are in the cycles of the time stamp counter.
+ */
+class LatencyHistogram {
+public:
+	static constexpr unsigned SUB_BUCKET_BITS = 5;
+	static constexpr unsigned SUB_BUCKET_CNT = 1 << SUB_BUCKET_BITS;
+	static constexpr unsigned MAX_VALUE_BITS = 48;
+	static constexpr unsigned BUCKET_CNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS
+			+ 1) * SUB_BUCKET_CNT;
+
+	LatencyHistogram();
+
+	void record(uint64_t value) {
+		counts[BucketIndex(value)]++;
+		total++;
+		if (value > max_value)
+			max_value = value;
+	}
+	void merge(const LatencyHistogram &other);
+	void clear();
+
+	uint64_t count() const {
+		return total;
+	}
+	uint64_t max() const {
+		return max_value;
+	}
+	/**
+	 * @param p percentile 0-100
+	 * @return upper bound of the bucket which contains the percentile
+	 */
+	uint64_t percentile(double p) const;
+
+	/**
+	 * Store p50/p90/p99/p99.9/max in nanoseconds as "<prefix>.p50(ns)" ...
+	 * (nothing if the histogram is empty)
+	 */
+	void Report(std::map<std::string, std::string> &summary,
+			const std::string &prefix) const;
+
+	// time stamp counter for the start and end of the measured operation
+	static inline uint64_t Start() {
+#if defined(__x86_64__) || defined(__i386__)
+		_mm_lfence();
+		return __rdtsc();
+#else
+		return NowNs();
+#endif
+	}
+	static inline uint64_t Stop() {
+#if defined(__x86_64__) || defined(__i386__)
+		unsigned aux;
+		uint64_t t = __rdtscp(&aux);
+		_mm_lfence();
+		return t;
+#else
+		return NowNs();
+#endif
+	}
+	// frequency of the counter used by Start()/Stop() (measured on first use)
+	static double CyclesPerNs();
+
+private:
+#if !(defined(__x86_64__) || defined(__i386__))
+	static inline uint64_t NowNs() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+#endif
+	static inline unsigned BucketIndex(uint64_t value) {
+		if (value < SUB_BUCKET_CNT)
+			return value;
+		unsigned msb = 63 - __builtin_clzll(value);
+		if (msb >= MAX_VALUE_BITS)
+			return BUCKET_CNT - 1;
+		unsigned shift = msb - SUB_BUCKET_BITS + 1;
+		return shift * SUB_BUCKET_CNT + ((value >> (shift - 1)) & (SUB_BUCKET_CNT - 1));
+	}
+	static uint64_t BucketUpperBound(unsigned index);
+
+	std::array<uint64_t, BUCKET_CNT> counts;
+	uint64_t total;
+	uint64_t max_value;
+};
+
+/**
+ * Select each n-th operation for the latency measurement
+ */
+class LatencySampler {
+public:
+	// @param period 0 = disabled
+	LatencySampler(size_t period) :
+			period(period), cnt(period) {
+	}
+	inline bool operator()() {
+		if (period == 0)
+			return false;
+		if (--cnt == 0) {
+			cnt = period;
+			return true;
+		}
+		return false;
+	}
+private:
+	size_t period;
+	size_t cnt;
+};
@@ -0,0 +1,11 @@
+#include "MemoryAccessTrace.h"
+
+#include <algorithm>
+
+MemoryAccessTrace *MemoryAccessTrace::active = nullptr;
+
+size_t MemoryAccessTrace::End() {
+	std::sort(lines.begin(), lines.end());
+	lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+	return lines.size();
+}
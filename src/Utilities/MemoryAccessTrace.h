@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Recorder of the memory touched by a classifier during the lookup of a packet
+ *
+ * The lookup paths of the classifiers report each node/bucket/rule they read
+ * by MEMORY_ACCESS_TRACE(ptr, size) and the recorder collects the distinct
+ * cache lines. The macro is compiled only in the builds with
+ * MEMORY_ACCESS_TRACE_ENABLED (meson configure -Dmemory_trace=true), it is
+ * empty otherwise so the lookups of the regular build are not instrumented.
+ * In the instrumented build the tracing is enabled only while a recorder is
+ * installed in MemoryAccessTrace::active. The recorder is global (not per
+ * thread), the traced lookups have to run in a single thread.
+ */
+class MemoryAccessTrace {
+public:
+	static constexpr size_t CACHE_LINE_SIZE = 64;
+#ifdef MEMORY_ACCESS_TRACE_ENABLED
+	static constexpr bool ENABLED = true;
+#else
+	static constexpr bool ENABLED = false;
+#endif
+	// recorder which receives the accesses, nullptr = tracing disabled
+	static MemoryAccessTrace *active;
+
+	MemoryAccessTrace() :
+			touches(0) {
+	}
+
+	// start the trace of a new lookup
+	void Begin() {
+		lines.clear();
+		touches = 0;
+	}
+	/**
+	 * Finish the trace of the lookup
+	 * @return number of distinct cache lines touched by the lookup
+	 */
+	size_t End();
+
+	inline void Touch(const void *ptr, size_t size) {
+		uintptr_t a = reinterpret_cast<uintptr_t>(ptr);
+		uintptr_t last = (a + (size ? size - 1 : 0)) / CACHE_LINE_SIZE;
+		for (uintptr_t l = a / CACHE_LINE_SIZE; l <= last; l++)
+			lines.push_back(l);
+		touches++;
+	}
+	// number of MEMORY_ACCESS_TRACE calls in the last lookup
+	size_t Touches() const {
+		return touches;
+	}
+	// distinct cache lines (address / CACHE_LINE_SIZE) of the last lookup, valid after End()
+	const std::vector<uintptr_t>& Lines() const {
+		return lines;
+	}
+
+private:
+	std::vector<uintptr_t> lines;
+	size_t touches;
+};
+
+#ifdef MEMORY_ACCESS_TRACE_ENABLED
+#define MEMORY_ACCESS_TRACE(ptr, size)                                        \
+	do {                                                                      \
+		if (__builtin_expect(MemoryAccessTrace::active != nullptr, 0))       \
+			MemoryAccessTrace::active->Touch((ptr), (size));                  \
+	} while (0)
+#else
+#define MEMORY_ACCESS_TRACE(ptr, size) do {} while (0)
+#endif
@@ -0,0 +1,145 @@
+#include "PerfCounters.h"
+
+#include <cstring>
+#include <cstdio>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+bool PerfCounters::enabled = true;
+
+const array<const char*, PerfCounters::EVENT_CNT> PerfCounters::EVENT_NAMES = {
+		"Cycles", "Instructions", "L1DMisses", "LLCMisses", "dTLBMisses",
+		"BranchMisses" };
+
+void PerfCounters::Values::merge(const Values &other) {
+	for (size_t i = 0; i < EVENT_CNT; i++) {
+		if (other.valid[i]) {
+			count[i] += other.count[i];
+			valid[i] = true;
+		}
+	}
+}
+
+void PerfCounters::Values::Report(map<string, string> &summary,
+		const string &prefix, uint64_t op_cnt) const {
+	for (size_t i = 0; i < EVENT_CNT; i++) {
+		if (!valid[i])
+			continue;
+		summary[prefix + "." + EVENT_NAMES[i]] = to_string(count[i]);
+		if (op_cnt && i != Cycles && i != Instructions)
+			summary[prefix + "." + EVENT_NAMES[i] + "/op"] = to_string(
+					double(count[i]) / op_cnt);
+	}
+	if (valid[Cycles] && valid[Instructions] && count[Cycles])
+		summary[prefix + ".IPC"] = to_string(
+				double(count[Instructions]) / count[Cycles]);
+}
+
+#ifdef __linux__
+
+static uint64_t HwCacheConfig(uint64_t cache, uint64_t op, uint64_t result) {
+	return cache | (op << 8) | (result << 16);
+}
+
+static int OpenCounter(uint32_t type, uint64_t config) {
+	perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+			| PERF_FORMAT_TOTAL_TIME_RUNNING;
+	// this thread only, any cpu
+	return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+PerfCounters::PerfCounters() {
+	fds.fill(-1);
+	if (!enabled)
+		return;
+	const pair<uint32_t, uint64_t> events[EVENT_CNT] = {
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+			{ PERF_TYPE_HW_CACHE, HwCacheConfig(PERF_COUNT_HW_CACHE_L1D,
+					PERF_COUNT_HW_CACHE_OP_READ,
+					PERF_COUNT_HW_CACHE_RESULT_MISS) },
+			{ PERF_TYPE_HW_CACHE, HwCacheConfig(PERF_COUNT_HW_CACHE_LL,
+					PERF_COUNT_HW_CACHE_OP_READ,
+					PERF_COUNT_HW_CACHE_RESULT_MISS) },
+			{ PERF_TYPE_HW_CACHE, HwCacheConfig(PERF_COUNT_HW_CACHE_DTLB,
+					PERF_COUNT_HW_CACHE_OP_READ,
+					PERF_COUNT_HW_CACHE_RESULT_MISS) },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }, };
+	bool any = false;
+	for (size_t i = 0; i < EVENT_CNT; i++) {
+		fds[i] = OpenCounter(events[i].first, events[i].second);
+		any |= fds[i] >= 0;
+	}
+	static bool warned = false;
+	if (!any && !warned) {
+		warned = true;
+		printf("warning: perf_event_open failed, hardware counters are not collected"
+				" (check /proc/sys/kernel/perf_event_paranoid)\n");
+	}
+}
+
+PerfCounters::~PerfCounters() {
+	for (int fd : fds)
+		if (fd >= 0)
+			close(fd);
+}
+
+void PerfCounters::Start() {
+	for (int fd : fds) {
+		if (fd >= 0) {
+			ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+}
+
+void PerfCounters::Stop() {
+	for (int fd : fds)
+		if (fd >= 0)
+			ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+	for (size_t i = 0; i < EVENT_CNT; i++) {
+		if (fds[i] < 0)
+			continue;
+		// value, time enabled, time running
+		uint64_t data[3];
+		if (read(fds[i], data, sizeof(data)) != sizeof(data) || data[2] == 0)
+			continue;
+		uint64_t v = data[0];
+		if (data[2] < data[1])
+			v = uint64_t(double(v) * data[1] / data[2]);
+		accumulated.count[i] += v;
+		accumulated.valid[i] = true;
+	}
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+	fds.fill(-1);
+}
+
+PerfCounters::~PerfCounters() {
+}
+
+void PerfCounters::Start() {
+}
+
+void PerfCounters::Stop() {
+}
+
+#endif
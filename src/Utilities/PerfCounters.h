@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+ * Hardware performance counters of the calling thread (Linux perf_event_open),
+ * an alternative to likwid which does not require root or the msr module
+ *
+ * The counters which are not supported (or not allowed by perf_event_paranoid)
+ * are skipped, the values are scaled if the counters were multiplexed.
+ */
+class PerfCounters {
+public:
+	enum Event {
+		Cycles,
+		Instructions,
+		L1DMisses,
+		LLCMisses,
+		DTLBMisses,
+		BranchMisses,
+		EVENT_CNT
+	};
+	static const std::array<const char*, EVENT_CNT> EVENT_NAMES;
+
+	struct Values {
+		std::array<uint64_t, EVENT_CNT> count { };
+		std::array<bool, EVENT_CNT> valid { };
+		void merge(const Values &other);
+		/**
+		 * Store the counters as "<prefix>.<event>", IPC and "<prefix>.<event>/op"
+		 * if op_cnt is not 0
+		 */
+		void Report(std::map<std::string, std::string> &summary,
+				const std::string &prefix, uint64_t op_cnt) const;
+	};
+
+	// collection can be disabled globally (the counters are not opened at all)
+	static bool enabled;
+
+	/**
+	 * Open the counters for the calling thread (the counters are stopped)
+	 */
+	PerfCounters();
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+	~PerfCounters();
+
+	void Start();
+	// stop the counters and add the values to the accumulated values
+	void Stop();
+
+	const Values& values() const {
+		return accumulated;
+	}
+
+private:
+	std::array<int, EVENT_CNT> fds;
+	Values accumulated;
+};
@@ -0,0 +1,100 @@
+#include "PriorityTracker.h"
+
+using namespace std;
+
+void PriorityTracker::Clear() {
+	count = 0;
+	maxPriority = -1;
+	spilled = false;
+	small.clear();
+	words.clear();
+	summary.clear();
+	duplicates.clear();
+}
+
+size_t PriorityTracker::MemSizeBytes() const {
+	return small.capacity() * sizeof(int)
+			+ words.capacity() * sizeof(uint64_t)
+			+ summary.capacity() * sizeof(uint64_t)
+			+ duplicates.capacity() * sizeof(int);
+}
+
+void PriorityTracker::Spill() {
+	vector<int> priorities;
+	priorities.swap(small);
+	spilled = true;
+	base = priorities.front() & ~63;
+	words.assign((priorities.back() - base) / 64 + 1, 0);
+	summary.assign((words.size() + 63) / 64, 0);
+	count = 0;
+	for (int p : priorities)
+		Insert(p);
+	// the capacity is kept for the Unspill
+	priorities.clear();
+	small.swap(priorities);
+}
+
+void PriorityTracker::Unspill() {
+	small.clear();
+	for (size_t w = 0; w < words.size(); w++) {
+		for (uint64_t bits = words[w]; bits; bits &= bits - 1)
+			small.push_back(base + int(w * 64) + __builtin_ctzll(bits));
+	}
+	if (!duplicates.empty()) {
+		size_t n = small.size();
+		small.insert(small.end(), duplicates.begin(), duplicates.end());
+		inplace_merge(small.begin(), small.begin() + n, small.end());
+	}
+	spilled = false;
+	words.clear();
+	summary.clear();
+	duplicates.clear();
+	maxPriority = small.empty() ? -1 : small.back();
+}
+
+void PriorityTracker::Grow(int priority) {
+	// the words of the range with a priority (the priorities only grow
+	// for the new rules, so the old words are dropped)
+	size_t first = 0, last = words.size();
+	while (first < last && !words[first])
+		first++;
+	while (last > first && !words[last - 1])
+		last--;
+	int low = base + int(first * 64), high = base + int(last * 64);
+	if (first == last)
+		low = high = priority & ~63;
+	// the range is doubled in the direction of the priority,
+	// so the bitmap is copied O(log) times
+	int span = max(high - low, 64);
+	if (priority < low)
+		low = max(0, min(priority & ~63, low - span));
+	else
+		high = max(priority + 1, high + span);
+	vector<uint64_t> grown((high - low + 63) / 64, 0);
+	for (size_t w = first; w < last; w++)
+		grown[w - (low - base) / 64] = words[w];
+	words.swap(grown);
+	base = low;
+	summary.assign((words.size() + 63) / 64, 0);
+	for (size_t w = 0; w < words.size(); w++) {
+		if (words[w])
+			summary[w / 64] |= 1ull << (w % 64);
+	}
+}
+
+int PriorityTracker::Below(size_t i) const {
+	size_t w = i / 64;
+	uint64_t bits = words[w] & (~0ull >> (63 - i % 64));
+	if (bits)
+		return base + int(w * 64) + 63 - __builtin_clzll(bits);
+	// the last non-zero word before w
+	size_t s = w / 64;
+	uint64_t nonzero = summary[s] & ((1ull << (w % 64)) - 1);
+	while (!nonzero) {
+		if (s == 0)
+			return -1;
+		nonzero = summary[--s];
+	}
+	w = s * 64 + 63 - __builtin_clzll(nonzero);
+	return base + int(w * 64) + 63 - __builtin_clzll(words[w]);
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Multiset of the rule priorities (>= 0) of a table which answers the max priority
+ *
+ * It replaces the std::multiset<int> of the tables (a node allocation and
+ * a rebalance per update). Up to SMALL priorities are kept in a sorted vector.
+ * The larger sets spill in to a bitmap over the range of the priorities with
+ * a summary bit per bitmap word, so the next max after an erase is found by
+ * two bit scans. The further copies of a priority which is already in the
+ * bitmap are in a sorted vector of duplicates. The memory is allocated only
+ * when the set grows (the vector capacity, the bitmap range).
+ */
+class PriorityTracker {
+public:
+	static constexpr size_t SMALL = 64;
+
+	void Insert(int priority) {
+		count++;
+		maxPriority = std::max(maxPriority, priority);
+		if (!spilled) {
+			small.insert(std::upper_bound(small.begin(), small.end(), priority),
+					priority);
+			if (small.size() > SMALL)
+				Spill();
+			return;
+		}
+		if (priority < base || priority >= base + int(words.size() * 64))
+			Grow(priority);
+		size_t i = priority - base;
+		if (words[i / 64] & (1ull << (i % 64))) {
+			duplicates.insert(
+					std::upper_bound(duplicates.begin(), duplicates.end(),
+							priority), priority);
+		} else {
+			words[i / 64] |= 1ull << (i % 64);
+			summary[i / 4096] |= 1ull << (i / 64 % 64);
+		}
+	}
+
+	// removes one copy of the priority (it has to be in the set)
+	void Erase(int priority) {
+		count--;
+		if (!spilled) {
+			small.erase(std::lower_bound(small.begin(), small.end(), priority));
+			maxPriority = small.empty() ? -1 : small.back();
+			return;
+		}
+		auto d = std::lower_bound(duplicates.begin(), duplicates.end(),
+				priority);
+		if (d != duplicates.end() && *d == priority) {
+			duplicates.erase(d);
+			return;
+		}
+		size_t i = priority - base;
+		words[i / 64] &= ~(1ull << (i % 64));
+		if (!words[i / 64])
+			summary[i / 4096] &= ~(1ull << (i / 64 % 64));
+		if (count <= SMALL / 2) {
+			Unspill();
+		} else if (priority == maxPriority) {
+			maxPriority = Below(i);
+		}
+	}
+
+	bool Contains(int priority) const {
+		if (!spilled)
+			return std::binary_search(small.begin(), small.end(), priority);
+		if (priority < base || priority >= base + int(words.size() * 64))
+			return false;
+		size_t i = priority - base;
+		return words[i / 64] & (1ull << (i % 64));
+	}
+
+	// -1 if the set is empty
+	int Max() const {
+		return maxPriority;
+	}
+	bool Empty() const {
+		return count == 0;
+	}
+	size_t Size() const {
+		return count;
+	}
+	void Clear();
+	size_t MemSizeBytes() const;
+
+private:
+	// moves the small set in to the bitmap
+	void Spill();
+	// moves the bitmap in to the small set
+	void Unspill();
+	// extends the bitmap range to the priority
+	void Grow(int priority);
+	// the max priority in the bitmap at the position <= i (-1 if there is none)
+	int Below(size_t i) const;
+
+	size_t count = 0;
+	int maxPriority = -1;
+	bool spilled = false;
+	std::vector<int> small;
+	// bitmap of the priorities base, base + 1, ...
+	int base = 0;
+	std::vector<uint64_t> words;
+	// bit per word of the bitmap, set if the word is not 0
+	std::vector<uint64_t> summary;
+	std::vector<int> duplicates;
+};
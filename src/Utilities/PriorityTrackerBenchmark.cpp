@@ -0,0 +1,135 @@
+/**
+ * Update microbenchmark of PriorityTracker against std::multiset<int>
+ *
+ * For each size of the set, a sequence of the updates (erase of a random
+ * priority and insert of a new one, as the churn of the rules of a table) is
+ * replayed on both containers with the max priority read after each update.
+ * The max priorities are compared first, the exit code is non-zero if they
+ * differ.
+ *
+ * usage: priorityTrackerBenchmark [<updates per size>]
+ */
+#include "PriorityTracker.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+
+using namespace std;
+
+struct Update {
+	int erase;
+	int insert;
+};
+
+static void GenerateUpdates(size_t size, size_t count, vector<int> &initial,
+		vector<Update> &updates) {
+	mt19937 rng(size);
+	// the new rules get a higher priority, some priorities are duplicated
+	int next = 0;
+	initial.clear();
+	for (size_t i = 0; i < size; i++) {
+		initial.push_back(rng() % 64 ? next++ : next);
+	}
+	vector<int> live = initial;
+	updates.clear();
+	for (size_t i = 0; i < count; i++) {
+		size_t k = rng() % live.size();
+		int p = rng() % 64 ? next++ : live[rng() % live.size()];
+		updates.push_back( { live[k], p });
+		live[k] = p;
+	}
+}
+
+template<class Set>
+static void Insert(Set &s, int p) {
+	s.insert(p);
+}
+static void Insert(PriorityTracker &s, int p) {
+	s.Insert(p);
+}
+static void Erase(multiset<int> &s, int p) {
+	s.erase(s.find(p));
+}
+static void Erase(PriorityTracker &s, int p) {
+	s.Erase(p);
+}
+static int Max(const multiset<int> &s) {
+	return s.empty() ? -1 : *s.rbegin();
+}
+static int Max(const PriorityTracker &s) {
+	return s.Max();
+}
+
+// ns per update, sum of the max priorities in checksum
+template<class Set>
+static double Run(const vector<int> &initial, const vector<Update> &updates,
+		long long &checksum) {
+	Set s;
+	for (int p : initial)
+		Insert(s, p);
+	checksum = 0;
+	auto start = chrono::steady_clock::now();
+	for (const Update &u : updates) {
+		Erase(s, u.erase);
+		Insert(s, u.insert);
+		checksum += Max(s);
+	}
+	chrono::duration<double, nano> elapsed = chrono::steady_clock::now()
+			- start;
+	return elapsed.count() / updates.size();
+}
+
+static bool Validate(const vector<int> &initial,
+		const vector<Update> &updates) {
+	multiset<int> reference;
+	PriorityTracker tracker;
+	for (int p : initial) {
+		reference.insert(p);
+		tracker.Insert(p);
+	}
+	for (const Update &u : updates) {
+		Erase(reference, u.erase);
+		Erase(tracker, u.erase);
+		Insert(reference, u.insert);
+		Insert(tracker, u.insert);
+		if (Max(reference) != tracker.Max()
+				|| reference.size() != tracker.Size())
+			return false;
+	}
+	// drain to the empty set (the bitmap goes back to the small set)
+	while (!reference.empty()) {
+		int p = *reference.begin();
+		reference.erase(reference.begin());
+		tracker.Erase(p);
+		if (Max(reference) != tracker.Max())
+			return false;
+	}
+	return tracker.Empty();
+}
+
+int main(int argc, char **argv) {
+	size_t count = argc > 1 ? atol(argv[1]) : 1000000;
+	const size_t sizes[] = { 8, 64, 512, 4096, 32768 };
+	vector<int> initial;
+	vector<Update> updates;
+	printf("Size,Updates,multiset(ns),PriorityTracker(ns)\n");
+	for (size_t size : sizes) {
+		GenerateUpdates(size, count, initial, updates);
+		if (!Validate(initial, updates)) {
+			fprintf(stderr, "max priority mismatch (size %zu)\n", size);
+			return EXIT_FAILURE;
+		}
+		long long c1, c2;
+		double t1 = Run<multiset<int>>(initial, updates, c1);
+		double t2 = Run<PriorityTracker>(initial, updates, c2);
+		if (c1 != c2) {
+			fprintf(stderr, "max priority mismatch (size %zu)\n", size);
+			return EXIT_FAILURE;
+		}
+		printf("%zu,%zu,%.1f,%.1f\n", size, count, t1, t2);
+	}
+	return 0;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Stable handles of the elements of a vector with the swap-with-last erase
+ *
+ * The classifiers keep their rules at the indexes 0..N-1, the erase of the
+ * rule at an index moves the last rule to that index. A handle (slot and its
+ * generation) refers to the same rule until it is erased, the slot is then
+ * reused with a new generation so the old handles are detected as stale.
+ * All operations are O(1).
+ */
+class SlotMap {
+public:
+	struct Handle {
+		uint32_t slot;
+		uint32_t generation;
+
+		bool operator==(const Handle &other) const {
+			return slot == other.slot && generation == other.generation;
+		}
+	};
+
+	// the elements 0..size-1 with the new handles, the old ones become stale
+	void Reset(size_t size) {
+		for (uint32_t slot : indexSlot)
+			Release(slot);
+		indexSlot.clear();
+		for (size_t i = 0; i < size; i++)
+			Push();
+	}
+
+	// handle of the element appended at the index Size()
+	Handle Push() {
+		uint32_t slot;
+		if (freeSlots.empty()) {
+			slot = slotIndex.size();
+			slotIndex.push_back(indexSlot.size());
+			slotGeneration.push_back(0);
+		} else {
+			slot = freeSlots.back();
+			freeSlots.pop_back();
+			slotIndex[slot] = indexSlot.size();
+		}
+		indexSlot.push_back(slot);
+		return {slot, slotGeneration[slot]};
+	}
+
+	// the element at the index is erased and the last one moves to the index
+	void Erase(size_t index) {
+		if (index >= indexSlot.size())
+			return;
+		Release(indexSlot[index]);
+		if (index != indexSlot.size() - 1) {
+			indexSlot[index] = indexSlot.back();
+			slotIndex[indexSlot[index]] = index;
+		}
+		indexSlot.pop_back();
+	}
+
+	bool Contains(Handle handle) const {
+		return handle.slot < slotIndex.size()
+				&& slotGeneration[handle.slot] == handle.generation
+				&& slotIndex[handle.slot] != FREE;
+	}
+
+	/**
+	 * @throws std::invalid_argument if the element of the handle was erased
+	 */
+	size_t IndexOf(Handle handle) const {
+		if (!Contains(handle))
+			throw std::invalid_argument("stale rule handle");
+		return slotIndex[handle.slot];
+	}
+
+	Handle HandleOf(size_t index) const {
+		uint32_t slot = indexSlot.at(index);
+		return {slot, slotGeneration[slot]};
+	}
+
+	size_t Size() const {
+		return indexSlot.size();
+	}
+
+	size_t MemSizeBytes() const {
+		return (slotIndex.capacity() + slotGeneration.capacity()
+				+ indexSlot.capacity() + freeSlots.capacity())
+				* sizeof(uint32_t);
+	}
+
+private:
+	static constexpr uint32_t FREE = UINT32_MAX;
+
+	void Release(uint32_t slot) {
+		slotIndex[slot] = FREE;
+		slotGeneration[slot]++;
+		freeSlots.push_back(slot);
+	}
+
+	// slot -> index of the element (FREE if the slot is not used)
+	std::vector<uint32_t> slotIndex;
+	std::vector<uint32_t> slotGeneration;
+	// index -> slot of the element
+	std::vector<uint32_t> indexSlot;
+	std::vector<uint32_t> freeSlots;
+};
@@ -0,0 +1,135 @@
+#include "cached_classifier.h"
+
+#include <algorithm>
+
+using namespace std;
+
+CachedClassifier::CachedClassifier(unique_ptr<PacketClassifier> inner,
+		size_t sets, size_t ways) :
+		inner(move(inner)), sets(1), ways(max<size_t>(ways, 1)), dim(0), generation(
+				1), tick(0), hits(0), misses(0), invalidations(0) {
+	while (this->sets < sets)
+		this->sets *= 2;
+}
+
+chrono::duration<double> CachedClassifier::ConstructClassifier(
+		const vector<Rule> &rules) {
+	// the time of the inner classifier (some of them measure the time on its own)
+	auto t = inner->ConstructClassifier(rules);
+	Reset(rules.size() ? rules[0].dim : 5);
+	handles.Reset(rules.size());
+	return t;
+}
+
+void CachedClassifier::_ConstructClassifier(const vector<Rule> &rules) {
+	inner->ConstructClassifier(rules);
+	Reset(rules.size() ? rules[0].dim : 5);
+}
+
+void CachedClassifier::Reset(size_t dim) {
+	this->dim = dim;
+	entries.assign(sets * ways, { 0, 0, -1 });
+	keys.assign(sets * ways * dim, 0);
+	generation = 1;
+}
+
+void CachedClassifier::Invalidate() {
+	invalidations++;
+	generation++;
+	if (generation == 0) {
+		// the generation counter wrapped, the old entries could become valid again
+		for (auto &e : entries)
+			e.generation = 0;
+		generation = 1;
+	}
+}
+
+size_t CachedClassifier::Hash(const Packet &packet) const {
+	uint64_t h = 0;
+	for (size_t d = 0; d < dim; d++) {
+		h ^= packet[d];
+		h *= 0x9E3779B97F4A7C15ull;
+		h ^= h >> 29;
+	}
+	return h;
+}
+
+int CachedClassifier::ClassifyAPacket(const Packet &packet) {
+	size_t set = Hash(packet) & (sets - 1);
+	Entry *e = &entries[set * ways];
+	Point1d *k = &keys[set * ways * dim];
+	MEMORY_ACCESS_TRACE(e, ways * sizeof(Entry));
+	tick++;
+	size_t victim = 0;
+	uint32_t victim_age = 0;
+	for (size_t w = 0; w < ways; w++, k += dim) {
+		if (e[w].generation != generation) {
+			// prefer an invalid entry over any valid one
+			if (victim_age != UINT32_MAX) {
+				victim = w;
+				victim_age = UINT32_MAX;
+			}
+			continue;
+		}
+		MEMORY_ACCESS_TRACE(k, dim * sizeof(Point1d));
+		if (equal(k, k + dim, packet.begin())) {
+			e[w].last_use = tick;
+			hits++;
+			QueryCountersUpdate(0);
+			return e[w].result;
+		}
+		uint32_t age = tick - e[w].last_use;
+		if (age > victim_age) {
+			victim = w;
+			victim_age = age;
+		}
+	}
+
+	misses++;
+	int queried = inner->TablesQueried();
+	int result = inner->ClassifyAPacket(packet);
+	QueryCountersUpdate(inner->TablesQueried() - queried);
+	e[victim] = {generation, tick, result};
+	copy(packet.begin(), packet.begin() + dim, &keys[(set * ways + victim) * dim]);
+	return result;
+}
+
+void CachedClassifier::_DeleteRule(size_t index) {
+	inner->DeleteRule(index);
+	Invalidate();
+}
+
+void CachedClassifier::_InsertRule(const Rule &rule) {
+	if (entries.empty())
+		Reset(rule.dim);
+	inner->InsertRule(rule);
+	Invalidate();
+}
+
+Memory CachedClassifier::MemSizeBytes() const {
+	return entries.size() * sizeof(Entry) + keys.size() * sizeof(Point1d)
+			+ inner->MemSizeBytes();
+}
+
+int CachedClassifier::MemoryAccess() const {
+	return inner->MemoryAccess();
+}
+
+size_t CachedClassifier::NumTables() const {
+	return inner->NumTables();
+}
+
+size_t CachedClassifier::RulesInTable(size_t tableIndex) const {
+	return inner->RulesInTable(tableIndex);
+}
+
+void CachedClassifier::CollectStats(map<string, string> &summary) const {
+	summary["Cache.Sets"] = to_string(sets);
+	summary["Cache.Ways"] = to_string(ways);
+	summary["Cache.Hits"] = to_string(hits);
+	summary["Cache.Misses"] = to_string(misses);
+	uint64_t lookups = hits + misses;
+	summary["Cache.HitRate"] = to_string(lookups ? double(hits) / lookups : 0.0);
+	summary["Cache.Invalidations"] = to_string(invalidations);
+	inner->CollectStats(summary);
+}
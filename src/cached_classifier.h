@@ -0,0 +1,81 @@
+#pragma once
+
+#include "packet_classifier.h"
+
+#include <memory>
+
+/**
+ * Flow cache in front of an arbitrary classifier
+ *
+ * The cache is a fixed size set associative table which maps the packet
+ * header to the result of the inner classifier. Each set has a few ways with
+ * LRU replacement. Any InsertRule/DeleteRule may change the result for any
+ * packet, so the update only increments the generation of the cache and
+ * the entries from the older generations are treated as empty.
+ *
+ * The query counters count only the tables queried in the inner classifier
+ * (a cache hit queries 0 tables).
+ */
+class CachedClassifier: public PacketClassifier {
+public:
+	/**
+	 * @param sets number of sets in cache (rounded up to a power of 2)
+	 * @param ways number of entries in each set
+	 */
+	CachedClassifier(std::unique_ptr<PacketClassifier> inner, size_t sets,
+			size_t ways);
+
+	virtual std::chrono::duration<double> ConstructClassifier(
+			const std::vector<Rule> &rules) override;
+	virtual void _ConstructClassifier(const std::vector<Rule> &rules) override;
+	virtual int ClassifyAPacket(const Packet &packet) override;
+	virtual void _DeleteRule(size_t index) override;
+	virtual void _InsertRule(const Rule &rule) override;
+	virtual Memory MemSizeBytes() const override;
+	virtual int MemoryAccess() const override;
+	virtual bool SupportsMemoryAccessTrace() const override {
+		return inner->SupportsMemoryAccessTrace();
+	}
+	virtual void CheckRule(const Rule &rule) const override {
+		inner->CheckRule(rule);
+	}
+	virtual size_t Maintain(size_t budget) override {
+		return inner->Maintain(budget);
+	}
+	virtual bool SupportsWideFields() const override {
+		return inner->SupportsWideFields();
+	}
+	virtual size_t NumTables() const override;
+	virtual size_t RulesInTable(size_t tableIndex) const override;
+	virtual void CollectStats(std::map<std::string, std::string> &summary) const
+			override;
+
+private:
+	struct Entry {
+		// 0 = never used, the entry is valid only for the current generation
+		uint32_t generation;
+		// for LRU replacement
+		uint32_t last_use;
+		int result;
+	};
+	// allocate the cache for packets with dim fields
+	void Reset(size_t dim);
+	// invalidate all entries
+	void Invalidate();
+	inline size_t Hash(const Packet &packet) const;
+
+	std::unique_ptr<PacketClassifier> inner;
+	size_t sets;
+	size_t ways;
+	size_t dim;
+	uint32_t generation;
+	uint32_t tick;
+	// sets * ways entries, ways of a single set are stored together
+	std::vector<Entry> entries;
+	// dim fields of the packet header for each entry
+	std::vector<Point1d> keys;
+
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t invalidations;
+};
@@ -1,19 +1,174 @@
 #include <construct_classifier_by_name.h>
-#include "packet_classifier_from_generic_classifier.h"
-#include "cut_split.h"
-#include "efficuts.h"
 #include "list_classifier.h"
+#include "BruteForce.h"
 #include "TupleMerge/TupleMergeOffline.h"
 #include "OVS/TupleSpaceSearch.h"
+#include "OVS/MegaflowCache.h"
 #include "PartitionSort/PartitionSort.h"
-#include "pcv/pcv.h"
+#include "pcv/pcv_configurations.h"
 #include "HyperCuts/HyperCuts.h"
 #include "HyperSplit/HyperSplit.h"
+#include "Cuttings/HiCuts.h"
+#include "Cuttings/EffiCuts.h"
+#include "Cuttings/CutSplit.h"
 #include "BitVector/BitVector.h"
 #include "ByteCuts/ByteCuts.h"
+#include "RFC/RFC.h"
+#include "ExactMatch/ExactMatch.h"
+#include "RQRMI/RQRMI.h"
+#include "cached_classifier.h"
+#include "rebuilding_classifier.h"
 
 using namespace std;
 
+/**
+ * Constructor of Fixed<Schema> for the fields of the current rules
+ * (DimensionSchema::Current), Generic if there is no such specialization
+ * or the specialization is disabled by "Specialize=0"
+ */
+template<template<class > class Fixed, class Generic>
+static std::function<PacketClassifier* ()> SpecializedConstructor(
+		const str_map &args) {
+	if (GetBoolOrElse(args, "Specialize", true)) {
+		const DimensionSchema &schema = DimensionSchema::Current();
+		if (IPv4FieldSchema::SameLayout(schema))
+			return []() -> PacketClassifier* {
+				return new Fixed<IPv4FieldSchema>();
+			};
+		if (IPv6FieldSchema::SameLayout(schema))
+			return []() -> PacketClassifier* {
+				return new Fixed<IPv6FieldSchema>();
+			};
+	}
+	return []() -> PacketClassifier* {
+		return new Generic();
+	};
+}
+
+std::function<PacketClassifier* ()> ClassifierConstructorByName(const string &c,
+		const str_map &args) {
+	std::function<PacketClassifier* ()> constructor;
+	if (c == "List") {
+		constructor = SpecializedConstructor<ListClassifierT, ListClassifier>(args);
+	} else if (c == "BruteForce") {
+		constructor = []() {
+			return new BruteForce();
+		};
+	} else if (c == "PartitionSort") {
+		constructor = []() {
+			return new PartitionSort();
+		};
+	} else if (c == "PTSS") {
+		constructor = SpecializedConstructor<PriorityTupleSpaceSearchFixed,
+				PriorityTupleSpaceSearch>(args);
+	} else if (c == "Megaflow") {
+		constructor = [&args]() {
+			return new MegaflowClassifier(
+					GetIntOrElse(args, "Megaflow.MaxFlows", 65536));
+		};
+	} else if (c == "HyperSplit") {
+		constructor = [&args]() {
+			return new HyperSplit(args);
+		};
+	} else if (c == "HyperCuts") {
+		constructor = []() {
+			return new HyperCuts();
+		};
+	} else if (c == "ByteCuts") {
+		constructor = [&args]() {
+			return new ByteCutsClassifier(args);
+		};
+	} else if (c == "RFC") {
+		constructor = [&args]() {
+			return new RFC(args);
+		};
+	} else if (c == "BitVector") {
+		constructor = []() {
+			return new BitVector();
+		};
+	} else if (c == "TSS") {
+		constructor = SpecializedConstructor<TupleSpaceSearchFixed,
+				TupleSpaceSearch>(args);
+	} else if (c == "TupleMergeOnline") {
+		constructor = [&args]() {
+			return new TupleMergeOnline(args);
+		};
+	} else if (c == "TupleMergeOffline") {
+		constructor = [&args]() {
+			return new TupleMergeOffline(args);
+		};
+	} else if (c == "HiCuts") {
+		constructor = [&args]() {
+			return new HiCuts(args);
+		};
+	} else if (c == "CutSplit") {
+		constructor = [&args]() {
+			return new CutSplit(args);
+		};
+	} else if (c == "EffiCuts") {
+		constructor = [&args]() {
+			return new EffiCuts(args);
+		};
+	} else if (c.rfind("ExactMatch", 0) == 0) {
+		// ExactMatch[:<fallback classifier>] (PTSS by default)
+		string fallback = "PTSS";
+		if (c.size() > 10) {
+			if (c[10] != ':') {
+				printf("Unknown ClassifierTests: %s\n", c.c_str());
+				exit(EINVAL);
+			}
+			fallback = c.substr(11);
+		}
+		auto make_fallback = ClassifierConstructorByName(fallback, args);
+		constructor = [make_fallback]() {
+			return new ExactMatchClassifier(
+					std::unique_ptr<PacketClassifier>(make_fallback()));
+		};
+	} else if (c.rfind("Cache(", 0) == 0 && c.back() == ')') {
+		// Cache(<classifier>)
+		auto make_inner = ClassifierConstructorByName(c.substr(6, c.size() - 7),
+				args);
+		size_t sets = GetIntOrElse(args, "Cache.Sets", 4096);
+		size_t ways = GetIntOrElse(args, "Cache.Ways", 4);
+		constructor = [make_inner, sets, ways]() {
+			return new CachedClassifier(
+					std::unique_ptr<PacketClassifier>(make_inner()), sets, ways);
+		};
+	} else if (c.rfind("Rebuild(", 0) == 0 && c.back() == ')') {
+		// Rebuild(<classifier>)
+		auto make_inner = ClassifierConstructorByName(c.substr(8, c.size() - 9),
+				args);
+		constructor = [make_inner]() {
+			return new RebuildingClassifier(make_inner);
+		};
+	} else if (c == "RQRMI"
+			|| (c.rfind("RQRMI(", 0) == 0 && c.back() == ')')) {
+		// RQRMI[(<remainder classifier>)] (TupleMergeOnline by default)
+		string inner = c.size() > 5 ? c.substr(6, c.size() - 7) : "TupleMergeOnline";
+		auto make_remainder = ClassifierConstructorByName(inner, args);
+		constructor = [make_remainder, &args]() {
+			return new RQRMIClassifier(
+					std::unique_ptr<PacketClassifier>(make_remainder()), args);
+		};
+	} else if (c.rfind("pcv", 0) == 0) {
+		// pcv[:k<key width>][:n<node fan-out>][:t<max trees>][:l<max levels>]
+		if (!PcvConfigurationExists(c)) {
+			printf("Unknown pcv configuration: %s (available:", c.c_str());
+			for (auto &n : PcvConfigurationNames())
+				printf(" %s", n.c_str());
+			printf(")\n");
+			exit(EINVAL);
+		}
+		constructor = [c]() {
+			return ConstructPcvByName(c);
+		};
+	} else {
+		printf("Unknown ClassifierTests: %s\n", c.c_str());
+		exit(EINVAL);
+	}
+	return constructor;
+}
+
 ClassifierSet ParseClassifierName(const string &line, const str_map &args,
 		size_t count) {
 	vector<string> tokens;
@@ -21,65 +176,7 @@ ClassifierSet ParseClassifierName(const string &line, const str_map &args,
 	ClassifierSet classifiers;
 
 	for (const string &c : tokens) {
-		std::function<PacketClassifier* ()> constructor;
-		if (c == "List") {
-			constructor = []() {
-				return new ListClassifier();
-			};
-		} else if (c == "PartitionSort") {
-			constructor = []() {
-				return new PartitionSort();
-			};
-		} else if (c == "PTSS") {
-			constructor = []() {
-				return new PriorityTupleSpaceSearch();
-			};
-		} else if (c == "HyperSplit") {
-			constructor = [&args]() {
-				return new HyperSplit(args);
-			};
-		} else if (c == "HyperCuts") {
-			constructor = []() {
-				return new HyperCuts();
-			};
-		} else if (c == "ByteCuts") {
-			constructor = [&args]() {
-				return new ByteCutsClassifier(args);
-			};
-		} else if (c == "BitVector") {
-			constructor = []() {
-				return new BitVector();
-			};
-		} else if (c == "TSS") {
-			constructor = []() {
-				return new TupleSpaceSearch();
-			};
-		} else if (c == "TupleMergeOnline") {
-			constructor = [&args]() {
-				return new TupleMergeOnline(args);
-			};
-		} else if (c == "TupleMergeOffline") {
-			constructor = [&args]() {
-				return new TupleMergeOffline(args);
-			};
-		} else if (c == "CutSplit") {
-			constructor = []() {
-				return new PacketClassifierFromGenericClassifier(
-						std::make_unique<CutSplit>(8, 8));
-			};
-		} else if (c == "EffiCuts") {
-			constructor = []() {
-				return new PacketClassifierFromGenericClassifier(
-						std::make_unique<EffiCuts>(8));
-			};
-		} else if (c == "pcv") {
-			constructor = []() {
-				return new Pcv();
-			};
-		} else {
-			printf("Unknown ClassifierTests: %s\n", c.c_str());
-			exit(EINVAL);
-		}
+		auto constructor = ClassifierConstructorByName(c, args);
 		for (size_t i = 0; i < count; i++) {
 			classifiers[c].push_back(constructor());
 		}
@@ -1,4 +1,5 @@
 #pragma once
+#include <functional>
 #include <unordered_set>
 #include <string>
 #include <vector>
@@ -7,5 +8,13 @@
 using ClassifierSet = std::unordered_map<std::string, std::vector<PacketClassifier*>>;
 using str_map = std::unordered_map<std::string, std::string>;
 
+/**
+ * @return function which creates a new instance of the classifier
+ * 		(exits if the name is unknown)
+ * @note List, TSS and PTSS are specialized for the current DimensionSchema,
+ * 		the classifiers have to be constructed after the rules are read
+ */
+std::function<PacketClassifier* ()> ClassifierConstructorByName(
+		const std::string &name, const str_map &args);
 ClassifierSet ParseClassifierName(const std::string &line, const str_map &args,
 		size_t count);
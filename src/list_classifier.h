@@ -1,41 +1,70 @@
 #pragma once
 
 #include "packet_classifier.h"
+#include "FieldSchema.h"
 
-class ListClassifier: public PacketClassifier {
+/**
+ * Linear search of the rules sorted by priority
+ *
+ * The ranges of the rules are stored in a single array (dim ranges for each
+ * rule), the rule match is specialized for the Schema of the rules (FieldSchema.h).
+ */
+template<class Schema = DynamicFieldSchema>
+class ListClassifierT: public PacketClassifier {
 public:
 	virtual void _ConstructClassifier(const std::vector<Rule> &rules) {
-		this->rules = rules;
-		sort(this->rules.begin(), this->rules.end(), [](const Rule &r0, const Rule &r1) {
-			return r0.priority >= r1.priority;
+		for (const Rule &r : rules)
+			Schema::Check(r);
+		std::vector<Rule> sorted = rules;
+		sort(sorted.begin(), sorted.end(), [](const Rule &r0, const Rule &r1) {
+			return r0.priority > r1.priority;
 		});
 		assert(rules.size());
+		dim = rules.size() ? rules[0].dim : 0;
+		ranges.clear();
+		ids.clear();
+		for (const Rule &r : sorted) {
+			ranges.insert(ranges.end(), r.range.begin(), r.range.end());
+			ids.push_back(r.id);
+		}
 	}
 	virtual int ClassifyAPacket(const Packet &packet) {
-		for (const Rule &r : rules) {
-			if (r.MatchesPacket(packet)) {
-				return r.id;
+		const Range1d *r = ranges.data();
+		for (size_t i = 0; i < ids.size(); i++, r += dim) {
+			MEMORY_ACCESS_TRACE(r, dim * sizeof(Range1d));
+			if (Schema::Matches(r, packet, dim)) {
+				return ids[i];
 			}
 		}
 		return -1;
 	}
-	virtual void DeleteRule(size_t index) {
+	virtual void _DeleteRule(size_t index) {
 	}
-	virtual void InsertRule(const Rule &rule) {
+	virtual void _InsertRule(const Rule &rule) {
 	}
 	virtual Memory MemSizeBytes() const {
 		return 0;
 	}
 	virtual int MemoryAccess() const {
-		return rules.size();
+		return ids.size();
+	}
+	virtual bool SupportsMemoryAccessTrace() const {
+		return true;
+	}
+	virtual bool SupportsWideFields() const {
+		return true;
 	}
 	virtual size_t NumTables() const {
 		return 1;
 	}
 	virtual size_t RulesInTable(size_t tableIndex) const {
-		return rules.size();
+		return ids.size();
 	}
 
 private:
-	std::vector<Rule> rules;
+	int dim = 0;
+	std::vector<Range1d> ranges;
+	std::vector<int> ids;
 };
+
+typedef ListClassifierT<> ListClassifier;
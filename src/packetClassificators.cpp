@@ -1,25 +1,55 @@
 #include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <map>
+#include <random>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "ClassBenchTraceGenerator/flow_trace_gen.h"
+#include "ClassBenchTraceGenerator/ruleset_gen.h"
 #include "ClassBenchTraceGenerator/trace_tools.h"
+#include "DimensionSchema.h"
 #include "ElementaryClasses.h"
 
+#include "IO/BinaryFormat.h"
 #include "IO/InputReader.h"
 #include "IO/OutputWriter.h"
+#include "IO/PacketSource.h"
 
 #include "Simulation.h"
 
+#include "Utilities/AllocationTracker.h"
 #include "Utilities/MapExtensions.h"
+#include "Utilities/MemoryAccessTrace.h"
+#include "Utilities/PerfCounters.h"
 #include "construct_classifier_by_name.h"
 
 using namespace std;
 
+/*
+ * Append the classifier specific columns (PacketClassifier::CollectStats)
+ * to the header, rows which do not have the column get an empty value
+ */
+void ExtendHeaderWithCollectedStats(vector<string> &header,
+		vector<map<string, string>> &data) {
+	for (auto &d : data) {
+		for (auto &item : d) {
+			if (find(header.begin(), header.end(), item.first) == header.end())
+				header.push_back(item.first);
+		}
+	}
+	for (auto &d : data) {
+		for (auto &h : header) {
+			d.insert( { h, "" });
+		}
+	}
+}
+
 vector<int> RunSimulatorClassificationTrial(PacketClassficationSimulator &s,
 		const string &name, vector<map<string, string>> &data, size_t trials) {
 	map<string, string> d = { { "Classifier", name } };
@@ -43,8 +73,123 @@ pair<vector<string>, vector<map<string, string>>> RunSimulatorOnlyClassification
 
 	for (auto &pair : classifiers) {
 		PacketClassficationSimulator s(pair.second, rules, packets);
+		s.set_latency_sampling(GetIntOrElse(args, "Latency.Sample", 64));
 		RunSimulatorClassificationTrial(s, pair.first.c_str(), data, trials);
 	}
+	ExtendHeaderWithCollectedStats(header, data);
+
+	if (outfile != "") {
+		OutputWriter::WriteJsonFile(outfile, header, data);
+	}
+	return make_pair(header, data);
+}
+
+/*
+ * Generator of the p=Auto trace for Trace.Mode=Flows|Uniform,
+ * nullptr for the original ClassBench generator (Trace.Mode=ClassBench)
+ */
+unique_ptr<FlowTraceGenerator> MakeFlowTraceGenerator(
+		const unordered_map<string, string> &args, const vector<Rule> &rules) {
+	string mode = GetOrElse(args, "Trace.Mode", "ClassBench");
+	FlowTraceConfig cfg;
+	if (mode == "ClassBench") {
+		return nullptr;
+	} else if (mode == "Flows") {
+		cfg.mode = FlowTraceConfig::Mode::Flows;
+	} else if (mode == "Uniform") {
+		cfg.mode = FlowTraceConfig::Mode::Uniform;
+	} else {
+		throw std::runtime_error(
+				"Unknown Trace.Mode " + mode + " (ClassBench, Flows or Uniform)");
+	}
+	cfg.flow_cnt = GetIntOrElse(args, "Trace.Flows", cfg.flow_cnt);
+	cfg.zipf_s = GetDoubleOrElse(args, "Trace.Zipf", cfg.zipf_s);
+	cfg.mean_flow_len = GetDoubleOrElse(args, "Trace.FlowLength",
+			cfg.mean_flow_len);
+	cfg.interleave = GetIntOrElse(args, "Trace.Interleave", cfg.interleave);
+	cfg.seed = GetIntOrElse(args, "Trace.Seed", cfg.seed);
+	return make_unique<FlowTraceGenerator>(rules, cfg);
+}
+
+/*
+ * Same as RunSimulatorOnlyClassification, but the packets are streamed
+ * from the file or generator instead of being loaded in to memory
+ */
+pair<vector<string>, vector<map<string, string>>> RunSimulatorStreamedClassification(
+		const unordered_map<string, string> &args, const string &packetFile,
+		const vector<Rule> &rules, ClassifierSet classifiers,
+		const string &outfile, size_t trials) {
+	std::cerr << "[INFO] Streamed Classification Simulation" << std::endl;
+	size_t total = GetIntOrElse(args, "Stream.Packets", 0);
+	size_t batch_size = GetIntOrElse(args, "Stream.Batch", 64 * 1024);
+	auto flow_gen = MakeFlowTraceGenerator(args, rules);
+	auto make_source = [&rules, &packetFile, &flow_gen, total, batch_size]() {
+		unique_ptr<PacketSource> src;
+		if (packetFile == "Auto" && flow_gen) {
+			src = make_unique<FlowTracePacketSource>(*flow_gen,
+					total ? total : 1000000);
+		} else if (packetFile == "Auto") {
+			src = make_unique<GeneratorPacketSource>(rules, batch_size,
+					total ? total : 1000000);
+		} else {
+			src = make_unique<FilePacketSource>(packetFile, InputReader::dim,
+					batch_size, total);
+		}
+		return src;
+	};
+
+	vector<string> header = { "Classifier", "ConstructionTime(ms)",
+			"ClassificationTime(s)", "Packets", "StreamWait(s)", "Size(bytes)",
+			"MemoryAccess", "Tables", "TableSizes", "TableQueries", "AvgQueries" };
+	vector<map<string, string>> data;
+
+	for (auto &pair : classifiers) {
+		PacketClassficationSimulator s(pair.second, rules);
+		s.set_latency_sampling(GetIntOrElse(args, "Latency.Sample", 64));
+		map<string, string> d = { { "Classifier", pair.first } };
+		std::cout << "[INFO]" << pair.first << std::endl;
+		s.ruhn_streamed_packet_classification(d, trials, make_source);
+		data.push_back(d);
+	}
+	ExtendHeaderWithCollectedStats(header, data);
+
+	if (outfile != "") {
+		OutputWriter::WriteJsonFile(outfile, header, data);
+	}
+	return make_pair(header, data);
+}
+
+/*
+ * Distinct cache lines touched by the lookup of each packet
+ * (only for the classifiers which support MemoryAccessTrace)
+ */
+pair<vector<string>, vector<map<string, string>>> RunSimulatorMemoryTrace(
+		const unordered_map<string, string> &args,
+		const vector<Packet> &packets, const vector<Rule> &rules,
+		ClassifierSet classifiers, const string &outfile) {
+	std::cerr << "[INFO] Memory Access Trace Simulation" << std::endl;
+	size_t packet_cnt = GetIntOrElse(args, "MemoryTrace.Packets", 0);
+
+	vector<string> header = { "Classifier", "ConstructionTime(ms)",
+			"Size(bytes)", "CacheLines.avg", "CacheLines.p50",
+			"CacheLines.p90", "CacheLines.p99", "CacheLines.max",
+			"Touches.avg", "WorkingSet(bytes)", "CacheLines.Histogram" };
+	vector<map<string, string>> data;
+
+	for (auto &pair : classifiers) {
+		if (!pair.second[0]->SupportsMemoryAccessTrace()) {
+			std::cerr << "[WARNING] " << pair.first
+					<< " does not support the memory access trace, skipping"
+					<< std::endl;
+			continue;
+		}
+		PacketClassficationSimulator s(pair.second, rules, packets);
+		map<string, string> d = { { "Classifier", pair.first } };
+		std::cout << "[INFO]" << pair.first << std::endl;
+		s.ruhn_memory_access_trace(d, packet_cnt);
+		data.push_back(d);
+	}
+	ExtendHeaderWithCollectedStats(header, data);
 
 	if (outfile != "") {
 		OutputWriter::WriteJsonFile(outfile, header, data);
@@ -59,7 +204,7 @@ void RunSimulatorUpdateTrial(PacketClassficationSimulator &s,
 	map<string, string> d = { { "Classifier", name } };
 	map<string, double> trial;
 
-	s.run_task_sequnce(req, trial, reps);
+	s.run_task_sequnce(req, trial, reps, d);
 	for (auto pair : trial) {
 		d[pair.first] = to_string(pair.second / reps);
 	}
@@ -72,14 +217,24 @@ pair<vector<string>, vector<map<string, string>>> RunSimulatorUpdates(
 		ClassifierSet classifiers, const string &outfile, int repetitions) {
 	std::cerr << "[INFO] Update Simulation" << std::endl;
 
-	vector<string> header = { "Classifier", "UpdateTime(s)" };
+	vector<string> header = { "Classifier", "UpdateTime(s)", "Size(bytes)" };
 	vector<map<string, string>> data;
 
 	for (const auto &pair : classifiers) {
 		PacketClassficationSimulator s(pair.second, rules, packets);
-		const auto req = s.SetupComputation(0, 500000, 500000);
+		s.set_latency_sampling(GetIntOrElse(args, "Latency.Sample", 64));
+		s.set_maintenance(GetIntOrElse(args, "Maintain.Budget", 0),
+				GetIntOrElse(args, "Maintain.Interval", 64));
+		s.set_update_batch(GetIntOrElse(args, "Update.Batch", 1));
+		const auto req = s.SetupComputation(
+				GetIntOrElse(args, "Update.Packets", 0), 500000, 500000);
 		RunSimulatorUpdateTrial(s, pair.first.c_str(), req, data, repetitions);
+		// state of the classifier after all updates
+		PacketClassifier &classifier = *pair.second[0];
+		data.back()["Size(bytes)"] = to_string(classifier.MemSizeBytes());
+		classifier.CollectStats(data.back());
 	}
+	ExtendHeaderWithCollectedStats(header, data);
 	if (outfile != "") {
 		OutputWriter::WriteCsvFile(outfile, header, data);
 	}
@@ -95,7 +250,7 @@ bool validation_run(const ClassifierSet classifiers, const vector<Rule> &rules,
 	// highest priority first
 	sort(rules_sorted.begin(), rules_sorted.end(),
 			[](const Rule &r0, const Rule &r1) {
-				return r0.priority >= r1.priority;
+				return r0.priority > r1.priority;
 			});
 	bool all_matched_rule0_or_not_found = true;
 	for (const Packet &p : packets) {
@@ -151,6 +306,77 @@ bool validation_run(const ClassifierSet classifiers, const vector<Rule> &rules,
 	return numWrong == 0;
 }
 
+/*
+ * Deletes and inserts back random rules of all classifiers by their handles
+ * (by ApplyUpdates if batch > 1), the classifiers are validated on the rules
+ * left after the updates
+ */
+bool validation_updates(const ClassifierSet classifiers,
+		const vector<Rule> &rules, const vector<Packet> &packets,
+		size_t updates, size_t batch, int error_threshold) {
+	// handle of each rule in each classifier
+	vector<vector<RuleHandle>> handles;
+	for (auto &pair : classifiers) {
+		handles.emplace_back();
+		for (size_t i = 0; i < rules.size(); i++)
+			handles.back().push_back(pair.second[0]->HandleOf(i));
+	}
+	vector<bool> present(rules.size(), true);
+	mt19937 rng(rules.size());
+	for (size_t u = 0; u < updates && rules.size();) {
+		// distinct rules toggled by the batch
+		vector<size_t> toggled;
+		for (; u < updates && toggled.size() < batch; u++) {
+			size_t r = rng() % rules.size();
+			if (find(toggled.begin(), toggled.end(), r) == toggled.end())
+				toggled.push_back(r);
+		}
+		size_t c = 0;
+		for (auto &pair : classifiers) {
+			PacketClassifier &classifier = *pair.second[0];
+			if (batch == 1) {
+				size_t r = toggled[0];
+				if (present[r])
+					classifier.DeleteRule(handles[c][r]);
+				else
+					handles[c][r] = classifier.InsertRule(rules[r]);
+			} else {
+				vector<RuleUpdate> batch_updates;
+				for (size_t r : toggled) {
+					if (present[r])
+						batch_updates.push_back(
+								RuleUpdate::Deletion(handles[c][r]));
+					else
+						batch_updates.push_back(RuleUpdate::Insertion(rules[r]));
+				}
+				vector<RuleHandle> inserted = classifier.ApplyUpdates(
+						batch_updates);
+				size_t k = 0;
+				for (size_t r : toggled) {
+					if (!present[r])
+						handles[c][r] = inserted[k++];
+				}
+			}
+			c++;
+		}
+		for (size_t r : toggled)
+			present[r] = !present[r];
+	}
+	// the rebuilds in the background have to finish
+	for (auto &pair : classifiers) {
+		while (pair.second[0]->UpdatesPending())
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	vector<Rule> remaining;
+	for (size_t i = 0; i < rules.size(); i++) {
+		if (present[i])
+			remaining.push_back(rules[i]);
+	}
+	std::cerr << "[INFO] " << remaining.size() << " rules after " << updates
+			<< " updates" << std::endl;
+	return validation_run(classifiers, remaining, packets, error_threshold);
+}
+
 bool validation_prepare_and_run(const unordered_map<string, string> &args,
 		const vector<Packet> &packets, const vector<Rule> &rules,
 		ClassifierSet classifiers) {
@@ -165,7 +391,12 @@ bool validation_prepare_and_run(const unordered_map<string, string> &args,
 		//pair.second[0]->_ConstructClassifier(rules);
 		pair.second[0]->ConstructClassifier(rules);
 	}
-	if (validation_run(classifiers, rules, packets, error_threshold)) {
+	size_t updates = GetIntOrElse(args, "Validate.Updates", 0);
+	size_t batch = max(GetIntOrElse(args, "Validate.Batch", 1), 1);
+	if (validation_run(classifiers, rules, packets, error_threshold)
+			&& (!updates
+					|| validation_updates(classifiers, rules, packets, updates,
+							batch, error_threshold))) {
 		std::cerr << "[INFO] All classifiers are in accord" << std::endl;
 		return true;
 	} else {
@@ -175,6 +406,67 @@ bool validation_prepare_and_run(const unordered_map<string, string> &args,
 	}
 }
 
+/*
+ * Store the ruleset and the packets in the binary format
+ */
+bool convert_to_binary(const unordered_map<string, string> &args,
+		const vector<Packet> &packets, const vector<Rule> &rules) {
+	string rulesOut = GetOrElse(args, "Convert.Rules", "");
+	string packetsOut = GetOrElse(args, "Convert.Packets", "");
+	if (rulesOut == "" && packetsOut == "") {
+		std::cerr << "[ERROR] Convert requires Convert.Rules=<file> and/or Convert.Packets=<file>" << std::endl;
+		return false;
+	}
+	if (rulesOut != "") {
+		std::cerr << "[INFO] Writing " << rules.size() << " rules to " << rulesOut << std::endl;
+		if (!BinaryFormat::WriteRules(rulesOut, rules))
+			return false;
+	}
+	if (packetsOut != "") {
+		std::cerr << "[INFO] Writing " << packets.size() << " packets to " << packetsOut << std::endl;
+		if (!BinaryFormat::WritePackets(packetsOut, packets))
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Generate the ruleset from the ClassBench parameter file (Generate.Seed)
+ */
+vector<Rule> generate_rules(const unordered_map<string, string> &args) {
+	string seedFile = GetOrElse(args, "Generate.Seed", "");
+	size_t ruleCnt = GetIntOrElse(args, "Generate.Count", 1000);
+	uint64_t randomSeed = GetIntOrElse(args, "Generate.RandomSeed", 0);
+	std::cerr << "[INFO] Generating " << ruleCnt << " rules from " << seedFile
+			<< std::endl;
+	RulesetGenerator gen(seedFile);
+	return gen.Generate(ruleCnt, randomSeed);
+}
+
+/*
+ * Store the generated ruleset in the ClassBench or binary format
+ */
+bool write_generated_rules(const unordered_map<string, string> &args,
+		const vector<Rule> &rules) {
+	string out = GetOrElse(args, "Generate.Out", "");
+	string format = GetOrElse(args, "Generate.Format", "ClassBench");
+	if (out == "") {
+		std::cerr << "[ERROR] GenerateRules requires Generate.Out=<file>"
+				<< std::endl;
+		return false;
+	}
+	std::cerr << "[INFO] Writing " << rules.size() << " rules to " << out
+			<< std::endl;
+	if (format == "ClassBench") {
+		return OutputWriter::WriteClassBenchFile(out, rules);
+	} else if (format == "Binary") {
+		return BinaryFormat::WriteRules(out, rules);
+	}
+	std::cerr << "[ERROR] Unknown Generate.Format " << format
+			<< " (ClassBench or Binary)" << std::endl;
+	return false;
+}
+
 int main(int argc, char *argv[]) {
 	unordered_map<string, string> args = ParseArgs(argc, argv);
 
@@ -186,34 +478,106 @@ int main(int argc, char *argv[]) {
 
 	string database = GetOrElse(args, "d", "");
 	int thread_cnt = std::stoi(GetOrElse(args, "t", "1"));
+	bool stream = GetBoolOrElse(args, "Stream", false);
+	PerfCounters::enabled = GetBoolOrElse(args, "Perf", true);
+	AllocationTracker::enabled = GetBoolOrElse(args, "Alloc", false);
 	//bool doShuffle = GetBoolOrElse(args, "Shuffle", true);
 
-	//set by default
-	auto classifiers = ParseClassifierName(GetOrElse(args, "c", ""), args,
-			thread_cnt);
 	string mode = GetOrElse(args, "m", "Classification");
 
 	if (GetBoolOrElse(args, "?", false)) {
 		std::cout << "Arguments:" << std::endl;
-		std::cout << "\t-f <file> Filter File:" << std::endl;
-		std::cout << "\t-p <file> Packet File:" << std::endl;
+		std::cout << "\t-f <file> Filter File (text or binary, ClassBench with IPv4 or IPv6 addresses):" << std::endl;
+		std::cout << "\t-p <file> Packet File (text or binary):" << std::endl;
 		std::cout << "\t-o <file> Output File:" << std::endl;
 		std::cout << "\t-r <num> number of repetitions for benchmark"
 				<< std::endl;
 		std::cout << "\t-c <classifier> Classifier:" << std::endl;
-		std::cout << "\t-m <mode> Classification Mode:" << std::endl;
+		std::cout << "\t-m <mode> Classification, Update, Validation, MemoryTrace, Convert or GenerateRules Mode:" << std::endl;
+		std::cout << "\tValidate.Updates=<num> Validation mode also deletes/inserts back num random rules by their handles and validates the rules left (Validate.Batch=<num> updates applied at once)" << std::endl;
+		std::cout << "\tRules.SharePriority=<num> num consecutive rules share a priority (the classifiers do not require unique priorities)" << std::endl;
+		std::cout << "\tMemoryTrace.Packets=<num> number of packets traced in MemoryTrace mode (default all)" << std::endl;
+		std::cout << "\tConvert.Rules=<file> Convert.Packets=<file> binary output files for Convert mode" << std::endl;
+		std::cout << "\tGenerate.Seed=<file> generate the ruleset from the ClassBench parameter file instead of -f (Generate.Count=<num>, Generate.RandomSeed=<num>)" << std::endl;
+		std::cout << "\tGenerate.Out=<file> Generate.Format=<ClassBench|Binary> output of GenerateRules mode" << std::endl;
+		std::cout << "\tTrace.Mode=<ClassBench|Flows|Uniform> generator of the p=Auto trace (Flows: Trace.Flows=<num>, Trace.Zipf=<s>, Trace.FlowLength=<mean>, Trace.Interleave=<num>; Trace.Seed=<num>, Trace.Packets=<num>)" << std::endl;
+		std::cout << "\tMaintain.Budget=<num> incremental maintenance of the classifier (TupleMerge merges the sparse tables) in Update mode, at most num rules moved/tables examined after each Maintain.Interval=<num> updates (default 64)" << std::endl;
+		std::cout << "\tUpdate.Packets=<num> lookups interleaved with the updates of Update mode (default 0)" << std::endl;
+		std::cout << "\tUpdate.Batch=<num> the updates of Update mode applied in batches of num updates (BatchLatency.* columns)" << std::endl;
+		std::cout << "\tLatency.Sample=<num> measure latency of each num-th operation (default 64, 0 = off)" << std::endl;
+		std::cout << "\tPerf=0 disable the hardware counters (perf_event_open)" << std::endl;
+		std::cout << "\tAlloc=1 track the heap allocations of the classifiers (Alloc.Live(bytes), Alloc.Peak(bytes), ...)" << std::endl;
+		std::cout << "\tCache(<classifier>) flow cache in front of the classifier (Cache.Sets=<num>, Cache.Ways=<num>)" << std::endl;
+		std::cout << "\tMegaflow.MaxFlows=<num> size limit of the megaflow cache of the Megaflow classifier (PTSS slow path)" << std::endl;
+		std::cout << "\tRFC.Tree=<phases> reduction tree of RFC (default 0.1,2.3,4.5.6/0.1.2), RFC.Compress=0 disables the table compression" << std::endl;
+		std::cout << "\tHiCuts.Binth=<num> HiCuts.Spfac=<num> EffiCuts.Binth=<num> EffiCuts.Spfac=<num> EffiCuts.Largeness=<0-1> CutSplit.Binth=<num> CutSplit.Spfac=<num> CutSplit.Threshold=<bits> parameters of the cutting trees" << std::endl;
+		std::cout << "\tTM.Policy=<Classic|Adaptive> table splits and merges of TupleMerge by the fixed limit (default) or the lookup cost model (TM.Limit.Collide=<num>, TM.Limit.Collide.Max=<num>, TM.Cost.Table=<num>, TM.Cost.Rule=<num>)" << std::endl;
+		std::cout << "\tRebuild(<classifier>) updates of a static classifier by rebuilds in the background, the lookups use the previous instance until the new one is swapped in (Rebuild.* columns)" << std::endl;
+		std::cout << "\tRQRMI(<classifier>) learned index with the remainder in the classifier (default TupleMergeOnline; RQRMI.MaxISets=<num>, RQRMI.MinCoverage=<0-1>, RQRMI.Submodels=<num>)" << std::endl;
+		std::cout << "\tSpecialize=0 disables the lookup of List, TSS and PTSS specialized for the IPv4/IPv6 5-tuple" << std::endl;
+		std::cout << "\tSchema=<name>:<width>,... fields of the rules (e.g. sa:128,da:128,sp:16,dp:16,proto:8), default from the input" << std::endl;
+		std::cout << "\tStream=1 stream the packets in Classification mode instead of loading them (Stream.Packets=<num> replay/generate num packets, Stream.Batch=<num>)" << std::endl;
 		return 0;
 	}
 
 	//assign mode and classifer
-	vector<Rule> rules = InputReader::ReadFilterFile(filterFile);
+	vector<Rule> rules;
+	if (filterFile == "" && GetOrElse(args, "Generate.Seed", "") != "")
+		rules = generate_rules(args);
+	else
+		rules = InputReader::ReadFilterFile(filterFile);
+	int sharePriority = GetIntOrElse(args, "Rules.SharePriority", 1);
+	if (sharePriority > 1) {
+		for (auto &r : rules)
+			r.id = r.priority /= sharePriority;
+	}
+
+	// the layout of the binary or MSU rules which is not given by their dim
+	if (GetOrElse(args, "Schema", "") != "") {
+		auto schema = DimensionSchema::Parse(GetOrElse(args, "Schema", ""));
+		if (rules.size() && schema.NumLanes() != size_t(rules[0].dim)) {
+			printf("Schema has %zu lanes, the rules have %d\n",
+					schema.NumLanes(), rules[0].dim);
+			exit(EINVAL);
+		}
+		DimensionSchema::SetCurrent(schema);
+	}
+	// the classifiers are specialized for the schema of the rules
+	auto classifiers = ParseClassifierName(GetOrElse(args, "c", ""), args,
+			thread_cnt);
+	if (DimensionSchema::Current().HasWideFields()) {
+		for (auto &c : classifiers) {
+			if (!c.second[0]->SupportsWideFields()) {
+				printf("%s does not support the fields wider than 32b (%s)\n",
+						c.first.c_str(),
+						DimensionSchema::Current().ToString().c_str());
+				exit(EINVAL);
+			}
+		}
+	}
+
+	if (stream && mode != "Classification") {
+		printf("Stream is supported only in Classification mode\n");
+		exit(EINVAL);
+	}
+	if (stream && packetFile == "") {
+		printf("Stream requires a packet file or p=Auto\n");
+		exit(EINVAL);
+	}
 
 	vector<Packet> packets;
-	//generate 1,000,000 packets from ruleset
-	if (packetFile == "Auto")
-		packets = GeneratePacketsFromRuleset(rules, 1000000);
-	else if (packetFile != "")
-		packets = InputReader::ReadPackets(packetFile);
+	// streamed packets are generated/loaded during the simulation
+	if (!stream && mode != "GenerateRules") {
+		//generate 1,000,000 packets from ruleset
+		auto flow_gen = MakeFlowTraceGenerator(args, rules);
+		if (packetFile == "Auto" && flow_gen)
+			packets = flow_gen->Generate(
+					GetIntOrElse(args, "Trace.Packets", 1000000));
+		else if (packetFile == "Auto")
+			packets = GeneratePacketsFromRuleset(rules, 1000000);
+		else if (packetFile != "")
+			packets = InputReader::ReadPackets(packetFile);
+	}
 
 	//if (doShuffle) {
 	//	Random rand;
@@ -223,15 +587,32 @@ int main(int argc, char *argv[]) {
 	LIKWID_MARKER_INIT;
 	LIKWID_MARKER_THREADINIT;
 
-	if (mode == "Classification") {
+	if (mode == "Classification" && stream) {
+		RunSimulatorStreamedClassification(args, packetFile, rules,
+				classifiers, outputFile, trials);
+	} else if (mode == "Classification") {
 		RunSimulatorOnlyClassification(args, packets, rules, classifiers,
 				outputFile, trials, thread_cnt);
 	} else if (mode == "Update") {
 		RunSimulatorUpdates(args, packets, rules, classifiers, outputFile, 1);
+	} else if (mode == "MemoryTrace") {
+		if (!MemoryAccessTrace::ENABLED) {
+			printf("MemoryTrace mode requires the build with -Dmemory_trace=true\n");
+			exit(EINVAL);
+		}
+		RunSimulatorMemoryTrace(args, packets, rules, classifiers, outputFile);
 	} else if (mode == "Validation") {
 		if (!validation_prepare_and_run(args, packets, rules, classifiers)) {
 			exit(EXIT_FAILURE);
 		}
+	} else if (mode == "GenerateRules") {
+		if (!write_generated_rules(args, rules)) {
+			exit(EXIT_FAILURE);
+		}
+	} else if (mode == "Convert") {
+		if (!convert_to_binary(args, packets, rules)) {
+			exit(EXIT_FAILURE);
+		}
 	} else {
 		printf("Unknown mode: %s\n", mode.c_str());
 		exit(EINVAL);
@@ -4,12 +4,40 @@
 #include "ElementaryClasses.h"
 #include "Utilities/MapExtensions.h"
 #include <Utilities/thread_pool.h>
+#include "Utilities/SlotMap.h"
 
+#include <algorithm>
 #include <map>
+#include <stdexcept>
 #include <unordered_map>
 
 typedef uint32_t Memory;
 
+/**
+ * Reference to a rule of a classifier which stays valid until the rule is
+ * deleted (the index of a rule changes when an other rule is deleted)
+ */
+typedef SlotMap::Handle RuleHandle;
+
+/**
+ * Insert of a rule or delete of the rule of a handle in a batch of ApplyUpdates
+ */
+struct RuleUpdate {
+	enum Type {
+		Insert, Delete
+	};
+	Type type;
+	Rule rule;
+	RuleHandle handle;
+
+	static RuleUpdate Insertion(const Rule &rule) {
+		return {Insert, rule, {}};
+	}
+	static RuleUpdate Deletion(RuleHandle handle) {
+		return {Delete, Rule(0), handle};
+	}
+};
+
 class PartitionPacketClassifier {
 public:
 	virtual int ComputeNumberOfBuckets(const std::vector<Rule> &rules) = 0;
@@ -45,17 +73,152 @@ public:
 		LIKWID_MARKER_STOP("classifier_construction");
 		end = std::chrono::steady_clock::now();
 		elapsed_seconds = end - start;
+		handles.Reset(rules.size());
 		return elapsed_seconds;
 	}
 	virtual void _ConstructClassifier(const std::vector<Rule> &rules) = 0;
 	virtual int ClassifyAPacket(const Packet &packet) = 0;
-	virtual void DeleteRule(size_t index) = 0;
-	virtual void InsertRule(const Rule &rule) = 0;
+
+	/**
+	 * Adds the rule at the end of the rules of the classifier, the rules
+	 * may share a priority
+	 *
+	 * @return handle of the rule for DeleteRule
+	 */
+	RuleHandle InsertRule(const Rule &rule) {
+		_InsertRule(rule);
+		return handles.Push();
+	}
+	/**
+	 * Deletes the rule at the index (the order of ConstructClassifier and
+	 * InsertRule), the last rule moves to the index
+	 */
+	void DeleteRule(size_t index) {
+		_DeleteRule(index);
+		handles.Erase(index);
+	}
+	/**
+	 * @throws std::invalid_argument if the rule of the handle was deleted
+	 */
+	void DeleteRule(RuleHandle handle) {
+		DeleteRule(handles.IndexOf(handle));
+	}
+	RuleHandle HandleOf(size_t index) const {
+		return handles.HandleOf(index);
+	}
+	size_t IndexOf(RuleHandle handle) const {
+		return handles.IndexOf(handle);
+	}
+	/**
+	 * Applies a batch of updates at once, the classifier may coalesce the
+	 * work of the updates (e.g. a single sort of its tables). The deletes are
+	 * applied first, then the inserted rules are added at the end of the rules
+	 * in the order of the batch. A batch can not delete the rules it inserts.
+	 *
+	 * @return handles of the inserted rules in the order of the batch
+	 * @throws std::invalid_argument if a handle is stale or it is in the batch
+	 * 		twice, the exception of CheckRule for an inserted rule (nothing is
+	 * 		applied in both cases)
+	 */
+	std::vector<RuleHandle> ApplyUpdates(const std::vector<RuleUpdate> &updates) {
+		std::vector<uint32_t> slots;
+		for (const RuleUpdate &u : updates) {
+			if (u.type != RuleUpdate::Delete) {
+				CheckRule(u.rule);
+				continue;
+			}
+			if (!handles.Contains(u.handle))
+				throw std::invalid_argument("stale rule handle");
+			slots.push_back(u.handle.slot);
+		}
+		std::sort(slots.begin(), slots.end());
+		if (std::adjacent_find(slots.begin(), slots.end()) != slots.end())
+			throw std::invalid_argument("rule handle deleted twice in a batch");
+
+		std::vector<size_t> deleted;
+		std::vector<const Rule*> inserted;
+		deleted.reserve(slots.size());
+		inserted.reserve(updates.size() - slots.size());
+		for (const RuleUpdate &u : updates) {
+			if (u.type == RuleUpdate::Delete) {
+				deleted.push_back(handles.IndexOf(u.handle));
+				handles.Erase(deleted.back());
+			} else {
+				inserted.push_back(&u.rule);
+			}
+		}
+		_ApplyUpdates(deleted, inserted);
+		std::vector<RuleHandle> result;
+		result.reserve(inserted.size());
+		for (size_t i = 0; i < inserted.size(); i++)
+			result.push_back(handles.Push());
+		return result;
+	}
+	/**
+	 * Validation of a rule before it is inserted by ApplyUpdates, the batch
+	 * is rejected before any change if the classifier can not hold the rule
+	 *
+	 * @throws std::runtime_error if the rule is not supported
+	 */
+	virtual void CheckRule(const Rule&) const {
+	}
+	// the update of the classifier behind InsertRule and DeleteRule
+	virtual void _InsertRule(const Rule &rule) = 0;
+	virtual void _DeleteRule(size_t index) = 0;
+	/**
+	 * The batch of ApplyUpdates, the rules at the indexes are deleted (each
+	 * index is after the previous deletes) and then the rules are inserted
+	 */
+	virtual void _ApplyUpdates(const std::vector<size_t> &deleted,
+			const std::vector<const Rule*> &inserted) {
+		for (size_t index : deleted)
+			_DeleteRule(index);
+		for (const Rule *rule : inserted)
+			_InsertRule(*rule);
+	}
 	virtual Memory MemSizeBytes() const = 0;
 	virtual int MemoryAccess() const = 0;
 	virtual size_t NumTables() const = 0;
 	virtual size_t RulesInTable(size_t tableIndex) const = 0;
 
+	/**
+	 * Add classifier specific statistics (e.g. allocator usage) to the summary
+	 * of a simulation run, keys are used as column names in the output
+	 */
+	virtual void CollectStats(std::map<std::string, std::string>&) const {
+	}
+	/**
+	 * True if the lookup path reports all its memory accesses
+	 * by MEMORY_ACCESS_TRACE (used by the MemoryTrace simulation mode)
+	 */
+	virtual bool SupportsMemoryAccessTrace() const {
+		return false;
+	}
+	/**
+	 * True if the classifier works with the fields split in to more 32b lanes
+	 * (DimensionSchema::HasWideFields, e.g. IPv6 addresses)
+	 */
+	virtual bool SupportsWideFields() const {
+		return false;
+	}
+	/**
+	 * Incremental maintenance of the classifier between the updates
+	 * (e.g. merging of the tables left sparse by the deletes)
+	 *
+	 * @param budget max work of the call (rules moved and tables examined)
+	 * @return work done, 0 if there is nothing to do
+	 */
+	virtual size_t Maintain(size_t) {
+		return 0;
+	}
+	/**
+	 * True if some updates are not visible to the lookups yet
+	 * (e.g. the classifier is rebuilt in the background)
+	 */
+	virtual bool UpdatesPending() const {
+		return false;
+	}
+
 	int TablesQueried() const {
 		return queryCount;
 	}
@@ -74,6 +237,9 @@ protected:
 		queryCount += query;
 	}
 
+	// handles of the rules by their index
+	SlotMap handles;
+
 private:
 	int queryCount = 0;
 	std::unordered_map<int, int> packetHistogram;
@@ -11,48 +11,67 @@
 #include <pcv/partition_sort/b_tree_impl.h>
 #include <pcv/partition_sort/rule_value_int.h>
 #include <pcv/partition_sort/partition_sort_classifier.h>
+#include "pcv_key_mapping.h"
 
 using namespace std;
 
-class Pcv: public PacketClassifier {
-	using BTree = pcv::BTreeImp<pcv::_BTreeCfg<uint16_t, pcv::RuleValueInt, 7, 65535, 8>>;
-	using Classifier = pcv::PartitionSortClassifer<BTree, 64, 10>;
+/**
+ * Packet classifier based on the B-trees from pclass-vectorized
+ *
+ * @tparam Key_t type of the B-tree key (width of the key lane)
+ * @tparam NODE_T B-tree node fan-out parameter
+ * @tparam MAX_TREE_CNT maximal number of trees in partition sort classifier
+ * @tparam MAX_LEVELS maximal number of levels of the tree
+ * @tparam KeyMapping mapping of the rule fields to the key lanes
+ */
+template<typename Key_t, size_t NODE_T, size_t MAX_TREE_CNT, size_t MAX_LEVELS,
+		typename KeyMapping = PcvKeyMappingIpv4<Key_t>>
+class _Pcv: public PacketClassifier {
+	using BTree = pcv::BTreeImp<pcv::_BTreeCfg<Key_t, pcv::RuleValueInt, KeyMapping::D, 65535, NODE_T>>;
+	using Classifier = pcv::PartitionSortClassifer<BTree, MAX_TREE_CNT, MAX_LEVELS>;
 	using Mempool = typename BTree::NodeAllocator;
+	using Node = typename BTree::Node;
+	using rule_spec_t = typename Classifier::rule_spec_t;
+	using key_range_t = typename rule_spec_t::first_type::value_type;
 	Mempool mem;
 	Classifier cls;
+	// rule index (as used by DeleteRule) -> rules as stored in the B-trees,
+	// the classifier locates the tree which owns the rule on removal
+	// (rule may be expanded to multiple B-tree rules by KeyMapping)
+	std::vector<std::vector<rule_spec_t>> rules;
+	size_t rule_spec_cnt;
+	// maximum number of nodes allocated from the pool at any moment
+	size_t pool_high_water_mark;
 
-	template<typename T>
-	void to_Range1d(pcv::Range1d<T> &dst, const Rule &src_r, Dimensions d) {
-		dst.low = src_r.range[d].low;
-		dst.high = src_r.range[d].high;
+	std::vector<rule_spec_t> to_rule_specs(const Rule &r) {
+		std::vector<rule_spec_t> res;
+		pcv::RuleValueInt v = { KeyMapping::cummulative_prefix_len(r),
+				(uint32_t) r.id };
+		for (auto &k : KeyMapping::template rule_to_key_ranges<key_range_t>(r)) {
+			res.push_back( { k, v });
+		}
+		return res;
+	}
+
+	void update_pool_high_water_mark() {
+		pool_high_water_mark = std::max(pool_high_water_mark, mem.used());
 	}
 
 public:
 
-	Pcv(size_t nodes = 1024 * 1024) :
-			mem(nodes), cls(mem) {
+	_Pcv(size_t nodes = 1024 * 1024) :
+			mem(nodes), cls(mem), rule_spec_cnt(0), pool_high_water_mark(0) {
 	}
 
 	void _ConstructClassifier(const std::vector<Rule> &rules) {
+		this->rules.reserve(rules.size());
 		for (auto &r : rules) {
-			InsertRule(r);
+			_InsertRule(r);
 		}
 	}
 	int ClassifyAPacket(const Packet &p) {
-		Classifier::key_vec_t p0;
-		// fill(&_r[0], r.sip);
-		// fill(p, r.dip);
-		// _r[4] = r.sport;
-		// _r[5] = r.dport;
-		// _r[6] = r.proto;
-
-		p0[0] = p[FieldSA] & ((1 << 16) - 1);
-		p0[1] = p[FieldSA] >> 16;
-		p0[2] = p[FieldDA] & ((1 << 16) - 1);
-		p0[3] = p[FieldDA] >> 16;
-		p0[4] = p[FieldSP];
-		p0[5] = p[FieldDP];
-		p0[6] = p[FieldProto];
+		typename Classifier::key_vec_t p0;
+		KeyMapping::packet_to_key(p, p0);
 
 		auto r = cls.search(p0);
 		if (r.is_valid()) {
@@ -61,23 +80,45 @@ public:
 			return -1;
 		}
 	}
-	void DeleteRule(size_t index) {
+	/**
+	 * Remove the rule with the specified index, the last rule takes
+	 * the place of the removed one (same as in other classifiers)
+	 */
+	void _DeleteRule(size_t index) {
+		if (index >= rules.size()) {
+			printf("Warning index delete rule out of bound: do nothing here\n");
+			printf("%lu vs. size: %lu\n", index, rules.size());
+			return;
+		}
+		for (auto &r : rules[index]) {
+			cls.remove(r);
+		}
+		rule_spec_cnt -= rules[index].size();
+		if (index != rules.size() - 1)
+			rules[index] = std::move(rules[rules.size() - 1]);
+		rules.pop_back();
 	}
-	void InsertRule(const Rule &r) {
-		pcv::Rule_Ipv4_ACL r0;
-		to_Range1d<uint32_t>(r0.sip, r, Dimensions::FieldSA);
-		to_Range1d<uint32_t>(r0.dip, r, Dimensions::FieldDA);
-		to_Range1d<uint16_t>(r0.sport, r, Dimensions::FieldSP);
-		to_Range1d<uint16_t>(r0.dport, r, Dimensions::FieldDP);
-		to_Range1d<uint16_t>(r0.proto, r, Dimensions::FieldProto);
-
-		Classifier::rule_spec_t r1 = { pcv::rule_conv_fn::rule_to_array_16b(r0),
-				{ (uint32_t) r0.cummulative_prefix_len(), (uint32_t) r.id } };
-		cls.insert(r1);
+	void _InsertRule(const Rule &r) {
+		rules.push_back(to_rule_specs(r));
+		for (auto &r : rules.back()) {
+			cls.insert(r);
+		}
+		rule_spec_cnt += rules.back().size();
+		update_pool_high_water_mark();
 	}
+	/**
+	 * Size of the nodes currently allocated from the node pool
+	 * and of the rule index
+	 */
 	Memory MemSizeBytes() const {
-		printf("warning unimplemented MemSizeBytes()\n");
-		return 0;
+		return mem.used() * sizeof(Node) + rule_spec_cnt * sizeof(rule_spec_t);
+	}
+	void CollectStats(std::map<std::string, std::string> &summary) const {
+		summary["PoolNodes"] = std::to_string(mem.used());
+		summary["PoolHighWaterMark"] = std::to_string(pool_high_water_mark);
+		summary["PoolHighWaterMark(bytes)"] = std::to_string(
+				pool_high_water_mark * sizeof(Node));
+		summary["ExpandedRules"] = std::to_string(rule_spec_cnt);
 	}
 
 	int MemoryAccess() const {
@@ -90,8 +131,9 @@ public:
 	size_t RulesInTable(size_t index) const {
 		return cls.trees.at(index)->rules.size();
 	}
-	virtual ~Pcv() {
+	virtual ~_Pcv() {
 	}
 
 };
 
+using Pcv = _Pcv<uint16_t, 8, 64, 10>;
@@ -0,0 +1,121 @@
+#include "pcv_configurations.h"
+#include "pcv.h"
+#include "../Utilities/MapExtensions.h"
+
+#include <functional>
+
+namespace {
+
+struct PcvConfig {
+	size_t key_width = 16;
+	size_t node_fanout = 8;
+	size_t max_trees = 64;
+	size_t max_levels = 10;
+
+	bool operator==(const PcvConfig &other) const {
+		return key_width == other.key_width && node_fanout == other.node_fanout
+				&& max_trees == other.max_trees
+				&& max_levels == other.max_levels;
+	}
+	std::string name() const {
+		return "pcv:k" + std::to_string(key_width) + ":n"
+				+ std::to_string(node_fanout) + ":t" + std::to_string(max_trees)
+				+ ":l" + std::to_string(max_levels);
+	}
+};
+
+template<typename Key_t, size_t NODE_T, size_t MAX_TREE_CNT, size_t MAX_LEVELS>
+std::pair<PcvConfig, std::function<PacketClassifier*()>> config() {
+	PcvConfig c;
+	c.key_width = sizeof(Key_t) * 8;
+	c.node_fanout = NODE_T;
+	c.max_trees = MAX_TREE_CNT;
+	c.max_levels = MAX_LEVELS;
+	return {c, []() {
+		return new _Pcv<Key_t, NODE_T, MAX_TREE_CNT, MAX_LEVELS>();
+	}};
+}
+
+// every configuration is a separate instance of the B-tree templates,
+// keep this list reasonably short
+const std::vector<std::pair<PcvConfig, std::function<PacketClassifier*()>>>& configurations() {
+	static const std::vector<std::pair<PcvConfig, std::function<PacketClassifier*()>>> cfgs = {
+		config<uint8_t, 4, 64, 10>(),
+		config<uint8_t, 8, 64, 10>(),
+		config<uint8_t, 16, 64, 10>(),
+		config<uint16_t, 4, 64, 10>(),
+		config<uint16_t, 8, 64, 10>(),
+		config<uint16_t, 16, 64, 10>(),
+		config<uint32_t, 4, 64, 10>(),
+		config<uint32_t, 8, 64, 10>(),
+		config<uint32_t, 16, 64, 10>(),
+		config<uint16_t, 8, 32, 10>(),
+		config<uint16_t, 8, 128, 10>(),
+		config<uint16_t, 8, 64, 5>(),
+		config<uint16_t, 8, 64, 16>(),
+	};
+	return cfgs;
+}
+
+const std::function<PacketClassifier*()>* find_constructor(
+		const std::string &name) {
+	std::vector<std::string> tokens;
+	Split(name, ':', tokens);
+	if (tokens.empty() || tokens[0] != "pcv")
+		return nullptr;
+
+	PcvConfig c;
+	for (size_t i = 1; i < tokens.size(); i++) {
+		const std::string &t = tokens[i];
+		if (t.size() < 2)
+			return nullptr;
+		size_t v;
+		try {
+			v = std::stoul(t.substr(1));
+		} catch (const std::logic_error&) {
+			return nullptr;
+		}
+		switch (t[0]) {
+		case 'k':
+			c.key_width = v;
+			break;
+		case 'n':
+			c.node_fanout = v;
+			break;
+		case 't':
+			c.max_trees = v;
+			break;
+		case 'l':
+			c.max_levels = v;
+			break;
+		default:
+			return nullptr;
+		}
+	}
+	for (auto &item : configurations()) {
+		if (item.first == c)
+			return &item.second;
+	}
+	return nullptr;
+}
+
+}
+
+bool PcvConfigurationExists(const std::string &name) {
+	return find_constructor(name) != nullptr;
+}
+
+PacketClassifier* ConstructPcvByName(const std::string &name) {
+	auto c = find_constructor(name);
+	if (c == nullptr)
+		return nullptr;
+	return (*c)();
+}
+
+std::vector<std::string> PcvConfigurationNames() {
+	std::vector<std::string> res;
+	for (auto &item : configurations()) {
+		res.push_back(item.first.name());
+	}
+	return res;
+}
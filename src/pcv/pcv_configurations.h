@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "../packet_classifier.h"
+
+/**
+ * Construct pcv classifier from the name with specification of the tree geometry
+ *
+ * pcv[:k<key width>][:n<node fan-out>][:t<max trees>][:l<max levels>]
+ * e.g. "pcv" (= "pcv:k16:n8:t64:l10"), "pcv:k32:n4"
+ *
+ * Only the configurations instantiated in pcv_configurations.cpp are available.
+ *
+ * @return new classifier or nullptr if the name does not specify an available configuration
+ */
+PacketClassifier* ConstructPcvByName(const std::string &name);
+
+bool PcvConfigurationExists(const std::string &name);
+
+/**
+ * @return names of all available pcv configurations
+ */
+std::vector<std::string> PcvConfigurationNames();
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "../ElementaryClasses.h"
+#include <array>
+#include <limits>
+#include <vector>
+
+/**
+ * Mapping of the rule/packet fields to the key lanes of the pcv B-tree.
+ *
+ * Each field of the rule (in the order of the rule dimensions) is split into
+ * ceil(FIELD_WIDTH / key width) lanes, the least significant lane first.
+ * This means that the number of B-tree dimensions is derived from the rule
+ * fields and wider fields (e.g. IPv6 address split into 32b rule dimensions)
+ * are handled the same way as the IPv4 5-tuple.
+ *
+ * A range which can not be expressed as a single range per lane
+ * (e.g. port range 1000-2000 split into 8b lanes) is decomposed into several
+ * lane ranges, so one rule may be stored as multiple B-tree rules.
+ *
+ * @tparam Key_t type of the B-tree key
+ * @tparam FIELD_WIDTHS width of each rule dimension in bits
+ */
+template<typename Key_t, size_t ... FIELD_WIDTHS>
+class PcvKeyMapping {
+public:
+	static constexpr size_t KEY_WIDTH = sizeof(Key_t) * 8;
+	static constexpr size_t FIELD_CNT = sizeof...(FIELD_WIDTHS);
+	static constexpr std::array<size_t, FIELD_CNT> field_widths = {
+			FIELD_WIDTHS... };
+
+	static constexpr size_t lanes_of_field(size_t field_width) {
+		return (field_width + KEY_WIDTH - 1) / KEY_WIDTH;
+	}
+	static constexpr size_t lanes_total() {
+		size_t res = 0;
+		for (size_t w : field_widths)
+			res += lanes_of_field(w);
+		return res;
+	}
+	// number of dimensions of the B-tree
+	static constexpr size_t D = lanes_total();
+
+	using key_vec_t = std::array<Key_t, D>;
+	template<typename Range>
+	using key_ranges_t = std::array<Range, D>;
+
+	static_assert(KEY_WIDTH <= 32, "lanes are extracted from 32b Point1d");
+
+	static constexpr uint64_t lane_mask() {
+		return (uint64_t(1) << KEY_WIDTH) - 1;
+	}
+
+	static void packet_to_key(const Packet &p, key_vec_t &key) {
+		size_t k = 0;
+		for (size_t f = 0; f < FIELD_CNT; f++) {
+			uint64_t v = p[f];
+			for (size_t l = 0; l < lanes_of_field(field_widths[f]); l++) {
+				key[k++] = Key_t(v & lane_mask());
+				v >>= KEY_WIDTH;
+			}
+		}
+	}
+
+	/**
+	 * Convert the rule to a list of lane ranges which together match exactly
+	 * the same packets as the original rule
+	 */
+	template<typename Range>
+	static std::vector<key_ranges_t<Range>> rule_to_key_ranges(const Rule &r) {
+		std::vector<key_ranges_t<Range>> res(1);
+		size_t k = 0;
+		for (size_t f = 0; f < FIELD_CNT; f++) {
+			size_t lanes = lanes_of_field(field_widths[f]);
+			auto pieces = split_range(r.range[f].low, r.range[f].high, lanes);
+			std::vector<key_ranges_t<Range>> expanded;
+			expanded.reserve(res.size() * pieces.size());
+			for (const auto &prefix : res) {
+				for (const auto &piece : pieces) {
+					expanded.push_back(prefix);
+					auto &dst = expanded.back();
+					for (size_t l = 0; l < lanes; l++) {
+						dst[k + l].low = piece[l].first;
+						dst[k + l].high = piece[l].second;
+					}
+				}
+			}
+			res = std::move(expanded);
+			k += lanes;
+		}
+		return res;
+	}
+
+	/**
+	 * Sum of the lengths of the matched prefixes in all fields
+	 * (non prefix ranges are counted as the prefix of the range size)
+	 */
+	static uint32_t cummulative_prefix_len(const Rule &r) {
+		uint32_t res = 0;
+		for (size_t f = 0; f < FIELD_CNT; f++) {
+			uint64_t x = uint64_t(r.range[f].high) - r.range[f].low;
+			size_t lg = 0;
+			for (; x; x >>= 1)
+				lg++;
+			res += field_widths[f] - std::min(lg, field_widths[f]);
+		}
+		return res;
+	}
+
+private:
+	using lane_range_t = std::pair<Key_t, Key_t>;
+	// ranges of the lanes of the field, least significant lane first
+	using lane_pieces_t = std::vector<lane_range_t>;
+
+	/**
+	 * Split the range to pieces where each piece is a cartesian product
+	 * of the lane ranges
+	 */
+	static std::vector<lane_pieces_t> split_range(uint64_t low, uint64_t high,
+			size_t lanes) {
+		std::vector<lane_pieces_t> res;
+		lane_pieces_t current(lanes);
+		_split_range(low, high, lanes, current, res);
+		return res;
+	}
+
+	static void _split_range(uint64_t low, uint64_t high, size_t lanes,
+			lane_pieces_t &current, std::vector<lane_pieces_t> &res) {
+		size_t top = lanes - 1;
+		if (lanes == 1) {
+			current[top] = { Key_t(low), Key_t(high) };
+			res.push_back(current);
+			return;
+		}
+		size_t low_bits = top * KEY_WIDTH;
+		uint64_t mask = (uint64_t(1) << low_bits) - 1;
+		uint64_t lt = low >> low_bits;
+		uint64_t ht = high >> low_bits;
+		if (lt == ht) {
+			current[top] = { Key_t(lt), Key_t(lt) };
+			_split_range(low & mask, high & mask, top, current, res);
+			return;
+		}
+		if ((low & mask) != 0) {
+			current[top] = { Key_t(lt), Key_t(lt) };
+			_split_range(low & mask, mask, top, current, res);
+			lt++;
+		}
+		bool high_piece = (high & mask) != mask;
+		if (high_piece)
+			ht--;
+		if (lt <= ht) {
+			current[top] = { Key_t(lt), Key_t(ht) };
+			for (size_t l = 0; l < top; l++)
+				current[l] = { Key_t(0), Key_t(lane_mask()) };
+			res.push_back(current);
+		}
+		if (high_piece) {
+			ht++;
+			current[top] = { Key_t(ht), Key_t(ht) };
+			_split_range(0, high & mask, top, current, res);
+		}
+	}
+};
+
+// key mapping for IPv4 5-tuple (sip, dip, sport, dport, proto)
+template<typename Key_t>
+using PcvKeyMappingIpv4 = PcvKeyMapping<Key_t, 32, 32, 16, 16, 8>;
@@ -0,0 +1,174 @@
+#include "rebuilding_classifier.h"
+
+using namespace std;
+
+RebuildingClassifier::RebuildingClassifier(
+		function<PacketClassifier*()> make_inner) :
+		make_inner(make_inner), current(make_inner()), epoch(0), reader_epoch(
+				IDLE), stop(false), version(0), built(0), oldest_update(0), rebuilds(
+				0) {
+}
+
+RebuildingClassifier::~RebuildingClassifier() {
+	StopBuilder();
+	delete current.load();
+}
+
+void RebuildingClassifier::_ConstructClassifier(const vector<Rule> &rules) {
+	StopBuilder();
+	{
+		lock_guard<mutex> lock(rules_mutex);
+		this->rules = rules;
+		version = 0;
+		built = 0;
+		oldest_update = 0;
+	}
+	PacketClassifier *next = make_inner();
+	next->ConstructClassifier(rules);
+	Publish(next);
+}
+
+int RebuildingClassifier::ClassifyAPacket(const Packet &packet) {
+	ReadGuard guard(*this);
+	int queried = guard.inner->TablesQueried();
+	int result = guard.inner->ClassifyAPacket(packet);
+	QueryCountersUpdate(guard.inner->TablesQueried() - queried);
+	return result;
+}
+
+void RebuildingClassifier::_DeleteRule(size_t index) {
+	lock_guard<mutex> lock(rules_mutex);
+	if (index != rules.size() - 1)
+		rules[index] = move(rules.back());
+	rules.pop_back();
+	Updated();
+}
+
+void RebuildingClassifier::_InsertRule(const Rule &rule) {
+	lock_guard<mutex> lock(rules_mutex);
+	rules.push_back(rule);
+	Updated();
+}
+
+void RebuildingClassifier::_ApplyUpdates(const vector<size_t> &deleted,
+		const vector<const Rule*> &inserted) {
+	lock_guard<mutex> lock(rules_mutex);
+	for (size_t index : deleted) {
+		if (index != rules.size() - 1)
+			rules[index] = move(rules.back());
+		rules.pop_back();
+	}
+	for (const Rule *rule : inserted)
+		rules.push_back(*rule);
+	if (!deleted.empty() || !inserted.empty())
+		Updated();
+}
+
+void RebuildingClassifier::Updated() {
+	if (!oldest_update)
+		oldest_update = LatencyHistogram::Start();
+	version++;
+	if (builder.joinable()) {
+		wakeup.notify_one();
+	} else {
+		builder = thread(&RebuildingClassifier::Build, this);
+	}
+}
+
+void RebuildingClassifier::Build() {
+	unique_lock<mutex> lock(rules_mutex);
+	while (true) {
+		wakeup.wait(lock, [this]() {
+			return stop || built < version;
+		});
+		if (stop)
+			return;
+		// the updates which arrive during the build go to the next one
+		vector<Rule> snapshot = rules;
+		uint64_t snapshot_version = version;
+		uint64_t since = oldest_update;
+		oldest_update = 0;
+		lock.unlock();
+
+		uint64_t t0 = LatencyHistogram::Start();
+		PacketClassifier *next = make_inner();
+		next->ConstructClassifier(snapshot);
+		uint64_t t1 = LatencyHistogram::Stop();
+		Publish(next);
+		uint64_t t2 = LatencyHistogram::Stop();
+
+		lock.lock();
+		built = snapshot_version;
+		rebuilds++;
+		build_time.record(t1 - t0);
+		staleness.record(t2 - since);
+	}
+}
+
+void RebuildingClassifier::Publish(PacketClassifier *next) {
+	PacketClassifier *old = current.exchange(next);
+	uint64_t e = ++epoch;
+	// a lookup which started before the epoch may still use the old instance
+	uint64_t r;
+	while ((r = reader_epoch.load()) != IDLE && r < e)
+		this_thread::yield();
+	delete old;
+}
+
+void RebuildingClassifier::StopBuilder() {
+	if (!builder.joinable())
+		return;
+	{
+		lock_guard<mutex> lock(rules_mutex);
+		stop = true;
+	}
+	wakeup.notify_one();
+	builder.join();
+	stop = false;
+}
+
+Memory RebuildingClassifier::MemSizeBytes() const {
+	ReadGuard guard(*this);
+	return guard.inner->MemSizeBytes();
+}
+
+int RebuildingClassifier::MemoryAccess() const {
+	ReadGuard guard(*this);
+	return guard.inner->MemoryAccess();
+}
+
+bool RebuildingClassifier::SupportsMemoryAccessTrace() const {
+	ReadGuard guard(*this);
+	return guard.inner->SupportsMemoryAccessTrace();
+}
+
+void RebuildingClassifier::CheckRule(const Rule &rule) const {
+	ReadGuard guard(*this);
+	guard.inner->CheckRule(rule);
+}
+
+bool RebuildingClassifier::SupportsWideFields() const {
+	ReadGuard guard(*this);
+	return guard.inner->SupportsWideFields();
+}
+
+size_t RebuildingClassifier::NumTables() const {
+	ReadGuard guard(*this);
+	return guard.inner->NumTables();
+}
+
+size_t RebuildingClassifier::RulesInTable(size_t tableIndex) const {
+	ReadGuard guard(*this);
+	return guard.inner->RulesInTable(tableIndex);
+}
+
+void RebuildingClassifier::CollectStats(map<string, string> &summary) const {
+	{
+		lock_guard<mutex> lock(rules_mutex);
+		summary["Rebuild.Count"] = to_string(rebuilds);
+		build_time.Report(summary, "Rebuild.BuildTime");
+		staleness.Report(summary, "Rebuild.Staleness");
+	}
+	ReadGuard guard(*this);
+	guard.inner->CollectStats(summary);
+}
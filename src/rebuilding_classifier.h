@@ -0,0 +1,106 @@
+#pragma once
+
+#include "packet_classifier.h"
+#include "Utilities/LatencyHistogram.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Hitless rebuild of a classifier which can not be updated (HyperCuts,
+ * ByteCuts, BitVector, ...)
+ *
+ * The updates change only the list of the rules of the wrapper. A background
+ * thread builds a new instance of the inner classifier from a copy of the
+ * list, the lookups are served by the current instance until the new one is
+ * swapped in. The updates which arrive during a build are applied by the next
+ * build (one build for all of them).
+ *
+ * The old instance is freed by the builder thread once the lookup thread has
+ * left the epoch in which the swap happened. The lookups and the other queries
+ * are expected from a single thread (as for any other classifier), the updates
+ * may come from the same or an other thread.
+ */
+class RebuildingClassifier: public PacketClassifier {
+public:
+	RebuildingClassifier(std::function<PacketClassifier*()> make_inner);
+	~RebuildingClassifier();
+
+	virtual void _ConstructClassifier(const std::vector<Rule> &rules) override;
+	virtual int ClassifyAPacket(const Packet &packet) override;
+	virtual void _DeleteRule(size_t index) override;
+	virtual void _InsertRule(const Rule &rule) override;
+	// all updates of the batch in a single rebuild
+	virtual void _ApplyUpdates(const std::vector<size_t> &deleted,
+			const std::vector<const Rule*> &inserted) override;
+	virtual void CheckRule(const Rule &rule) const override;
+	virtual bool UpdatesPending() const override {
+		return built < version;
+	}
+	virtual Memory MemSizeBytes() const override;
+	virtual int MemoryAccess() const override;
+	virtual bool SupportsMemoryAccessTrace() const override;
+	virtual bool SupportsWideFields() const override;
+	virtual size_t NumTables() const override;
+	virtual size_t RulesInTable(size_t tableIndex) const override;
+	virtual void CollectStats(std::map<std::string, std::string> &summary) const
+			override;
+
+private:
+	static constexpr uint64_t IDLE = UINT64_MAX;
+
+	/**
+	 * The current instance for the lookup thread, it can not be freed until
+	 * the guard is destroyed
+	 */
+	class ReadGuard {
+	public:
+		ReadGuard(const RebuildingClassifier &owner) :
+				owner(owner) {
+			owner.reader_epoch = owner.epoch.load();
+			inner = owner.current.load();
+		}
+		~ReadGuard() {
+			owner.reader_epoch = IDLE;
+		}
+		PacketClassifier *inner;
+	private:
+		const RebuildingClassifier &owner;
+	};
+
+	// the body of the builder thread
+	void Build();
+	// swaps in the new instance and frees the old one
+	void Publish(PacketClassifier *next);
+	// the update is done (under the mutex), the builder is started if needed
+	void Updated();
+	void StopBuilder();
+
+	std::function<PacketClassifier*()> make_inner;
+	std::atomic<PacketClassifier*> current;
+	// the swaps of current
+	std::atomic<uint64_t> epoch;
+	// epoch of the lookup in progress (IDLE if there is none)
+	mutable std::atomic<uint64_t> reader_epoch;
+
+	// the rules and the state of the builder
+	mutable std::mutex rules_mutex;
+	std::condition_variable wakeup;
+	std::thread builder;
+	bool stop;
+	std::vector<Rule> rules;
+	// the updates applied to rules, the updates visible to the lookups
+	std::atomic<uint64_t> version;
+	std::atomic<uint64_t> built;
+	// time of the oldest update which is not in a build yet (0 = none)
+	uint64_t oldest_update;
+
+	uint64_t rebuilds;
+	LatencyHistogram build_time;
+	// time from an update until its rebuild is swapped in
+	LatencyHistogram staleness;
+};
@@ -3,7 +3,8 @@
 
 from unittest import TestLoader, TextTestRunner, TestSuite
 
-from tests.test_simple_functionality import SimpleFunctionalityTC, ValidationTC
+from tests.test_simple_functionality import SimpleFunctionalityTC, ValidationTC, UpdateTC, BinaryFormatTC, StreamTC, \
+    TraceGeneratorTC, LatencyTC, GenerateRulesTC
 
 
 def testSuiteFromTCs(*tcs):
@@ -19,7 +20,13 @@ def testSuiteFromTCs(*tcs):
 
 suite = testSuiteFromTCs(
     SimpleFunctionalityTC,
-    ValidationTC
+    ValidationTC,
+    UpdateTC,
+    BinaryFormatTC,
+    StreamTC,
+    TraceGeneratorTC,
+    LatencyTC,
+    GenerateRulesTC,
 )
 
 if __name__ == '__main__':
@@ -103,8 +103,12 @@ def make_tasks():
 
 def main():
     benchmarks = make_tasks()
-    # run_classifications(benchmarks, RESULT_DIR, run_benchmark, 1)
-    run_classifications(benchmarks, RESULT_DIR, run_likwid_benchmark, 1)
+    if "--likwid" in sys.argv:
+        # requires likwid-perfctr and the msr kernel module
+        run_classifications(benchmarks, RESULT_DIR, run_likwid_benchmark, 1)
+    else:
+        # hardware counters are collected by the benchmark itself (Perf.* in the result file)
+        run_classifications(benchmarks, RESULT_DIR, run_benchmark, 1)
 
 
 if __name__ == "__main__":
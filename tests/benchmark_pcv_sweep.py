@@ -0,0 +1,51 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+"""
+Sweep over the tree geometries of the pcv classifier
+(key width, node fan-out, max trees, max levels), see src/pcv/pcv_configurations.cpp
+"""
+
+import os
+
+from tests.benchmark import run_benchmark, run_classifications
+from tests.constants import ROOT, CORE_SELECT
+from tests.generate_rulesets import format_num, SEEDS, SIZES, OUT
+
+RESULT_DIR = os.path.join(ROOT, "results_pcv_sweep")
+
+PCV_CONFIGS = [
+    f"pcv:k{k:d}:n{n:d}:t64:l10"
+    for k in [8, 16, 32]
+    for n in [4, 8, 16]
+] + [
+    "pcv:k16:n8:t32:l10",
+    "pcv:k16:n8:t128:l10",
+    "pcv:k16:n8:t64:l5",
+    "pcv:k16:n8:t64:l16",
+]
+
+
+def make_tasks():
+    RULESET_FILES = []
+    for seed in SEEDS:
+        for size in SIZES:
+            f = os.path.join(OUT, os.path.basename(seed) + "_" + format_num(size))
+            RULESET_FILES.append(f)
+
+    benchmarks = [
+        (cfg, ruleset, RESULT_DIR, cores)
+        for cfg in PCV_CONFIGS
+        for ruleset in RULESET_FILES
+        for cores in CORE_SELECT[:1]
+    ]
+    return benchmarks
+
+
+def main():
+    benchmarks = make_tasks()
+    run_classifications(benchmarks, RESULT_DIR, run_benchmark, 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -19,13 +19,10 @@ def get_latest_folder(root):
 
 
 BIN = os.path.join(get_latest_folder(os.path.join(ROOT, "build")), "src/packetClassificators")
-RULESET_ROOT = os.path.join(ROOT, "../classbench-ng/generated/")
-
-CLASSBENCH_ROOT = os.path.join(os.path.dirname(__file__), "..", "..", "classbench-ng")
-CLASSBENCH = os.path.join(os.path.dirname(__file__), "..", "..", "classbench-ng", "classbench")
-EXACT_MATCH_RULE_GEN = os.path.join(os.path.dirname(__file__), "..", "..", "pclass-vectorized/build/default/benchmarks/exact_match_rule_gen")
-RULESET_ROOT = os.path.join(CLASSBENCH_ROOT, "generated/")
-SEED_ROOT = os.path.join(CLASSBENCH_ROOT, "vendor", "parameter_files")
+# the rulesets generated by m=GenerateRules (generate_rulesets.py)
+RULESET_ROOT = os.path.join(ROOT, "tests", "rulesets", "generated/")
+# the ClassBench parameter files
+SEED_ROOT = os.path.join(ROOT, "tests", "rulesets")
 
 ALGS = [
     # "PartitionSort",
@@ -37,6 +34,7 @@ ALGS = [
     "PTSS",
     "TupleMergeOnline",
     "pcv",
+    "ExactMatch",
     # "TupleMergeOffline",
     # "CutSplit",
     # "EffiCuts",
@@ -60,8 +58,9 @@ SIZES = [
     # 100e3, 200e3, 300e3, 400e3, 500e3,
     # 1e6,
 ]
+# the other ClassBench parameter files have to be copied to SEED_ROOT
 SEEDS = [os.path.join(SEED_ROOT, s) for s in [
-    "exact",
+    "acl_seed_example",
     # "acl1_seed",
     # "acl2_seed",
     # "acl3_seed",
@@ -8,11 +8,10 @@ from pathlib import Path
 from subprocess import check_call
 import sys
 
-from tests.constants import SEEDS, SIZES, CLASSBENCH, \
-    CLASSBENCH_ROOT, EXACT_MATCH_RULE_GEN
+from tests.constants import SEEDS, SIZES, BIN, RULESET_ROOT
 
-OUT = os.path.join(CLASSBENCH_ROOT, "generated")
-OUT_TIME_LOG = os.path.join(CLASSBENCH_ROOT, "generated", "time.log")
+OUT = RULESET_ROOT
+OUT_TIME_LOG = os.path.join(RULESET_ROOT, "time.log")
 
 
 def format_num(n: int):
@@ -45,20 +44,20 @@ def run_classbench(args):
     res_f = os.path.join(OUT, os.path.basename(seed) + "_" + format_num(size))
     res_f_path = Path(res_f)
     if not res_f_path.is_file() or res_f_path.stat().st_size == 0:
-        with open(res_f, "w") as f:
-            print(f"Calling classbench generator for {seed} {size}")
-            t0 = datetime.now()
-            try:
-                check_call([CLASSBENCH, "generate", "v4", "--count=%d" % (size), seed], stdout=f, cwd=CLASSBENCH_ROOT)
-            except Exception as e:
-                print(f"[ERROR] exact {seed} {size}", e, file=sys.stderr)
-
-            t1 = datetime.now()
+        print(f"Calling ruleset generator for {seed} {size}")
+        t0 = datetime.now()
+        try:
+            check_call([BIN, "m=GenerateRules", f"Generate.Seed={seed}", f"Generate.Count={size}",
+                        f"Generate.Out={res_f}"])
+        except Exception as e:
+            print(f"[ERROR] classbench {seed} {size}", e, file=sys.stderr)
+
+        t1 = datetime.now()
         with counter.get_lock():
             counter.value += 1
         print("%.2f%% %r" % (counter.value / len(tasks) * 100, args))
         with open(OUT_TIME_LOG, 'a+') as f:
-            f.write(f"classbench {seed} {size} {str(t1-t0):s}")
+            f.write(f"classbench {seed} {size} {str(t1-t0):s}\n")
 
     else:
         print(f"classbench {seed} {size} already exits")
@@ -66,46 +65,10 @@ def run_classbench(args):
             counter.value += 1
 
 
-def run_exact_gen(args):
-    global counter
-    (seed, size) = args
-    # += operation is not atomic, so we need to get a lock:
-
-    res_f = os.path.join(OUT, "exact_" + format_num(size))
-    res_f_path = Path(res_f)
-    if not res_f_path.is_file() or res_f_path.stat().st_size == 0:
-        with open(res_f, "w") as f:
-            print(f"Calling exactmatch generator for {seed} {size}")
-            t0 = datetime.now()
-            try:
-                check_call([EXACT_MATCH_RULE_GEN, str(seed), str(size)], stdout=f, cwd=CLASSBENCH_ROOT)
-            except Exception as e:
-                print(f"[ERROR] exact {seed} {size}", e, file=sys.stderr)
-
-            t1 = datetime.now()
-
-        with counter.get_lock():
-            counter.value += 1
-
-        print("%.2f%% %r" % (counter.value / len(SIZES) * 100, args))
-        with open(OUT_TIME_LOG, 'a+') as f:
-            f.write(f"exact {seed} {size} {str(t1-t0):s}")
-
-    else:
-        print(f"exactmatch {seed} {size} already exits")
-        with counter.get_lock():
-            counter.value += 1
-
-
 if __name__ == "__main__":
+    os.makedirs(OUT, exist_ok=True)
     counter = Value('i', 0)
     with Pool(initializer=init, initargs=(counter,)) as pool:
         i = pool.map_async(run_classbench, tasks)
         i.wait()
         print(i.get())
-
-    # _tasks = [(0, size) for size in SIZES]
-    # with Pool(initializer=init, initargs=(counter,)) as pool:
-    #     i = pool.map_async(run_exact_gen, _tasks, chunksize=1)
-    #     i.wait()
-    #     print(i.get())
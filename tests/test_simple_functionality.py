@@ -1,8 +1,11 @@
 #!/usr/bin/env python3
 # -*- coding: utf-8 -*-
 
+import csv
+import json
 import os
-from subprocess import check_call, CalledProcessError
+from subprocess import check_call, run, CalledProcessError, PIPE, STDOUT
+from tempfile import TemporaryDirectory
 import unittest
 from unittest.runner import TextTestRunner
 
@@ -10,14 +13,32 @@ ROOT = os.path.join(os.path.dirname(__file__), "..")
 BIN = os.path.join(ROOT, "build/meson.debug.linux.x86_64/src/packetClassificators")
 
 
+def read_results(out):
+    """
+    :return: the results of the classifiers in the json output, by the classifier name
+    """
+    with open(out) as f:
+        res = f.read().strip()
+    # the objects of the classifiers are concatenated
+    decoder = json.JSONDecoder()
+    results = {}
+    i = 0
+    while i < len(res):
+        r, i = decoder.raw_decode(res, i)
+        results[r["Classifier"]] = r
+        while i < len(res) and res[i].isspace():
+            i += 1
+    return results
+
+
 class SimpleFunctionalityTC(unittest.TestCase):
     DEFAULT_RULESET = os.path.join(ROOT, "tests/rulesets/acl1_100")
 
-    def run_bin(self, alg, ruleset=None):
+    def run_bin(self, alg, ruleset=None, args=()):
         if ruleset is None:
             ruleset = self.DEFAULT_RULESET
 
-        check_call([BIN, f"c={alg}", f"f={ruleset}", "r=2"])
+        check_call([BIN, f"c={alg}", f"f={ruleset}", "r=2", *args])
 
     def test_fail(self):
         with self.assertRaises((AssertionError, CalledProcessError)):
@@ -53,29 +74,492 @@ class SimpleFunctionalityTC(unittest.TestCase):
     def test_pcv(self):
         self.run_bin("pcv")
 
+    def test_pcv_k8(self):
+        self.run_bin("pcv:k8:n4")
+
+    def test_pcv_k32(self):
+        self.run_bin("pcv:k32:n16")
+
     def test_CutSplit(self):
         self.run_bin("CutSplit")
 
     def test_EffiCuts(self):
         self.run_bin("EffiCuts")
 
+    def test_HiCuts(self):
+        self.run_bin("HiCuts")
+
+    def test_Cache(self):
+        # small cache to test the eviction
+        self.run_bin("Cache(PTSS),Cache(ExactMatch)", args=["Cache.Sets=64", "Cache.Ways=2"])
+
+    def test_Megaflow(self):
+        # small cache to test the eviction
+        self.run_bin("Megaflow", args=["Megaflow.MaxFlows=16"])
+
+    def test_RFC(self):
+        self.run_bin("RFC")
+
+    def test_RFC_tree(self):
+        self.run_bin("RFC", args=["RFC.Tree=0.1,2.3,4.5,6/0.1,2.3/0.1"])
+
+    def test_cuttings_small_leaves(self):
+        self.run_bin("HiCuts,EffiCuts,CutSplit", args=CuttingTC.SMALL_LEAVES)
+
+    def test_RQRMI(self):
+        self.run_bin("RQRMI,RQRMI(PTSS)")
+
+    def test_RQRMI_remainder(self):
+        self.run_bin("RQRMI(PTSS)", args=RQRMITC.SMALL_ISETS)
+
 
 class ValidationTC(SimpleFunctionalityTC):
 
+    def run_bin(self, alg, ruleset=None, args=()):
+        if ruleset is None:
+            ruleset = self.DEFAULT_RULESET
+        cmd = [BIN, f"c={alg},List", f"f={ruleset}", "m=Validation", *args]
+        try:
+            check_call(cmd)
+        except CalledProcessError:
+            raise AssertionError(" ".join(cmd), "failed")
+
+
+class UpdateTC(unittest.TestCase):
+    DEFAULT_RULESET = SimpleFunctionalityTC.DEFAULT_RULESET
+
     def run_bin(self, alg, ruleset=None):
         if ruleset is None:
             ruleset = self.DEFAULT_RULESET
-        cmd = [BIN, f"c={alg},List", f"f={ruleset}", "m=Validation"]
+        cmd = [BIN, f"c={alg}", f"f={ruleset}", "m=Update"]
         try:
             check_call(cmd)
         except CalledProcessError:
             raise AssertionError(" ".join(cmd), "failed")
 
+    def test_PTSS(self):
+        self.run_bin("PTSS")
+
+    def test_TupleMergeOnline(self):
+        self.run_bin("TupleMergeOnline")
+
+    def test_pcv(self):
+        self.run_bin("pcv")
+
+    def test_handles(self):
+        # rules deleted and inserted back by their handles, 4 rules share each priority
+        for alg in ["TSS", "PTSS", "TupleMergeOnline", "TupleMergeOffline", "HyperSplit", "Megaflow", "PartitionSort"]:
+            check_call([BIN, f"c={alg},BruteForce", f"f={self.DEFAULT_RULESET}", "m=Validation",
+                        "Rules.SharePriority=4", "Validate.Updates=300"])
+
+    def test_batches(self):
+        algs = ["PTSS", "TupleMergeOnline", "TupleMergeOffline", "HyperSplit", "TSS", "PartitionSort"]
+        for alg in algs:
+            check_call([BIN, f"c={alg},BruteForce", f"f={self.DEFAULT_RULESET}", "m=Validation",
+                        "Rules.SharePriority=4", "Validate.Updates=300", "Validate.Batch=16"])
+        with TemporaryDirectory() as d:
+            out = os.path.join(d, "out.csv")
+            check_call([BIN, "c=" + ",".join(algs), f"f={self.DEFAULT_RULESET}", "m=Update",
+                        "Update.Batch=16", f"o={out}"])
+            with open(out) as f:
+                rows = list(csv.DictReader(f))
+            self.assertEqual(len(rows), len(algs))
+            for row in rows:
+                self.assertGreater(float(row["BatchLatency.p50(ns)"]), 0)
+
+    def test_rebuild(self):
+        # static classifiers updated by the rebuilds in the background
+        for batch in ["1", "16"]:
+            check_call([BIN, "c=Rebuild(HyperCuts),Rebuild(ByteCuts),PTSS", f"f={self.DEFAULT_RULESET}",
+                        "m=Validation", "Validate.Updates=300", f"Validate.Batch={batch}"])
+        with TemporaryDirectory() as d:
+            out = os.path.join(d, "out.csv")
+            check_call([BIN, "c=Rebuild(HyperCuts)", f"f={self.DEFAULT_RULESET}", "m=Update",
+                        "Update.Packets=100000", f"o={out}"])
+            with open(out) as f:
+                rows = list(csv.DictReader(f))
+            self.assertEqual(len(rows), 1)
+            self.assertIn("Rebuild.Count", rows[0])
+
+
+class BinaryFormatTC(unittest.TestCase):
+
+    def test_convert_and_validate(self):
+        with TemporaryDirectory() as d:
+            rules = os.path.join(d, "rules.bin")
+            packets = os.path.join(d, "packets.bin")
+            check_call([BIN, f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", "m=Convert",
+                        f"Convert.Rules={rules}", f"Convert.Packets={packets}"])
+            check_call([BIN, "c=PTSS,List", f"f={rules}", f"p={packets}", "m=Validation"])
+
+
+class StreamTC(unittest.TestCase):
+
+    def test_generator(self):
+        check_call([BIN, "c=PTSS", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}",
+                    "Stream=1", "Stream.Packets=100000", "Stream.Batch=1000"])
+
+    def test_file_replay(self):
+        with TemporaryDirectory() as d:
+            packets = os.path.join(d, "packets.bin")
+            check_call([BIN, f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", "m=Convert",
+                        f"Convert.Packets={packets}"])
+            check_call([BIN, "c=PTSS", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", f"p={packets}",
+                        "Stream=1", "Stream.Packets=2500000"])
+
+
+class TraceGeneratorTC(unittest.TestCase):
+
+    def run_bin(self, *args):
+        check_call([BIN, "c=PTSS,List", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", "m=Validation",
+                    "Trace.Packets=100000", *args])
+
+    def test_flows(self):
+        self.run_bin("Trace.Mode=Flows", "Trace.Flows=1000", "Trace.Zipf=1.2", "Trace.Interleave=4")
+
+    def test_uniform(self):
+        self.run_bin("Trace.Mode=Uniform")
+
+
+class LatencyTC(unittest.TestCase):
+
+    def test_classification_latency(self):
+        with TemporaryDirectory() as d:
+            out = os.path.join(d, "out.json")
+            check_call([BIN, "c=PTSS", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", f"o={out}",
+                        "Latency.Sample=16"])
+            with open(out) as f:
+                res = f.read()
+            for p in ["p50", "p90", "p99", "p99.9", "max"]:
+                self.assertIn(f'"ClassifyLatency.{p}(ns)"', res)
+
+
+class MemoryTraceTC(unittest.TestCase):
+
+    def test_memory_trace(self):
+        with TemporaryDirectory() as d:
+            out = os.path.join(d, "out.json")
+            cmd = [BIN, "c=PTSS,TupleMergeOnline,HyperSplit,ByteCuts,pcv", "m=MemoryTrace",
+                   f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", f"o={out}", "MemoryTrace.Packets=10000"]
+            p = run(cmd, stdout=PIPE, stderr=STDOUT, universal_newlines=True)
+            if "-Dmemory_trace=true" in p.stdout:
+                self.skipTest("the build without -Dmemory_trace=true")
+            self.assertEqual(p.returncode, 0, p.stdout)
+            with open(out) as f:
+                res = f.read()
+            # pcv lookup is not instrumented and is skipped
+            self.assertNotIn('"Classifier": "pcv"', res)
+            self.assertEqual(res.count('"WorkingSet(bytes)"'), 4)
+            for k in ["avg", "p50", "p90", "p99", "max", "Histogram"]:
+                self.assertIn(f'"CacheLines.{k}"', res)
+
+
+class AllocationTrackerTC(unittest.TestCase):
+
+    def test_ruleset_size(self):
+        # the memory of the classifiers (the cmap tables of PTSS and the nodes of HyperSplit)
+        # grows with the ruleset
+        live = {}
+        with TemporaryDirectory() as d:
+            for cnt in [100, 2000]:
+                out = os.path.join(d, f"out{cnt}.json")
+                check_call([BIN, "c=PTSS,HyperSplit", f"Generate.Seed={GenerateRulesTC.SEED}",
+                            f"Generate.Count={cnt}", f"o={out}", "Alloc=1"])
+                for c, res in read_results(out).items():
+                    self.assertGreaterEqual(int(res["Alloc.Peak(bytes)"]), int(res["Alloc.Live(bytes)"]))
+                    self.assertGreater(int(res["Alloc.Allocations"]), 0)
+                    live[c, cnt] = int(res["Alloc.Live(bytes)"])
+        for c in ["PTSS", "HyperSplit"]:
+            self.assertGreater(live[c, 2000], live[c, 100])
+
+
+class ExactMatchTC(unittest.TestCase):
+
+    def write_ruleset(self, d):
+        """
+        acl1_100 with exact 5-tuple rules in between (the wildcard rules have
+        higher and lower priority than the exact ones)
+        """
+        with open(SimpleFunctionalityTC.DEFAULT_RULESET) as f:
+            wildcard = f.readlines()
+        exact = []
+        for i in range(2000):
+            sip = f"10.{i >> 8 & 0xff}.{i & 0xff}.1"
+            dip = f"192.168.{i * 7 >> 8 & 0xff}.{i * 7 & 0xff}"
+            sp, dp = 1024 + i, 80 + i % 3
+            proto = 6 if i % 2 else 17
+            exact.append(f"@{sip}/32\t{dip}/32\t{sp} : {sp}\t{dp} : {dp}\t0x{proto:02x}/0xFF\t0x0000/0x0000\t\n")
+        rules = os.path.join(d, "rules")
+        with open(rules, "w") as f:
+            f.writelines(wildcard[:50] + exact + wildcard[50:])
+        return rules
+
+    def test_validation(self):
+        with TemporaryDirectory() as d:
+            rules = self.write_ruleset(d)
+            check_call([BIN, "c=ExactMatch,ExactMatch:TupleMergeOnline,PTSS", f"f={rules}", "m=Validation"])
+
+    def test_update(self):
+        with TemporaryDirectory() as d:
+            rules = self.write_ruleset(d)
+            check_call([BIN, "c=ExactMatch", f"f={rules}", "m=Update"])
+
+
+class CacheTC(unittest.TestCase):
+
+    def test_flow_locality(self):
+        # the packets of the flows hit the cache, the uniform packets do not repeat
+        hit_rate = {}
+        with TemporaryDirectory() as d:
+            for mode in ["Flows", "Uniform"]:
+                out = os.path.join(d, f"{mode}.json")
+                check_call([BIN, "c=Cache(PTSS)", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", f"o={out}",
+                            f"Trace.Mode={mode}", "Trace.Flows=100", "Trace.Packets=100000"])
+                hit_rate[mode] = float(read_results(out)["Cache(PTSS)"]["Cache.HitRate"])
+        self.assertGreater(hit_rate["Flows"], 0.9)
+        self.assertLess(hit_rate["Uniform"], hit_rate["Flows"])
+
+    def test_invalidation(self):
+        # the cached results of the flows have to be dropped by the updates
+        check_call([BIN, "c=Cache(PTSS),BruteForce", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}",
+                    "m=Validation", "Validate.Updates=300", "Trace.Mode=Flows", "Trace.Flows=100",
+                    "Trace.Packets=100000"])
+        with TemporaryDirectory() as d:
+            out = os.path.join(d, "out.csv")
+            check_call([BIN, "c=Cache(PTSS)", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", "m=Update",
+                        "Update.Packets=100000", f"o={out}"])
+            with open(out) as f:
+                row = next(csv.DictReader(f))
+            self.assertGreater(int(row["Cache.Invalidations"]), 0)
+
+
+class MegaflowTC(unittest.TestCase):
+
+    def test_wildcards(self):
+        # a megaflow covers also the packets not seen yet, unlike the exact match cache
+        with TemporaryDirectory() as d:
+            out = os.path.join(d, "out.json")
+            check_call([BIN, "c=Megaflow,Cache(PTSS)", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", f"o={out}",
+                        "Trace.Mode=Uniform", "Trace.Packets=100000"])
+            res = read_results(out)
+        megaflow = res["Megaflow"]
+        self.assertGreater(float(megaflow["Megaflow.HitRate"]), float(res["Cache(PTSS)"]["Cache.HitRate"]))
+        self.assertLess(int(megaflow["Megaflow.Flows"]), 100000)
+
+    def test_revalidation(self):
+        # the megaflows overlapping an updated rule have to be removed
+        check_call([BIN, "c=Megaflow,BruteForce", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}",
+                    "m=Validation", "Validate.Updates=300", "Trace.Mode=Flows", "Trace.Flows=100",
+                    "Trace.Packets=100000"])
+        with TemporaryDirectory() as d:
+            out = os.path.join(d, "out.csv")
+            check_call([BIN, "c=Megaflow", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", "m=Update",
+                        "Update.Packets=100000", f"o={out}"])
+            with open(out) as f:
+                row = next(csv.DictReader(f))
+            self.assertGreater(int(row["Megaflow.Revalidated"]), 0)
+
+
+class RFCTC(unittest.TestCase):
+
+    def test_compress(self):
+        # the compression changes only the size of the tables, not their content
+        res = {}
+        with TemporaryDirectory() as d:
+            packets = os.path.join(d, "packets.bin")
+            check_call([BIN, f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", "m=Convert",
+                        f"Convert.Packets={packets}"])
+            for compress in [0, 1]:
+                check_call([BIN, "c=RFC,PTSS", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", f"p={packets}",
+                            "m=Validation", f"RFC.Compress={compress}"])
+                out = os.path.join(d, f"out{compress}.json")
+                check_call([BIN, "c=RFC", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", f"p={packets}",
+                            f"o={out}", f"RFC.Compress={compress}"])
+                res[compress] = read_results(out)["RFC"]
+        for k in ["RFC.PhaseEntries", "RFC.PhaseClasses"]:
+            self.assertEqual(res[0][k], res[1][k])
+        self.assertLess(int(res[1]["Size(bytes)"]), int(res[0]["Size(bytes)"]))
+
+    def test_unsupported_rules(self):
+        # the rules with 2 repetitions of the 5-tuple (10 dimensions)
+        with TemporaryDirectory() as d:
+            rules = os.path.join(d, "rules")
+            with open(SimpleFunctionalityTC.DEFAULT_RULESET) as src, open(rules, "w") as f:
+                for line in src:
+                    fields = "\t".join(line.split("\t")[:5])
+                    f.write(fields + "\t" + fields[1:] + "\n")
+            p = run([BIN, "c=RFC", f"f={rules}"], stdout=PIPE, stderr=STDOUT, universal_newlines=True)
+            self.assertNotEqual(p.returncode, 0)
+            self.assertIn("RFC supports only the IPv4 5-tuple rules", p.stdout)
+
+
+class CuttingTC(unittest.TestCase):
+    SMALL_LEAVES = ["HiCuts.Binth=4", "EffiCuts.Binth=2", "EffiCuts.Largeness=0.05",
+                    "CutSplit.Binth=2", "CutSplit.Threshold=24"]
+
+    def test_binth(self):
+        # the smaller leaves require more cuts
+        res = {}
+        with TemporaryDirectory() as d:
+            for name, args in [("default", []), ("small", self.SMALL_LEAVES)]:
+                out = os.path.join(d, f"{name}.json")
+                check_call([BIN, "c=HiCuts,EffiCuts,CutSplit", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}",
+                            f"o={out}", *args])
+                res[name] = read_results(out)
+        for c in ["HiCuts", "EffiCuts", "CutSplit"]:
+            self.assertGreater(int(res["small"][c][f"{c}.Nodes"]), int(res["default"][c][f"{c}.Nodes"]))
+        # HiCuts builds a single tree, EffiCuts and CutSplit separate the rules in to more trees
+        self.assertEqual(res["default"]["HiCuts"]["HiCuts.Trees"], "1")
+        for c in ["EffiCuts", "CutSplit"]:
+            self.assertGreater(int(res["default"][c][f"{c}.Trees"]), 1)
+
+
+class RQRMITC(unittest.TestCase):
+    # small iSets, most of the rules in the remainder
+    SMALL_ISETS = ["RQRMI.MaxISets=1", "RQRMI.MinCoverage=0.01", "RQRMI.Submodels=3"]
+
+    def test_remainder(self):
+        # each rule is either in an iSet or in the remainder
+        rules = {}
+        with TemporaryDirectory() as d:
+            for name, args in [("default", []), ("small", self.SMALL_ISETS)]:
+                out = os.path.join(d, f"{name}.json")
+                check_call([BIN, "c=RQRMI(PTSS)", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", f"o={out}", *args])
+                res = read_results(out)["RQRMI(PTSS)"]
+                isets = [int(s) for s in res["RQRMI.ISetSizes"].split("-")]
+                self.assertEqual(len(isets), int(res["RQRMI.ISets"]))
+                remainder = int(res["RQRMI.RemainderRules"])
+                rules[name] = sum(isets) + remainder
+                self.assertAlmostEqual(float(res["RQRMI.Coverage"]), sum(isets) / rules[name], places=5)
+                if name == "small":
+                    self.assertEqual(len(isets), 1)
+                    self.assertGreater(remainder, rules[name] / 2)
+        self.assertEqual(rules["default"], rules["small"])
+
+    def test_update(self):
+        # the deleted rules are removed from the iSets, the inserted go to the remainder
+        check_call([BIN, "c=RQRMI(PTSS),BruteForce", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}",
+                    "m=Validation", "Validate.Updates=300"])
+
+
+class IPv6TC(unittest.TestCase):
+    RULESET = os.path.join(ROOT, "tests/rulesets/acl1_100_ipv6")
+
+    def test_validation(self):
+        check_call([BIN, "c=PTSS,TSS,TupleMergeOnline,TupleMergeOffline,HyperSplit,Megaflow,RQRMI,List",
+                    f"f={self.RULESET}", "m=Validation"])
+
+    def test_update(self):
+        check_call([BIN, "c=PTSS,TupleMergeOnline", f"f={self.RULESET}", "m=Update"])
+
+    def test_binary(self):
+        with TemporaryDirectory() as d:
+            rules = os.path.join(d, "rules.bin")
+            check_call([BIN, f"f={self.RULESET}", "m=Convert", f"Convert.Rules={rules}"])
+            check_call([BIN, "c=TupleMergeOnline,List", f"f={rules}", "m=Validation"])
+
+    def test_unsupported(self):
+        with self.assertRaises(CalledProcessError):
+            check_call([BIN, "c=ByteCuts", f"f={self.RULESET}"])
+
+
+class SpecializeTC(unittest.TestCase):
+
+    def test_validation(self):
+        for rules in [SimpleFunctionalityTC.DEFAULT_RULESET, IPv6TC.RULESET]:
+            # the specialized List, TSS and PTSS against the generic TupleMergeOnline
+            check_call([BIN, "c=List,TSS,PTSS,TupleMergeOnline", f"f={rules}", "m=Validation"])
+            check_call([BIN, "c=List,TSS,PTSS", f"f={rules}", "m=Validation", "Specialize=0"])
+
+    def test_update(self):
+        check_call([BIN, "c=PTSS,TSS", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", "m=Update"])
+
+
+class TupleMergePolicyTC(unittest.TestCase):
+
+    def test_validation(self):
+        for policy in ["Classic", "Adaptive"]:
+            for rules in [SimpleFunctionalityTC.DEFAULT_RULESET, IPv6TC.RULESET]:
+                check_call([BIN, "c=TupleMergeOnline,TupleMergeOffline", f"f={rules}", "m=Validation",
+                            f"TM.Policy={policy}"])
+
+    def test_construction(self):
+        # the relaxation of the tuples moves only with the updates
+        with TemporaryDirectory() as d:
+            out = os.path.join(d, "out.json")
+            check_call([BIN, "c=TupleMergeOnline", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}",
+                        "TM.Policy=Adaptive", "TM.Limit.Collide=4", f"o={out}"])
+            with open(out) as f:
+                res = f.read()
+            self.assertNotIn('"TM.Splits": "0"', res)
+            self.assertIn('"TM.RelaxLevel": "1.000000"', res)
+
+    def test_cost_model(self):
+        # the lookups are counted only by the Adaptive policy
+        with TemporaryDirectory() as d:
+            for policy in ["Classic", "Adaptive"]:
+                out = os.path.join(d, f"{policy}.json")
+                check_call([BIN, "c=TupleMergeOnline", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}",
+                            f"TM.Policy={policy}", f"o={out}"])
+                with open(out) as f:
+                    res = f.read()
+                if policy == "Adaptive":
+                    self.assertIn('"TM.ExpectedCost"', res)
+                else:
+                    self.assertNotIn('"TM.ExpectedCost"', res)
+
+    def test_update(self):
+        for policy in ["Classic", "Adaptive"]:
+            check_call([BIN, "c=TupleMergeOnline", f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", "m=Update",
+                        f"TM.Policy={policy}", "TM.Limit.Collide=4"])
+
+    def test_maintain(self):
+        with TemporaryDirectory() as d:
+            out = os.path.join(d, "out.csv")
+            check_call([BIN, "c=TupleMergeOnline,RQRMI,Cache(TupleMergeOnline)",
+                        f"f={SimpleFunctionalityTC.DEFAULT_RULESET}", "m=Update", "TM.Policy=Classic",
+                        "Maintain.Budget=4", "Maintain.Interval=1", f"o={out}"])
+            with open(out) as f:
+                rows = {row["Classifier"]: row for row in csv.DictReader(f)}
+            self.assertEqual(len(rows), 3)
+            for row in rows.values():
+                self.assertGreater(len(row["Tables.OverTime"].split("-")), 1)
+            self.assertGreater(int(rows["TupleMergeOnline"]["TM.Maintain.Merged"]), 0)
+
+
+class PriorityTrackerTC(unittest.TestCase):
+
+    def test_benchmark(self):
+        # the benchmark fails if the max priority differs from std::multiset
+        check_call([os.path.join(os.path.dirname(BIN), "priorityTrackerBenchmark"), "20000"])
+
+
+class GenerateRulesTC(unittest.TestCase):
+    SEED = os.path.join(ROOT, "tests/rulesets/acl_seed_example")
+
+    def test_generate_and_validate(self):
+        with TemporaryDirectory() as d:
+            rules = os.path.join(d, "rules")
+            check_call([BIN, "m=GenerateRules", f"Generate.Seed={self.SEED}", "Generate.Count=1000",
+                        f"Generate.Out={rules}"])
+            check_call([BIN, "c=PTSS,List", f"f={rules}", "m=Validation"])
+
+    def test_deterministic(self):
+        with TemporaryDirectory() as d:
+            outs = []
+            for i in range(2):
+                out = os.path.join(d, f"rules{i}.bin")
+                check_call([BIN, "m=GenerateRules", f"Generate.Seed={self.SEED}", "Generate.Count=10000",
+                            "Generate.RandomSeed=5", "Generate.Format=Binary", f"Generate.Out={out}"])
+                with open(out, "rb") as f:
+                    outs.append(f.read())
+            self.assertEqual(outs[0], outs[1])
+
 
 if __name__ == "__main__":
     suite = unittest.TestSuite()
     # suite.addTest(SimpleFunctionalityTC('test_sWithStartPadding'))
-    for tc in [SimpleFunctionalityTC, ValidationTC]:
+    for tc in [SimpleFunctionalityTC, ValidationTC, UpdateTC, BinaryFormatTC, StreamTC, TraceGeneratorTC, LatencyTC, GenerateRulesTC]:
         suite.addTest(unittest.makeSuite(tc))
 
     # runner = TextTestRunner(verbosity=2, failfast=True)